@@ -24,7 +24,13 @@
 
 #pragma once 
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
 #include <stdexcept>
+#include <utility>
 
 using namespace std;
 
@@ -249,4 +255,241 @@ const T& RingBuffer<T>::operator[](unsigned int index) const
 }
 
 
+// Largest power of two an uint32 holds, the limit of the capacities below
+constexpr uint32 kMaxPowerOfTwo = 0x80000000u;
+
+// Smallest power of two not less than n, for n up to kMaxPowerOfTwo
+constexpr uint32 nextPowerOfTwo(uint32 n, uint32 power = 1)
+{
+    return power >= n || power == kMaxPowerOfTwo ? power : nextPowerOfTwo(n, power * 2);
+}
+
+// Ring buffer holding the last N elements, with inline storage.
+//
+// Nothing is allocated and nothing throws: the storage is rounded up to a
+// power of two so that indexing is a mask, and the elements are exposed as
+// at most two contiguous spans (oldest first), which loops can run over
+// linearly. Unlike RingBuffer, size() is the number of elements held.
+template<class T, uint32 N>
+class StaticRingBuffer
+{
+    static_assert(N > 0, "StaticRingBuffer needs a capacity");
+    static_assert(N <= kMaxPowerOfTwo, "StaticRingBuffer capacity above 2^31");
+
+public:
+    // Contiguous part of the buffer
+    template<class U>
+    struct Span
+    {
+        U* data;
+        uint32 size;
+
+        U* begin() const noexcept { return data; }
+        U* end() const noexcept { return data + size; }
+    };
+
+    // Add element to Ring Buffer, dropping the oldest one when full
+    void push_back(const T& value) noexcept
+    {
+        slot() = value;
+    }
+
+    void push_back(T&& value) noexcept
+    {
+        slot() = std::move(value);
+    }
+
+    // Construct element from |args| and move it into the slot, dropping the
+    // oldest one when full. The slot always holds a live T, so this is a move
+    // assignment rather than construction in place.
+    template<class... Args>
+    T& emplace_back(Args&&... args)
+    {
+        T& element = slot();
+        element = T(std::forward<Args>(args)...);
+        return element;
+    }
+
+    // Get size of the Ring Buffer
+    static constexpr uint32 capacity() noexcept
+    {
+        return N;
+    }
+
+    // Number of elements held
+    uint32 size() const noexcept
+    {
+        return m_size;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    bool full() const noexcept
+    {
+        return m_size == N;
+    }
+
+    // Clear element
+    void clear() noexcept
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+    // Access element at index, 0 is the oldest
+    T& operator[](uint32 index) noexcept
+    {
+        assert(index < m_size);
+        return m_data[(m_head - m_size + index) & kMask];
+    }
+
+    const T& operator[](uint32 index) const noexcept
+    {
+        assert(index < m_size);
+        return m_data[(m_head - m_size + index) & kMask];
+    }
+
+    // Get front (oldest) element
+    const T& front() const noexcept
+    {
+        return (*this)[0];
+    }
+
+    // Get back (newest) element
+    const T& back() const noexcept
+    {
+        return (*this)[m_size - 1];
+    }
+
+    // The oldest elements, up to the end of the storage
+    Span<const T> first() const noexcept
+    {
+        uint32 start = (m_head - m_size) & kMask;
+        uint32 size = m_size < kStorage - start ? m_size : kStorage - start;
+        return Span<const T>{ m_data + start, size };
+    }
+
+    // The remaining elements, wrapped around to the start of the storage
+    Span<const T> second() const noexcept
+    {
+        Span<const T> head = first();
+        return Span<const T>{ m_data, m_size - head.size };
+    }
+
+private:
+    static constexpr uint32 kStorage = nextPowerOfTwo(N);
+    static constexpr uint32 kMask = kStorage - 1;
+
+    // Slot for a new element
+    T& slot() noexcept
+    {
+        T& element = m_data[m_head & kMask];
+        m_head++;
+        if( m_size < N )
+            m_size++;
+        return element;
+    }
+
+    T m_data[kStorage];
+    uint32 m_head = 0;
+    uint32 m_size = 0;
+};
+
+// Lock-free ring buffer for one producer thread and one consumer thread,
+// e.g. a capture thread handing PCM to a VAD worker.
+//
+// Neither side ever blocks: write() stores as much as fits and read() returns
+// what is available. The capacity is rounded up to a power of two. The write
+// and read positions grow monotonically and live on separate cache lines,
+// together with the producer's and consumer's cached copy of the other side's
+// position, so the sides only touch each other's line when the cache is
+// exhausted. Sizes above kMaxPowerOfTwo throw length_error.
+template<class T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t size)
+        : m_capacity(nextPowerOfTwo(checkedSize(size)))
+        , m_mask(m_capacity - 1)
+        , m_data(new T[m_capacity])
+    {
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    size_t capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    // Producer: copy up to |count| elements in, returns the number written
+    size_t write(const T* data, size_t count) noexcept
+    {
+        const size_t head = m_head.value.load(std::memory_order_relaxed);
+        if( m_capacity - (head - m_head.cached) < count )
+            m_head.cached = m_tail.value.load(std::memory_order_acquire);
+        count = std::min(count, m_capacity - (head - m_head.cached));
+
+        const size_t start = head & m_mask;
+        const size_t first = std::min(count, m_capacity - start);
+        std::copy(data, data + first, m_data.get() + start);
+        std::copy(data + first, data + count, m_data.get());
+        m_head.value.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: copy up to |count| elements out, returns the number read
+    size_t read(T* data, size_t count) noexcept
+    {
+        const size_t tail = m_tail.value.load(std::memory_order_relaxed);
+        if( m_tail.cached - tail < count )
+            m_tail.cached = m_head.value.load(std::memory_order_acquire);
+        count = std::min(count, m_tail.cached - tail);
+
+        const size_t start = tail & m_mask;
+        const size_t first = std::min(count, m_capacity - start);
+        std::copy(m_data.get() + start, m_data.get() + start + first, data);
+        std::copy(m_data.get(), m_data.get() + (count - first), data + first);
+        m_tail.value.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // Elements available for read(), exact on the consumer thread
+    size_t readAvailable() const noexcept
+    {
+        return m_head.value.load(std::memory_order_acquire) - m_tail.value.load(std::memory_order_relaxed);
+    }
+
+    // Space available for write(), exact on the producer thread
+    size_t writeAvailable() const noexcept
+    {
+        return m_capacity - (m_head.value.load(std::memory_order_relaxed) - m_tail.value.load(std::memory_order_acquire));
+    }
+
+private:
+    static uint32 checkedSize(size_t size)
+    {
+        if( size > kMaxPowerOfTwo )
+            throw length_error("SpscRingBuffer size above 2^31");
+        return static_cast<uint32>(size);
+    }
+
+    // Position owned by one side, with that side's copy of the other position
+    struct alignas(64) Position
+    {
+        std::atomic<size_t> value{ 0 };
+        size_t cached = 0;
+    };
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<T[]> m_data;
+    Position m_head; // written by the producer
+    Position m_tail; // written by the consumer
+};
+
 } // namepsace Buffers
@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) 2022 360Converter - Leo Huang
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Signals shared by the benchmarks.
+
+#ifndef _BENCH_SIGNAL_H_
+#define _BENCH_SIGNAL_H_
+
+#include <cmath> // std::sin
+#include <cstdint> // int16_t
+#include <cstdio> // FILE
+#include <cstring> // memcpy
+#include <fstream> // std::ifstream
+#include <iterator> // std::istreambuf_iterator
+#include <string> // std::string
+#include <vector> // std::vector
+
+// Signal used by the benchmarks: sample rate and mono 16-bit samples.
+struct Signal
+{
+    unsigned int sampleRate;
+    std::vector<int16_t> samples;
+};
+
+// Deterministic pseudo random generator (LCG), so runs are comparable.
+class Lcg
+{
+public:
+    explicit Lcg( uint32_t seed ) : m_state( seed ) {}
+
+    // Uniform value in [-1, 1)
+    double next()
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return ( m_state >> 8 ) * ( 2.0 / 16777216.0 ) - 1.0;
+    }
+
+private:
+    uint32_t m_state;
+};
+
+// Speech-like synthetic signal: one second blocks of low level noise, every
+// |burstPeriod|-th of them with bursts of amplitude modulated harmonics with a
+// gliding pitch, on top of a weak mains hum.
+inline Signal makeSyntheticSignal( unsigned int sampleRate, double seconds, int burstPeriod = 2 )
+{
+    Signal signal;
+    signal.sampleRate = sampleRate;
+    size_t length = static_cast<size_t>( sampleRate * seconds );
+    signal.samples.resize( length );
+
+    const double kPi = 3.14159265358979323846;
+    Lcg rng( 12345 );
+    double phase = 0.0;
+    for( size_t i = 0; i < length; i++ )
+    {
+        double t = double( i ) / sampleRate;
+        double value = 300.0 * rng.next() + 200.0 * std::sin( 2 * kPi * 50.0 * t );
+        bool burst = ( static_cast<int>( t ) % burstPeriod ) == 1;
+        if( burst )
+        {
+            double pitch = 120.0 + 60.0 * std::sin( 2 * kPi * 0.7 * t );
+            phase += 2 * kPi * pitch / sampleRate;
+            double envelope = 0.5 + 0.5 * std::sin( 2 * kPi * 4.0 * t );
+            double voiced = 0.0;
+            for( int h = 1; h <= 12; h++ )
+            {
+                voiced += std::sin( h * phase ) / h;
+            }
+            value += 6000.0 * envelope * voiced;
+        }
+        if( value > 32767.0 )
+            value = 32767.0;
+        if( value < -32768.0 )
+            value = -32768.0;
+        signal.samples[i] = static_cast<int16_t>( value );
+    }
+    return signal;
+}
+
+// Reads a 16-bit mono wav file with the canonical 44 byte header.
+inline bool readWav( const std::string& fileName, Signal& signal )
+{
+    std::ifstream in( fileName.c_str(), std::ios::binary );
+    if( !in )
+        return false;
+    unsigned char header[44];
+    if( !in.read( reinterpret_cast<char*>( header ), sizeof( header ) ) )
+        return false;
+    signal.sampleRate = header[24] | ( header[25] << 8 ) | ( header[26] << 16 ) | ( header[27] << 24 );
+    std::vector<char> data( ( std::istreambuf_iterator<char>( in ) ), std::istreambuf_iterator<char>() );
+    signal.samples.resize( data.size() / 2 );
+    memcpy( signal.samples.data(), data.data(), signal.samples.size() * 2 );
+    return !signal.samples.empty();
+}
+
+// Writes |signal| as a 16-bit mono wav file with the canonical 44 byte header.
+inline bool writeWav( const std::string& fileName, const Signal& signal )
+{
+    FILE* pf = fopen( fileName.c_str(), "wb" );
+    if( nullptr == pf )
+        return false;
+    uint32_t dataSize = static_cast<uint32_t>( signal.samples.size() * 2 );
+    uint32_t fields[] = { 36 + dataSize, 16, 1 | ( 1 << 16 ), signal.sampleRate, signal.sampleRate * 2,
+                          2 | ( 16 << 16 ), dataSize };
+    unsigned char header[44];
+    memcpy( header, "RIFF", 4 );
+    memcpy( header + 8, "WAVEfmt ", 8 );
+    memcpy( header + 36, "data", 4 );
+    const int offsets[] = { 4, 16, 20, 24, 28, 32, 40 };
+    for( int i = 0; i < 7; i++ )
+    {
+        for( int b = 0; b < 4; b++ )
+        {
+            header[offsets[i] + b] = static_cast<unsigned char>( fields[i] >> ( 8 * b ) );
+        }
+    }
+    bool ok = fwrite( header, 1, sizeof( header ), pf ) == sizeof( header ) &&
+              fwrite( signal.samples.data(), 2, signal.samples.size(), pf ) == signal.samples.size();
+    fclose( pf );
+    return ok;
+}
+
+#endif // _BENCH_SIGNAL_H_
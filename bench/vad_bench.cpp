@@ -0,0 +1,903 @@
+/**
+ * Copyright (c) 2022 360Converter - Leo Huang
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Micro-benchmarks for the VAD and SPL kernels.
+//
+// Usage:
+//     vad_bench [--filter substring] [--min-time seconds] [--wav file]
+//
+// Every benchmark runs a kernel over consecutive frames of a deterministic
+// synthetic signal (or of the given 16-bit mono wav file) until at least
+// --min-time seconds have elapsed, and reports the time per frame together
+// with the real-time factor (processing time / audio time).
+
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#include "webrtc/common_audio/signal_processing/dot_product_with_scale.h"
+#include "webrtc/common_audio/signal_processing/include/real_fft.h"
+#include "webrtc/common_audio/vad/vad_core.h"
+#include "webrtc/common_audio/vad/vad_filterbank.h"
+#include "webrtc/common_audio/vad/vad_periodicity.h"
+#include "webrtc/common_audio/vad/vad_sp.h"
+#include "webrtc/common_audio/vad/vad_specialized.h"
+#include "webrtc/common_audio/vad/vad_spectral.h"
+#include "webrtc/system_wrappers/include/cpu_features_wrapper.h"
+#include "bench/bench_signal.h"
+
+#include <algorithm> // std::copy
+#include <chrono> // std::chrono
+#include <cstdint> // int16_t
+#include <cstdio> // printf
+#include <cstdlib> // atof, malloc
+#include <cstring> // strcmp
+#include <functional> // std::function
+#include <string> // std::string
+#include <vector> // std::vector
+
+namespace
+{
+
+// Sink for kernel results so that the compiler can't drop the calls.
+volatile int64_t g_sink = 0;
+
+struct BenchOptions
+{
+    std::string filter;
+    double minTime = 0.2;
+    std::string wavFile;
+};
+
+// Scratch memory of WebRtcVad_WorkspaceSize() bytes for calling the VAD core
+// directly on frames at |sampleRate|.
+struct Workspace
+{
+    explicit Workspace( unsigned int sampleRate ) : memory( ( WebRtcVad_WorkspaceSize() + 3 ) / 4 )
+    {
+        WebRtcVad_InitWorkspace( memory.data(), memory.size() * 4, sampleRate, &work );
+    }
+
+    std::vector<int32_t> memory;
+    VadWorkspaceT work;
+};
+
+// Converts |signal| to |sampleRate| by linear interpolation. Only used to feed
+// a recorded file to kernels that need another rate; quality is irrelevant.
+Signal convertRate( const Signal& signal, unsigned int sampleRate )
+{
+    if( signal.sampleRate == sampleRate )
+        return signal;
+    Signal out;
+    out.sampleRate = sampleRate;
+    size_t length = static_cast<size_t>( double( signal.samples.size() ) * sampleRate / signal.sampleRate );
+    out.samples.resize( length );
+    for( size_t i = 0; i < length; i++ )
+    {
+        double pos = double( i ) * signal.sampleRate / sampleRate;
+        size_t k = static_cast<size_t>( pos );
+        double frac = pos - k;
+        int16_t a = signal.samples[k];
+        int16_t b = k + 1 < signal.samples.size() ? signal.samples[k + 1] : a;
+        out.samples[i] = static_cast<int16_t>( a + ( b - a ) * frac );
+    }
+    return out;
+}
+
+class SignalBank
+{
+public:
+    explicit SignalBank( const BenchOptions& options )
+    {
+        if( !options.wavFile.empty() && readWav( options.wavFile, m_recorded ) )
+        {
+            std::printf( "signal: %s (%u Hz, %.1f s)\n", options.wavFile.c_str(), m_recorded.sampleRate,
+                         double( m_recorded.samples.size() ) / m_recorded.sampleRate );
+        }
+        else
+        {
+            if( !options.wavFile.empty() )
+                std::printf( "warning: failed to read %s, using synthetic signal\n", options.wavFile.c_str() );
+            std::printf( "signal: synthetic (10.0 s)\n" );
+        }
+    }
+
+    // The benchmark signal at |sampleRate|.
+    const Signal& get( unsigned int sampleRate )
+    {
+        for( const Signal& signal : m_cache )
+        {
+            if( signal.sampleRate == sampleRate )
+                return signal;
+        }
+        if( m_recorded.samples.empty() )
+            m_cache.push_back( makeSyntheticSignal( sampleRate, 10.0 ) );
+        else
+            m_cache.push_back( convertRate( m_recorded, sampleRate ) );
+        return m_cache.back();
+    }
+
+private:
+    Signal m_recorded;
+    std::vector<Signal> m_cache;
+};
+
+// Runs |body| (which processes one frame of |frameSeconds| audio) until at
+// least |minTime| seconds have elapsed, then prints one result line.
+void runBenchmark( const BenchOptions& options, const std::string& name, double frameSeconds,
+                   const std::function<void()>& body )
+{
+    if( !options.filter.empty() && name.find( options.filter ) == std::string::npos )
+        return;
+
+    typedef std::chrono::steady_clock Clock;
+    uint64_t iterations = 1;
+    double elapsed = 0.0;
+    for( ;; )
+    {
+        Clock::time_point start = Clock::now();
+        for( uint64_t i = 0; i < iterations; i++ )
+        {
+            body();
+        }
+        elapsed = std::chrono::duration<double>( Clock::now() - start ).count();
+        if( elapsed >= options.minTime || iterations >= ( uint64_t( 1 ) << 40 ) )
+            break;
+        // Aim slightly above the minimum time, growing at most 10x per round.
+        double scale = elapsed > 0.0 ? 1.4 * options.minTime / elapsed : 10.0;
+        if( scale > 10.0 )
+            scale = 10.0;
+        if( scale < 2.0 )
+            scale = 2.0;
+        iterations = static_cast<uint64_t>( iterations * scale );
+    }
+
+    double nsPerFrame = elapsed * 1e9 / iterations;
+    double rtf = elapsed / ( iterations * frameSeconds );
+    std::printf( "%-48s %12.1f %12llu %12.6f %12.0f\n", name.c_str(), nsPerFrame,
+                 static_cast<unsigned long long>( iterations ), rtf, 1.0 / rtf );
+}
+
+// Cycles through consecutive frames of a signal.
+class FrameCursor
+{
+public:
+    FrameCursor( const Signal& signal, size_t frameLength )
+    : m_signal( signal )
+    , m_frameLength( frameLength )
+    , m_offset( 0 )
+    {
+    }
+
+    const int16_t* next()
+    {
+        if( m_offset + m_frameLength > m_signal.samples.size() )
+            m_offset = 0;
+        const int16_t* frame = &m_signal.samples[m_offset];
+        m_offset += m_frameLength;
+        return frame;
+    }
+
+private:
+    const Signal& m_signal;
+    size_t m_frameLength;
+    size_t m_offset;
+};
+
+std::string frameName( const char* kernel, unsigned int sampleRate, int frameMs )
+{
+    char name[128];
+    snprintf( name, sizeof( name ), "%s/%uHz/%dms", kernel, sampleRate, frameMs );
+    return name;
+}
+
+void benchCalculateFeatures( const BenchOptions& options, SignalBank& bank )
+{
+    const Signal& signal = bank.get( 8000 );
+    for( int frameMs = 10; frameMs <= 30; frameMs += 10 )
+    {
+        size_t frameLength = 8 * frameMs;
+        VadInstT inst;
+        WebRtcVad_InitCore( &inst );
+        FrameCursor cursor( signal, frameLength );
+        Workspace scratch( 8000 );
+        VadWorkspaceT& work = scratch.work;
+        int16_t features[kNumChannels];
+        runBenchmark( options, frameName( "WebRtcVad_CalculateFeatures", 8000, frameMs ), frameMs / 1000.0, [&]() {
+            g_sink += WebRtcVad_CalculateFeatures( &inst, cursor.next(), frameLength, &work, features );
+        } );
+        runBenchmark( options, frameName( "WebRtcVad_CalculateFeaturesFloat", 8000, frameMs ), frameMs / 1000.0,
+                      [&]() {
+                          WebRtcVad_CalculateFeaturesFloat( &inst, cursor.next(), frameLength, &work );
+                          g_sink += static_cast<int>( inst.float_state.total_power );
+                      } );
+    }
+}
+
+void benchSpectralFeatures( const BenchOptions& options, SignalBank& bank )
+{
+    const Signal& signal = bank.get( 8000 );
+    for( int frameMs = 10; frameMs <= 30; frameMs += 10 )
+    {
+        size_t frameLength = 8 * frameMs;
+        FrameCursor cursor( signal, frameLength );
+        Workspace scratch( 8000 );
+        VadWorkspaceT& work = scratch.work;
+        int16_t energies[kNumChannels];
+        int16_t flatness;
+        runBenchmark( options, frameName( "WebRtcVad_SpectralFeatures", 8000, frameMs ), frameMs / 1000.0, [&]() {
+            WebRtcVad_SpectralFeatures( cursor.next(), frameLength, &work, energies, &flatness );
+            g_sink += flatness;
+        } );
+    }
+
+    // The generic real FFT wrapper, for comparison.
+    const int kOrder = kSpectralFftOrder;
+    RealFFT* fft = WebRtcSpl_CreateRealFFT( kOrder );
+    FrameCursor cursor( signal, 1 << kOrder );
+    std::vector<int16_t> spectrum( ( 1 << kOrder ) + 2 );
+    runBenchmark( options, "WebRtcSpl_RealForwardFFT/256", 0.032, [&]() {
+        g_sink += WebRtcSpl_RealForwardFFT( fft, cursor.next(), spectrum.data() );
+    } );
+    WebRtcSpl_FreeRealFFT( fft );
+
+    // The whole VAD with the spectral features on top.
+    const Signal& wideband = bank.get( 16000 );
+    VadInst* vad = WebRtcVad_Create();
+    WebRtcVad_Init( vad );
+    WebRtcVad_set_mode( vad, 2 );
+    WebRtcVad_EnableSpectralFeatures( vad, 1 );
+    FrameCursor frames( wideband, 480 );
+    runBenchmark( options, frameName( "WebRtcVad_Process", 16000, 30 ) + "/spectral", 0.03, [&]() {
+        g_sink += WebRtcVad_Process( vad, 16000, frames.next(), 480 );
+    } );
+    WebRtcVad_Free( vad );
+}
+
+void benchGmmProbability( const BenchOptions& options, SignalBank& bank )
+{
+    const Signal& signal = bank.get( 8000 );
+    for( int frameMs = 10; frameMs <= 30; frameMs += 10 )
+    {
+        size_t frameLength = 8 * frameMs;
+
+        // Precompute the feature vectors, so only the GMM is measured.
+        VadInstT inst;
+        WebRtcVad_InitCore( &inst );
+        size_t numFrames = signal.samples.size() / frameLength;
+        std::vector<int16_t> features( numFrames * kNumChannels );
+        std::vector<int16_t> powers( numFrames );
+        Workspace scratch( 8000 );
+        VadWorkspaceT& work = scratch.work;
+        for( size_t i = 0; i < numFrames; i++ )
+        {
+            powers[i] = WebRtcVad_CalculateFeatures( &inst, &signal.samples[i * frameLength], frameLength, &work,
+                                                     &features[i * kNumChannels] );
+        }
+
+        WebRtcVad_InitCore( &inst );
+        size_t frame = 0;
+        runBenchmark( options, frameName( "WebRtcVad_GmmProbability", 8000, frameMs ), frameMs / 1000.0, [&]() {
+            // The GMM doesn't modify the features, so they can be reused.
+            g_sink += WebRtcVad_GmmProbability( &inst, &features[frame * kNumChannels], powers[frame], frameLength );
+            if( ++frame == numFrames )
+                frame = 0;
+        } );
+
+        // The same with the float engine, its features precomputed as well.
+        std::vector<float> floatFeatures( numFrames * kNumChannels );
+        std::vector<float> floatPowers( numFrames );
+        WebRtcVad_InitCore( &inst );
+        for( size_t i = 0; i < numFrames; i++ )
+        {
+            WebRtcVad_CalculateFeaturesFloat( &inst, &signal.samples[i * frameLength], frameLength, &work );
+            std::copy( inst.float_state.feature_vector, inst.float_state.feature_vector + kNumChannels,
+                       &floatFeatures[i * kNumChannels] );
+            floatPowers[i] = inst.float_state.total_power;
+        }
+        WebRtcVad_InitCore( &inst );
+        frame = 0;
+        runBenchmark( options, frameName( "WebRtcVad_GmmProbabilityFloat", 8000, frameMs ), frameMs / 1000.0, [&]() {
+            std::copy( &floatFeatures[frame * kNumChannels], &floatFeatures[frame * kNumChannels] + kNumChannels,
+                       inst.float_state.feature_vector );
+            inst.float_state.total_power = floatPowers[frame];
+            g_sink += WebRtcVad_GmmProbabilityFloat( &inst, frameLength );
+            if( ++frame == numFrames )
+                frame = 0;
+        } );
+    }
+}
+
+void benchFindMinimum( const BenchOptions& options, SignalBank& bank )
+{
+    const Signal& signal = bank.get( 8000 );
+    const size_t frameLength = 240;
+    VadInstT inst;
+    WebRtcVad_InitCore( &inst );
+    size_t numFrames = signal.samples.size() / frameLength;
+    std::vector<int16_t> features( numFrames * kNumChannels );
+    Workspace scratch( 8000 );
+    VadWorkspaceT& work = scratch.work;
+    for( size_t i = 0; i < numFrames; i++ )
+    {
+        WebRtcVad_CalculateFeatures( &inst, &signal.samples[i * frameLength], frameLength, &work,
+                                     &features[i * kNumChannels] );
+    }
+
+    WebRtcVad_InitCore( &inst );
+    inst.frame_counter = 10;
+    size_t frame = 0;
+    // One iteration updates all channels, as done once per frame in the GMM.
+    runBenchmark( options, "WebRtcVad_FindMinimum/6ch", 0.03, [&]() {
+        for( int channel = 0; channel < kNumChannels; channel++ )
+        {
+            g_sink += WebRtcVad_FindMinimum( &inst, features[frame * kNumChannels + channel], channel );
+        }
+        if( ++frame == numFrames )
+            frame = 0;
+    } );
+}
+
+void benchDownsampling( const BenchOptions& options, SignalBank& bank )
+{
+    const unsigned int rates[] = { 16000, 32000 };
+    for( unsigned int sampleRate : rates )
+    {
+        const Signal& signal = bank.get( sampleRate );
+        for( int frameMs = 10; frameMs <= 30; frameMs += 10 )
+        {
+            size_t frameLength = sampleRate / 1000 * frameMs;
+            int32_t state[2] = { 0, 0 };
+            std::vector<int16_t> out( frameLength / 2 );
+            FrameCursor cursor( signal, frameLength );
+            runBenchmark( options, frameName( "WebRtcVad_Downsampling", sampleRate, frameMs ), frameMs / 1000.0,
+                          [&]() {
+                              WebRtcVad_Downsampling( cursor.next(), out.data(), state, frameLength );
+                              g_sink += out[0];
+                          } );
+        }
+    }
+}
+
+void benchResamplers( const BenchOptions& options, SignalBank& bank )
+{
+    // All resamplers work on 10 ms blocks.
+    int32_t tmpmem[512 + 16];
+    int16_t out[480];
+    {
+        FrameCursor cursor( bank.get( 48000 ), 480 );
+        WebRtcSpl_State48khzTo16khz state;
+        WebRtcSpl_ResetResample48khzTo16khz( &state );
+        runBenchmark( options, "WebRtcSpl_Resample48khzTo16khz/10ms", 0.01, [&]() {
+            WebRtcSpl_Resample48khzTo16khz( cursor.next(), out, &state, tmpmem );
+            g_sink += out[0];
+        } );
+    }
+    {
+        FrameCursor cursor( bank.get( 48000 ), 480 );
+        WebRtcSpl_State48khzTo8khz state;
+        WebRtcSpl_ResetResample48khzTo8khz( &state );
+        runBenchmark( options, "WebRtcSpl_Resample48khzTo8khz/10ms", 0.01, [&]() {
+            WebRtcSpl_Resample48khzTo8khz( cursor.next(), out, &state, tmpmem );
+            g_sink += out[0];
+        } );
+    }
+    {
+        // The whole 30 ms frame of WebRtcVad_CalcVad48khz() in one pass.
+        std::vector<int32_t> frameMem( 16 + 1440 );
+        FrameCursor cursor( bank.get( 48000 ), 1440 );
+        WebRtcSpl_State48khzTo8khz state;
+        WebRtcSpl_ResetResample48khzTo8khz( &state );
+        runBenchmark( options, "WebRtcSpl_Resample48khzTo8khzBlocks/30ms", 0.03, [&]() {
+            WebRtcSpl_Resample48khzTo8khzBlocks( cursor.next(), 3, out, &state, frameMem.data() );
+            g_sink += out[0];
+        } );
+    }
+    {
+        // kResampleLanes streams per call; the time per frame covers them all.
+        struct Kernel
+        {
+            const char* suffix;
+            Resample48khzTo8khzLanes function;
+        };
+        std::vector<Kernel> kernels = { { "C", WebRtcSpl_Resample48khzTo8khzLanesC } };
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+        if( WebRtc_GetCPUInfo( kSSE4_1 ) )
+            kernels.push_back( { "SSE41", WebRtcSpl_Resample48khzTo8khzLanesSSE41 } );
+#if defined(WEBRTC_ENABLE_AVX2)
+        if( WebRtc_GetCPUInfo( kAVX2 ) )
+            kernels.push_back( { "AVX2", WebRtcSpl_Resample48khzTo8khzLanesAVX2 } );
+#endif
+#endif
+        std::vector<int32_t> lanesMem( kResample48khzTo8khzLanesMem );
+        std::vector<int16_t> lanesOut( 80 * kResampleLanes );
+        int16_t* outLanes[kResampleLanes];
+        for( int lane = 0; lane < kResampleLanes; lane++ )
+            outLanes[lane] = &lanesOut[80 * lane];
+        for( const Kernel& kernel : kernels )
+        {
+            FrameCursor cursor( bank.get( 48000 ), 480 );
+            WebRtcSpl_State48khzTo8khzLanes state;
+            WebRtcSpl_ResetResample48khzTo8khzLanes( &state );
+            char name[64];
+            snprintf( name, sizeof( name ), "WebRtcSpl_Resample48khzTo8khzLanes%s/%dx10ms", kernel.suffix,
+                      kResampleLanes );
+            runBenchmark( options, name, 0.01 * kResampleLanes, [&]() {
+                const int16_t* inLanes[kResampleLanes];
+                for( int lane = 0; lane < kResampleLanes; lane++ )
+                    inLanes[lane] = cursor.next();
+                kernel.function( inLanes, outLanes, &state, lanesMem.data() );
+                g_sink += lanesOut[0];
+            } );
+        }
+    }
+    {
+        FrameCursor cursor( bank.get( 16000 ), 160 );
+        WebRtcSpl_State16khzTo48khz state;
+        WebRtcSpl_ResetResample16khzTo48khz( &state );
+        runBenchmark( options, "WebRtcSpl_Resample16khzTo48khz/10ms", 0.01, [&]() {
+            WebRtcSpl_Resample16khzTo48khz( cursor.next(), out, &state, tmpmem );
+            g_sink += out[0];
+        } );
+    }
+    {
+        FrameCursor cursor( bank.get( 8000 ), 80 );
+        WebRtcSpl_State8khzTo48khz state;
+        WebRtcSpl_ResetResample8khzTo48khz( &state );
+        runBenchmark( options, "WebRtcSpl_Resample8khzTo48khz/10ms", 0.01, [&]() {
+            WebRtcSpl_Resample8khzTo48khz( cursor.next(), out, &state, tmpmem );
+            g_sink += out[0];
+        } );
+    }
+
+    // The fractional resamplers work on int32 blocks of 3 (2) input samples.
+    const Signal& signal = bank.get( 48000 );
+    std::vector<int32_t> in32( 480 + 8 );
+    for( size_t i = 0; i < in32.size(); i++ )
+    {
+        in32[i] = signal.samples[i] * ( 1 << 8 );
+    }
+    std::vector<int32_t> out32( 480 );
+    runBenchmark( options, "WebRtcSpl_Resample48khzTo32khz/10ms", 0.01, [&]() {
+        WebRtcSpl_Resample48khzTo32khz( in32.data(), out32.data(), 160 );
+        g_sink += out32[0];
+    } );
+    runBenchmark( options, "WebRtcSpl_Resample32khzTo24khz/10ms", 0.01, [&]() {
+        WebRtcSpl_Resample32khzTo24khz( in32.data(), out32.data(), 80 );
+        g_sink += out32[0];
+    } );
+    runBenchmark( options, "WebRtcSpl_Resample44khzTo32khz/10ms", 0.01, [&]() {
+        WebRtcSpl_Resample44khzTo32khz( in32.data(), out32.data(), 40 );
+        g_sink += out32[0];
+    } );
+}
+
+void benchEnergy( const BenchOptions& options, SignalBank& bank )
+{
+    // The filterbank calls WebRtcSpl_Energy() on bands of these lengths for a
+    // 30 ms frame at 8 kHz.
+    const size_t lengths[] = { 15, 30, 60, 120 };
+    struct Kernel
+    {
+        const char* name;
+        Energy function;
+    };
+    std::vector<Kernel> kernels = { { "WebRtcSpl_EnergyC", WebRtcSpl_EnergyC } };
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if( WebRtc_GetCPUInfo( kSSE2 ) )
+        kernels.push_back( { "WebRtcSpl_EnergySSE2", WebRtcSpl_EnergySSE2 } );
+#if defined(WEBRTC_ENABLE_AVX2)
+    if( WebRtc_GetCPUInfo( kAVX2 ) )
+        kernels.push_back( { "WebRtcSpl_EnergyAVX2", WebRtcSpl_EnergyAVX2 } );
+#endif
+#endif
+    const Signal& signal = bank.get( 8000 );
+    for( const Kernel& kernel : kernels )
+    {
+        for( size_t length : lengths )
+        {
+            FrameCursor cursor( signal, length );
+            char name[64];
+            snprintf( name, sizeof( name ), "%s/%zu", kernel.name, length );
+            runBenchmark( options, name, length / 8000.0, [&]() {
+                int scale = 0;
+                g_sink += kernel.function( const_cast<int16_t*>( cursor.next() ), length, &scale );
+                g_sink += scale;
+            } );
+        }
+    }
+}
+
+void benchMinMax( const BenchOptions& options, SignalBank& bank )
+{
+    // One 10 ms and one 30 ms frame at 8 kHz, and a 10 ms frame at 48 kHz.
+    const size_t lengths[] = { 80, 240, 480 };
+    struct Kernels
+    {
+        const char* suffix;
+        MaxAbsValueW16 maxAbsValue;
+        MaxAbsIndexW16 maxAbsIndex;
+        MaxIndexW32 maxIndex;
+    };
+    std::vector<Kernels> kernels = {
+        { "C", WebRtcSpl_MaxAbsValueW16C, WebRtcSpl_MaxAbsIndexW16C, WebRtcSpl_MaxIndexW32C } };
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if( WebRtc_GetCPUInfo( kSSE4_1 ) )
+        kernels.push_back(
+            { "SSE41", WebRtcSpl_MaxAbsValueW16SSE41, WebRtcSpl_MaxAbsIndexW16SSE41, WebRtcSpl_MaxIndexW32SSE41 } );
+#if defined(WEBRTC_ENABLE_AVX2)
+    if( WebRtc_GetCPUInfo( kAVX2 ) )
+        kernels.push_back(
+            { "AVX2", WebRtcSpl_MaxAbsValueW16AVX2, WebRtcSpl_MaxAbsIndexW16AVX2, WebRtcSpl_MaxIndexW32AVX2 } );
+#endif
+#endif
+    const Signal& signal = bank.get( 8000 );
+    std::vector<int32_t> wide( signal.samples.begin(), signal.samples.begin() + 480 );
+    for( const Kernels& kernel : kernels )
+    {
+        for( size_t length : lengths )
+        {
+            FrameCursor cursor( signal, length );
+            char name[64];
+            snprintf( name, sizeof( name ), "WebRtcSpl_MaxAbsValueW16%s/%zu", kernel.suffix, length );
+            runBenchmark( options, name, length / 8000.0,
+                          [&]() { g_sink += kernel.maxAbsValue( cursor.next(), length ); } );
+            snprintf( name, sizeof( name ), "WebRtcSpl_MaxAbsIndexW16%s/%zu", kernel.suffix, length );
+            runBenchmark( options, name, length / 8000.0,
+                          [&]() { g_sink += kernel.maxAbsIndex( cursor.next(), length ); } );
+            snprintf( name, sizeof( name ), "WebRtcSpl_MaxIndexW32%s/%zu", kernel.suffix, length );
+            runBenchmark( options, name, length / 8000.0,
+                          [&]() { g_sink += kernel.maxIndex( wide.data(), length ); } );
+        }
+    }
+}
+
+void benchCorrelation( const BenchOptions& options, SignalBank& bank )
+{
+    // The shape of WebRtcVad_Periodicity() on a 30 ms frame at 8 kHz.
+    const size_t kLength = 240;
+    const size_t kLags = kPeriodicityMaxLag - kPeriodicityMinLag + 1;
+    struct Kernels
+    {
+        const char* suffix;
+        CrossCorrelation crossCorrelation;
+        DotProductWithScale dotProduct;
+    };
+    std::vector<Kernels> kernels = { { "C", WebRtcSpl_CrossCorrelationC, WebRtcSpl_DotProductWithScaleC } };
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if( WebRtc_GetCPUInfo( kSSE2 ) )
+        kernels.push_back( { "SSE2", WebRtcSpl_CrossCorrelationSSE2, WebRtcSpl_DotProductWithScaleSSE2 } );
+#if defined(WEBRTC_ENABLE_AVX2)
+    if( WebRtc_GetCPUInfo( kAVX2 ) )
+        kernels.push_back( { "AVX2", WebRtcSpl_CrossCorrelationAVX2, WebRtcSpl_DotProductWithScaleAVX2 } );
+#endif
+#endif
+    const Signal& signal = bank.get( 8000 );
+    for( const Kernels& kernel : kernels )
+    {
+        FrameCursor cursor( signal, kLength + kPeriodicityMaxLag );
+        char name[64];
+        // Loud frames need a shift, which the SIMD versions apply per term
+        for( int shift = 0; shift <= 2; shift += 2 )
+        {
+            snprintf( name, sizeof( name ), "WebRtcSpl_CrossCorrelation%s/%zux%zu/shift%d", kernel.suffix, kLength,
+                      kLags, shift );
+            runBenchmark( options, name, kLength / 8000.0, [&]() {
+                int32_t corr[kLags];
+                const int16_t* frame = cursor.next() + kPeriodicityMaxLag;
+                kernel.crossCorrelation( corr, frame, frame - kPeriodicityMinLag, kLength, kLags, shift, -1 );
+                g_sink += corr[0];
+            } );
+        }
+        snprintf( name, sizeof( name ), "WebRtcSpl_DotProductWithScale%s/%zu", kernel.suffix, kLength );
+        runBenchmark( options, name, kLength / 8000.0, [&]() {
+            const int16_t* frame = cursor.next();
+            g_sink += kernel.dotProduct( frame, frame + 1, kLength, 2 );
+        } );
+    }
+
+    const unsigned int rates[] = { 8000, 16000, 32000, 48000 };
+    for( unsigned int sampleRate : rates )
+    {
+        const Signal& rateSignal = bank.get( sampleRate );
+        size_t frameLength = sampleRate / 1000 * 30;
+        size_t history = kPeriodicityMaxLag * sampleRate / 8000;
+        FrameCursor cursor( rateSignal, frameLength + history );
+        runBenchmark( options, frameName( "WebRtcVad_Periodicity", sampleRate, 30 ), 0.03, [&]() {
+            size_t lag = 0;
+            g_sink += WebRtcVad_Periodicity( cursor.next() + history, frameLength, history, sampleRate, &lag );
+            g_sink += lag;
+        } );
+    }
+}
+
+void benchProcess( const BenchOptions& options, SignalBank& bank )
+{
+    const unsigned int rates[] = { 8000, 16000, 32000, 48000 };
+    for( unsigned int sampleRate : rates )
+    {
+        const Signal& signal = bank.get( sampleRate );
+        for( int frameMs = 10; frameMs <= 30; frameMs += 10 )
+        {
+            size_t frameLength = sampleRate / 1000 * frameMs;
+            VadInst* vad = WebRtcVad_Create();
+            WebRtcVad_Init( vad );
+            WebRtcVad_set_mode( vad, 2 );
+            FrameCursor cursor( signal, frameLength );
+            runBenchmark( options, frameName( "WebRtcVad_Process", sampleRate, frameMs ), frameMs / 1000.0, [&]() {
+                g_sink += WebRtcVad_Process( vad, sampleRate, cursor.next(), frameLength );
+            } );
+            WebRtcVad_Free( vad );
+        }
+    }
+
+    // The float engine
+    for( unsigned int sampleRate : rates )
+    {
+        const Signal& signal = bank.get( sampleRate );
+        size_t frameLength = sampleRate / 1000 * 30;
+        VadInst* vad = WebRtcVad_Create();
+        WebRtcVad_Init( vad );
+        WebRtcVad_set_mode( vad, 2 );
+        WebRtcVad_SetEngine( vad, kVadEngineFloat );
+        FrameCursor cursor( signal, frameLength );
+        runBenchmark( options, frameName( "WebRtcVad_Process", sampleRate, 30 ) + "/float", 0.03, [&]() {
+            g_sink += WebRtcVad_Process( vad, sampleRate, cursor.next(), frameLength );
+        } );
+        WebRtcVad_Free( vad );
+    }
+
+    // Digital silence with and without the silence gate
+    for( unsigned int sampleRate : rates )
+    {
+        size_t frameLength = sampleRate / 1000 * 30;
+        std::vector<int16_t> silence( frameLength, 0 );
+        for( int threshold = -1; threshold <= 0; threshold++ )
+        {
+            VadInst* vad = WebRtcVad_Create();
+            WebRtcVad_Init( vad );
+            WebRtcVad_set_mode( vad, 2 );
+            WebRtcVad_SetSilenceThreshold( vad, threshold );
+            std::string name = frameName( "WebRtcVad_Process", sampleRate, 30 ) +
+                               ( threshold < 0 ? "/silence" : "/silence/gate" );
+            runBenchmark( options, name, 0.03, [&]() {
+                g_sink += WebRtcVad_Process( vad, sampleRate, silence.data(), frameLength );
+            } );
+            WebRtcVad_Free( vad );
+        }
+    }
+
+    // The specialized core without the checks and the silence gate of the C API
+    {
+        const Signal& signal = bank.get( 16000 );
+        VadInstT inst;
+        WebRtcVad_InitCore( &inst );
+        WebRtcVad_set_mode_core( &inst, 2 );
+        Workspace scratch( 16000 );
+        VadWorkspaceT& work = scratch.work;
+        FrameCursor cursor( signal, 160 );
+        runBenchmark( options, "VadCalcVad<16000, 10>", 0.01, [&]() {
+            g_sink += webrtc::VadCalcVad<16000, 10>( &inst, cursor.next(), &work );
+        } );
+    }
+
+    // Scratch memory in a caller provided workspace instead of on the stack
+    std::vector<int32_t> workspace( ( WebRtcVad_WorkspaceSize() + 3 ) / 4 );
+    for( unsigned int sampleRate : rates )
+    {
+        const Signal& signal = bank.get( sampleRate );
+        size_t frameLength = sampleRate / 1000 * 30;
+        VadInst* vad = WebRtcVad_Create();
+        WebRtcVad_Init( vad );
+        WebRtcVad_set_mode( vad, 2 );
+        WebRtcVad_SetWorkspace( vad, workspace.data(), workspace.size() * 4 );
+        FrameCursor cursor( signal, frameLength );
+        runBenchmark( options, frameName( "WebRtcVad_Process", sampleRate, 30 ) + "/workspace", 0.03, [&]() {
+            g_sink += WebRtcVad_Process( vad, sampleRate, cursor.next(), frameLength );
+        } );
+        WebRtcVad_Free( vad );
+    }
+
+    // kResampleLanes streams at 48 kHz one by one and resampled together; the
+    // time per frame covers them all.
+    {
+        const Signal& signal = bank.get( 48000 );
+        for( int frameMs = 10; frameMs <= 30; frameMs += 20 )
+        {
+            size_t frameLength = 48 * frameMs;
+            std::vector<VadInst*> streams( kResampleLanes );
+            std::vector<FrameCursor> cursors;
+            for( int lane = 0; lane < kResampleLanes; lane++ )
+            {
+                streams[lane] = WebRtcVad_Create();
+                WebRtcVad_Init( streams[lane] );
+                WebRtcVad_set_mode( streams[lane], 2 );
+                WebRtcVad_SetWorkspace( streams[lane], workspace.data(), workspace.size() * 4 );
+                cursors.emplace_back( signal, frameLength );
+                for( int skip = 0; skip < lane * 37; skip++ )
+                    cursors.back().next();
+            }
+            std::vector<int32_t> lanesMemory( ( WebRtcVad_LanesWorkspaceSize() + 3 ) / 4 );
+            const int16_t* frames[kResampleLanes];
+            int decisions[kResampleLanes];
+            std::string suffix = "/x" + std::to_string( kResampleLanes );
+            runBenchmark( options, frameName( "WebRtcVad_Process", 48000, frameMs ) + suffix,
+                          frameMs / 1000.0 * kResampleLanes, [&]() {
+                              for( int lane = 0; lane < kResampleLanes; lane++ )
+                                  g_sink += WebRtcVad_Process( streams[lane], 48000, cursors[lane].next(),
+                                                               frameLength );
+                          } );
+            runBenchmark( options, frameName( "WebRtcVad_ProcessLanes48khz", 48000, frameMs ) + suffix,
+                          frameMs / 1000.0 * kResampleLanes, [&]() {
+                              for( int lane = 0; lane < kResampleLanes; lane++ )
+                                  frames[lane] = cursors[lane].next();
+                              WebRtcVad_ProcessLanes48khz( streams.data(), kResampleLanes, frames, frameLength,
+                                                           lanesMemory.data(), lanesMemory.size() * 4,
+                                                           decisions );
+                              g_sink += decisions[0];
+                          } );
+            for( VadInst* vad : streams )
+                WebRtcVad_Free( vad );
+        }
+    }
+}
+
+// Instance setup, reset, snapshot and teardown, and round-robin processing of many streams
+// with heap allocated and pooled instances.
+void benchInstances( const BenchOptions& options, SignalBank& bank )
+{
+    runBenchmark( options, "WebRtcVad_Create+Init+Free", 0.01, [&]() {
+        VadInst* vad = WebRtcVad_Create();
+        g_sink += WebRtcVad_Init( vad );
+        WebRtcVad_Free( vad );
+    } );
+
+    VadInst* reused = WebRtcVad_Create();
+    WebRtcVad_Init( reused );
+    runBenchmark( options, "WebRtcVad_Init", 0.01, [&]() { g_sink += WebRtcVad_Init( reused ); } );
+    runBenchmark( options, "WebRtcVad_Reset", 0.01, [&]() { g_sink += WebRtcVad_Reset( reused ); } );
+    std::vector<uint8_t> snapshot( WebRtcVad_SnapshotSize() );
+    WebRtcVad_Snapshot( reused, snapshot.data(), snapshot.size() );
+    runBenchmark( options, "WebRtcVad_Snapshot", 0.01,
+                  [&]() { g_sink += WebRtcVad_Snapshot( reused, snapshot.data(), snapshot.size() ); } );
+    runBenchmark( options, "WebRtcVad_Restore", 0.01,
+                  [&]() { g_sink += WebRtcVad_Restore( reused, snapshot.data(), snapshot.size() ); } );
+    WebRtcVad_Free( reused );
+
+    const size_t kStreams = 5000;
+    VadPool* pool = WebRtcVad_CreatePool( kStreams );
+    runBenchmark( options, "WebRtcVad_PoolAcquire+Init+Release", 0.01, [&]() {
+        VadInst* vad = WebRtcVad_PoolAcquire( pool );
+        g_sink += WebRtcVad_Init( vad );
+        WebRtcVad_PoolRelease( pool, vad );
+    } );
+
+    const unsigned int sampleRate = 16000;
+    const size_t frameLength = sampleRate / 100;
+    const Signal& signal = bank.get( sampleRate );
+    std::vector<VadInst*> heap;
+    std::vector<VadInst*> pooled;
+    std::vector<void*> scatter;
+    for( size_t i = 0; i < kStreams; i++ )
+    {
+        // Interleave other allocations, as a media server would
+        heap.push_back( WebRtcVad_Create() );
+        scatter.push_back( malloc( 256 + i % 512 ) );
+        pooled.push_back( WebRtcVad_PoolAcquire( pool ) );
+        WebRtcVad_Init( heap.back() );
+        WebRtcVad_Init( pooled.back() );
+    }
+    const std::vector<VadInst*>* sets[] = { &heap, &pooled };
+    const char* names[] = { "WebRtcVad_Process/16000Hz/10ms/x5000/malloc",
+                            "WebRtcVad_Process/16000Hz/10ms/x5000/pool" };
+    for( int k = 0; k < 2; k++ )
+    {
+        const std::vector<VadInst*>& instances = *sets[k];
+        FrameCursor cursor( signal, frameLength );
+        size_t stream = 0;
+        runBenchmark( options, names[k], 0.01, [&]() {
+            g_sink += WebRtcVad_Process( instances[stream], sampleRate, cursor.next(), frameLength );
+            if( ++stream == instances.size() )
+                stream = 0;
+        } );
+    }
+
+    // The pooled streams configured once, with the function of WebRtcVad_Configure()
+    // per frame instead of checking the rate and frame length every time
+    WebRtcVadProcessFn process = nullptr;
+    for( VadInst* vad : pooled )
+        process = WebRtcVad_Configure( vad, sampleRate, frameLength );
+    {
+        FrameCursor cursor( signal, frameLength );
+        size_t stream = 0;
+        runBenchmark( options, "WebRtcVad_Configure/16000Hz/10ms/x5000/pool", 0.01, [&]() {
+            g_sink += process( pooled[stream], cursor.next() );
+            if( ++stream == pooled.size() )
+                stream = 0;
+        } );
+    }
+
+    // Gated silence, where the per frame overhead of the C API is a large part of the work
+    std::vector<int16_t> silence( frameLength, 0 );
+    for( VadInst* vad : pooled )
+        WebRtcVad_SetSilenceThreshold( vad, 0 );
+    for( int configured = 0; configured < 2; configured++ )
+    {
+        size_t stream = 0;
+        const char* name = configured ? "WebRtcVad_Configure/16000Hz/10ms/x5000/gate"
+                                      : "WebRtcVad_Process/16000Hz/10ms/x5000/gate";
+        runBenchmark( options, name, 0.01, [&]() {
+            if( configured )
+                g_sink += process( pooled[stream], silence.data() );
+            else
+                g_sink += WebRtcVad_Process( pooled[stream], sampleRate, silence.data(), frameLength );
+            if( ++stream == pooled.size() )
+                stream = 0;
+        } );
+    }
+    for( size_t i = 0; i < kStreams; i++ )
+    {
+        WebRtcVad_Free( heap[i] );
+        free( scatter[i] );
+    }
+    WebRtcVad_FreePool( pool );
+}
+
+} // namespace
+
+int main( int argc, char* argv[] )
+{
+    BenchOptions options;
+    for( int i = 1; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "--filter" ) == 0 && i + 1 < argc )
+        {
+            options.filter = argv[++i];
+        }
+        else if( strcmp( argv[i], "--min-time" ) == 0 && i + 1 < argc )
+        {
+            options.minTime = atof( argv[++i] );
+        }
+        else if( strcmp( argv[i], "--wav" ) == 0 && i + 1 < argc )
+        {
+            options.wavFile = argv[++i];
+        }
+        else
+        {
+            std::printf( "Usage: %s [--filter substring] [--min-time seconds] [--wav file]\n", argv[0] );
+            return -1;
+        }
+    }
+
+    WebRtcSpl_Init();
+    SignalBank bank( options );
+
+    std::printf( "%-48s %12s %12s %12s %12s\n", "Benchmark", "ns/frame", "Iterations", "RTF", "xRealtime" );
+    std::printf( "%s\n", std::string( 100, '-' ).c_str() );
+    benchCalculateFeatures( options, bank );
+    benchSpectralFeatures( options, bank );
+    benchGmmProbability( options, bank );
+    benchFindMinimum( options, bank );
+    benchDownsampling( options, bank );
+    benchResamplers( options, bank );
+    benchEnergy( options, bank );
+    benchMinMax( options, bank );
+    benchCorrelation( options, bank );
+    benchProcess( options, bank );
+    benchInstances( options, bank );
+
+    return 0;
+}
@@ -0,0 +1,646 @@
+/**
+ * Copyright (c) 2022 360Converter - Leo Huang
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// End-to-end throughput of vadSplit(): read -> frame -> VAD -> collect -> write.
+//
+// Usage:
+//     vad_split_bench [--seconds n] [--repeat n] [--wav file] [--metrics file]
+//
+// For every sample rate and aggressiveness the whole pipeline is run on a
+// synthetic wav file (or once per aggressiveness on the given file), writing
+// the chunks as wav files into a scratch directory, removed at the end.
+// Reported are the real-time factor, hours of audio per core-second, the peak
+// RSS of the process, the number of C++ allocations per run and the share of
+// each stage.
+// When built with VAD_PROFILING the stage tick counters are printed as well.
+// With --metrics the vadSplit() metrics are written in Prometheus text format,
+// with frame timing enabled.
+//
+// The coarse scan is compared with the dense one on sparse speech, one burst
+// every ten seconds, reporting the VAD time saved and the largest boundary
+// difference.
+//
+// The boundary refinement is checked against the known onsets and offsets
+// of the bursts of the synthetic signal, which lie on whole seconds.
+//
+// The float engine is compared with the fixed point one on every signal,
+// reporting the VAD time and the largest boundary difference.
+//
+// The endpointer is run on every signal in 10 ms chunks, measuring how long
+// after the whole second a burst ends on its end is reported.
+//
+// Finally every signal is streamed by a capture thread through an
+// SpscRingBuffer in 10 ms chunks to a VadStreamSegmenter on the main thread,
+// and the segments are checked against vadSplit() on the whole buffer.
+
+#include "vadMetrics.h"
+#include "vadSegmenter.h"
+#include "vadSplit.h"
+#include "bench/bench_signal.h"
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+
+#include <algorithm> // std::min
+#include <atomic> // std::atomic
+#include <cmath> // std::abs
+#include <cstdio> // printf
+#include <cstdlib> // malloc
+#include <cstring> // strcmp
+#include <ctime> // std::clock
+#include <iostream> // std::cout
+#include <new> // std::bad_alloc
+#include <sstream> // std::ostringstream
+#include <string> // std::string
+#include <thread> // std::thread
+#include <vector> // std::vector
+
+#if defined(WEBRTC_POSIX)
+#include <dirent.h> // opendir, readdir
+#include <sys/resource.h> // getrusage
+#include <unistd.h> // chdir, getcwd, rmdir, unlink
+#endif
+
+namespace
+{
+
+std::atomic<uint64_t> g_allocations( 0 );
+
+// Peak resident set size of the process in MB, 0 if unknown.
+double peakRssMb()
+{
+#if defined(WEBRTC_POSIX)
+    struct rusage usage;
+    if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+    {
+#if defined(__APPLE__)
+        return usage.ru_maxrss / ( 1024.0 * 1024.0 );
+#else
+        return usage.ru_maxrss / 1024.0;
+#endif
+    }
+#endif
+    return 0.0;
+}
+
+// Moves into a scratch directory, so the chunk files don't litter the
+// current one, and removes it with the files written into it when it goes
+// out of scope.
+struct ScratchDirectory
+{
+    std::string path; // empty if staying in place
+
+    ScratchDirectory()
+    {
+#if defined(WEBRTC_POSIX)
+        char name[] = "/tmp/vad_split_bench.XXXXXX";
+        if( mkdtemp( name ) == nullptr )
+            return;
+        if( chdir( name ) == 0 )
+            path = name;
+        else
+            rmdir( name );
+#endif
+    }
+
+    ~ScratchDirectory()
+    {
+#if defined(WEBRTC_POSIX)
+        if( path.empty() || chdir( path.c_str() ) != 0 )
+            return;
+        if( DIR* dir = opendir( "." ) )
+        {
+            while( dirent* entry = readdir( dir ) )
+            {
+                if( strcmp( entry->d_name, "." ) != 0 && strcmp( entry->d_name, ".." ) != 0 )
+                    unlink( entry->d_name );
+            }
+            closedir( dir );
+        }
+        if( chdir( "/" ) == 0 )
+            rmdir( path.c_str() );
+#endif
+    }
+
+    ScratchDirectory( const ScratchDirectory& ) = delete;
+    ScratchDirectory& operator=( const ScratchDirectory& ) = delete;
+};
+
+struct BenchOptions
+{
+    double seconds = 60.0;
+    int repeat = 3;
+    std::string wavFile;
+    std::string metricsFile;
+};
+
+void runPipeline( const BenchOptions& options, const std::string& wavFile, unsigned int sampleRate,
+                  int aggressiveness )
+{
+    VadSplitStats stats;
+    uint64_t segments = 0;
+
+    // vadSplit() reports every frame decision on std::cout, mute it while
+    // measuring so the terminal isn't part of the benchmark.
+    std::ostringstream sink;
+    std::streambuf* coutBuf = std::cout.rdbuf( sink.rdbuf() );
+    uint64_t allocations = g_allocations.load();
+    std::clock_t cpuStart = std::clock();
+    for( int i = 0; i < options.repeat; i++ )
+    {
+        std::vector<VadSegment> result;
+        vadSplit( wavFile.c_str(), result, 1, aggressiveness, &stats );
+        segments += result.size();
+        sink.str( std::string() );
+    }
+    double cpuTime = double( std::clock() - cpuStart ) / CLOCKS_PER_SEC;
+    allocations = g_allocations.load() - allocations;
+    std::cout.rdbuf( coutBuf );
+
+    double wallTime = stats.readTime + stats.frameTime + stats.vadTime + stats.collectTime + stats.writeTime;
+    double rtf = wallTime / stats.audioDuration;
+    double hoursPerCoreSecond = cpuTime > 0.0 ? stats.audioDuration / 3600.0 / cpuTime : 0.0;
+    std::printf( "%6u %5d %10.6f %10.2f %9.1f %10.1f %8.1f | %5.1f %5.1f %5.1f %5.1f %5.1f\n", sampleRate,
+                 aggressiveness, rtf, hoursPerCoreSecond, peakRssMb(), double( allocations ) / options.repeat,
+                 double( segments ) / options.repeat, 100.0 * stats.readTime / wallTime,
+                 100.0 * stats.frameTime / wallTime, 100.0 * stats.vadTime / wallTime,
+                 100.0 * stats.collectTime / wallTime, 100.0 * stats.writeTime / wallTime );
+}
+
+// Runs vadSplit() on |signal| densely and with the coarse scan.
+void runCoarse( const Signal& signal, int aggressiveness, unsigned int maxBoundaryErrorMs )
+{
+    std::vector<VadSegment> dense, coarse;
+    VadSplitStats denseStats, coarseStats;
+    VadSplitOptions options;
+    options.aggressiveness = aggressiveness;
+    const char* audio = reinterpret_cast<const char*>( signal.samples.data() );
+    uint64_t length = signal.samples.size() * sizeof( int16_t );
+
+    std::ostringstream sink;
+    std::streambuf* coutBuf = std::cout.rdbuf( sink.rdbuf() );
+    options.stats = &denseStats;
+    vadSplit( audio, length, signal.sampleRate, dense, options );
+    options.stats = &coarseStats;
+    options.maxBoundaryErrorMs = maxBoundaryErrorMs;
+    vadSplit( audio, length, signal.sampleRate, coarse, options );
+    std::cout.rdbuf( coutBuf );
+
+    // Largest distance of a coarse boundary to the nearest dense one
+    double maxError = 0.0;
+    for( const VadSegment& c : coarse )
+    {
+        double start = 1e9, end = 1e9;
+        for( const VadSegment& d : dense )
+        {
+            start = std::min( start, double( std::abs( c.start - d.start ) ) );
+            end = std::min( end, double( std::abs( c.end - d.end ) ) );
+        }
+        maxError = std::max( maxError, std::max( start, end ) );
+    }
+    std::printf( "%6u %5d %10.6f %10.6f %8.1f %5zu %5zu %10.0f\n", signal.sampleRate, aggressiveness,
+                 denseStats.vadTime / denseStats.audioDuration, coarseStats.vadTime / coarseStats.audioDuration,
+                 100.0 * coarseStats.skippedFrames / coarseStats.frames, dense.size(), coarse.size(),
+                 1000.0 * maxError );
+}
+
+// Runs vadSplit() on |signal| with the fixed point and the float engine.
+void runEngines( const Signal& signal, int aggressiveness )
+{
+    std::vector<VadSegment> fixed, floats;
+    VadSplitStats fixedStats, floatStats;
+    VadSplitOptions options;
+    options.aggressiveness = aggressiveness;
+    const char* audio = reinterpret_cast<const char*>( signal.samples.data() );
+    uint64_t length = signal.samples.size() * sizeof( int16_t );
+
+    std::ostringstream sink;
+    std::streambuf* coutBuf = std::cout.rdbuf( sink.rdbuf() );
+    options.stats = &fixedStats;
+    vadSplit( audio, length, signal.sampleRate, fixed, options );
+    options.stats = &floatStats;
+    options.engine = kVadEngineFloat;
+    vadSplit( audio, length, signal.sampleRate, floats, options );
+    std::cout.rdbuf( coutBuf );
+
+    // Largest distance of a float boundary to the nearest fixed point one
+    double maxError = 0.0;
+    for( const VadSegment& f : floats )
+    {
+        double start = 1e9, end = 1e9;
+        for( const VadSegment& d : fixed )
+        {
+            start = std::min( start, double( std::abs( f.start - d.start ) ) );
+            end = std::min( end, double( std::abs( f.end - d.end ) ) );
+        }
+        maxError = std::max( maxError, std::max( start, end ) );
+    }
+    std::printf( "%6u %5d %10.6f %10.6f %5zu %5zu %10.0f\n", signal.sampleRate, aggressiveness,
+                 fixedStats.vadTime / fixedStats.audioDuration, floatStats.vadTime / floatStats.audioDuration,
+                 fixed.size(), floats.size(), floats.empty() ? 0.0 : 1000.0 * maxError );
+}
+
+// Runs vadSplit() on |signal| with and without boundary refinement, and
+// prints the mean distance of the boundaries to the whole second the burst
+// starts or ends on.
+void runRefine( const Signal& signal, int aggressiveness, unsigned int refineWindowMs )
+{
+    VadSplitOptions options;
+    options.aggressiveness = aggressiveness;
+    const char* audio = reinterpret_cast<const char*>( signal.samples.data() );
+    uint64_t length = signal.samples.size() * sizeof( int16_t );
+    double error[2] = { 0.0, 0.0 };
+    size_t count = 0;
+    double refineTime = 0.0;
+    for( int k = 0; k < 2; k++ )
+    {
+        std::vector<VadSegment> segments;
+        VadSplitStats stats;
+        options.stats = &stats;
+        options.refineWindowMs = k == 0 ? 0 : refineWindowMs;
+        std::ostringstream sink;
+        std::streambuf* coutBuf = std::cout.rdbuf( sink.rdbuf() );
+        vadSplit( audio, length, signal.sampleRate, segments, options );
+        std::cout.rdbuf( coutBuf );
+        for( const VadSegment& segment : segments )
+        {
+            double start = double( segment.offset ) / ( 2 * signal.sampleRate );
+            double end = start + double( segment.length ) / ( 2 * signal.sampleRate );
+            error[k] += std::abs( start - std::round( start ) ) + std::abs( end - std::round( end ) );
+        }
+        count = 2 * segments.size();
+        if( k == 1 )
+            refineTime = stats.collectTime;
+    }
+    std::printf( "%6u %5d %12.1f %12.1f %10.6f\n", signal.sampleRate, aggressiveness, 1000.0 * error[0] / count,
+                 1000.0 * error[1] / count, refineTime / ( double( signal.samples.size() ) / signal.sampleRate ) );
+}
+
+// Adds a stationary two tone beep (440 and 1320 Hz) to every fourth second of
+// |signal|, one that has no burst.
+Signal addTonalNoise( const Signal& signal )
+{
+    const double kPi = 3.14159265358979323846;
+    Signal noisy = signal;
+    for( size_t i = 0; i < noisy.samples.size(); i++ )
+    {
+        double t = double( i ) / noisy.sampleRate;
+        if( static_cast<int>( t ) % 4 != 2 )
+            continue;
+        double value = noisy.samples[i] + 3000.0 * std::sin( 2 * kPi * 440.0 * t ) +
+                       1500.0 * std::sin( 2 * kPi * 1320.0 * t );
+        noisy.samples[i] = static_cast<int16_t>( std::max( -32768.0, std::min( 32767.0, value ) ) );
+    }
+    return noisy;
+}
+
+// Runs vadSplit() on |signal| with tonal noise added, with and without
+// tonalRejectMs, and prints the seconds of segments over the tones and over
+// the bursts.
+void runTonal( const Signal& signal, int aggressiveness, unsigned int tonalRejectMs )
+{
+    Signal noisy = addTonalNoise( signal );
+    VadSplitOptions options;
+    options.aggressiveness = aggressiveness;
+    const char* audio = reinterpret_cast<const char*>( noisy.samples.data() );
+    uint64_t length = noisy.samples.size() * sizeof( int16_t );
+    double tonal[2] = { 0.0, 0.0 }, speech[2] = { 0.0, 0.0 };
+    VadSplitStats stats[2];
+    for( int k = 0; k < 2; k++ )
+    {
+        std::vector<VadSegment> segments;
+        options.tonalRejectMs = k == 0 ? 0 : tonalRejectMs;
+        options.stats = &stats[k];
+        std::ostringstream sink;
+        std::streambuf* coutBuf = std::cout.rdbuf( sink.rdbuf() );
+        vadSplit( audio, length, noisy.sampleRate, segments, options );
+        std::cout.rdbuf( coutBuf );
+        for( const VadSegment& segment : segments )
+        {
+            for( int second = static_cast<int>( segment.start ); second < segment.end; second++ )
+            {
+                double overlap = std::min<double>( segment.end, second + 1 ) - std::max<double>( segment.start, second );
+                if( second % 4 == 2 )
+                    tonal[k] += overlap;
+                else if( second % 2 == 1 )
+                    speech[k] += overlap;
+            }
+        }
+    }
+    std::printf( "%6u %5d %9.2f %9.2f %9.2f %9.2f %8llu %10.6f %10.6f\n", signal.sampleRate, aggressiveness,
+                 tonal[0], tonal[1], speech[0], speech[1], static_cast<unsigned long long>( stats[1].tonalFrames ),
+                 stats[0].vadTime / stats[0].audioDuration, stats[1].vadTime / stats[1].audioDuration );
+}
+
+// Pushes |signal| through a VadEndpointer in 10 ms chunks, and prints the
+// delay of the end events after the true end of the bursts, along with the
+// latencies the endpointer reports itself.
+void runEndpointer( const Signal& signal, int aggressiveness )
+{
+    VadEndpointerConfig config;
+    config.aggressiveness = aggressiveness;
+    double totalDelay = 0.0, maxDelay = 0.0;
+    VadEndpointer endpointer( signal.sampleRate, config, [&]( const VadEndpointEvent& event ) {
+        if( event.type != VadEndpointEvent::kEnd )
+            return;
+        // Bursts end on even seconds
+        double decision = double( event.decisionSample ) / signal.sampleRate;
+        double delay = decision - 2.0 * std::floor( decision / 2.0 );
+        totalDelay += delay;
+        maxDelay = std::max( maxDelay, delay );
+    } );
+    size_t chunk = signal.sampleRate / 100;
+    for( size_t offset = 0; offset < signal.samples.size(); offset += chunk )
+        endpointer.process( signal.samples.data() + offset, std::min( chunk, signal.samples.size() - offset ) );
+    const VadEndpointerStats& stats = endpointer.stats();
+    std::printf( "%6u %5d %6llu %6llu %10.1f %10.1f %10.1f %10.1f %10.3f\n", signal.sampleRate, aggressiveness,
+                 static_cast<unsigned long long>( stats.starts ), static_cast<unsigned long long>( stats.ends ),
+                 stats.ends ? 1000.0 * totalDelay / stats.ends : 0.0, 1000.0 * maxDelay, stats.meanStartLatencyMs,
+                 stats.meanEndLatencyMs, stats.maxProcessingMs );
+}
+
+// Streams |signal| from a capture thread to the segmenter, returns false if
+// the segments differ from those of vadSplit().
+bool runStream( const Signal& signal, int aggressiveness )
+{
+    std::vector<VadSegment> expected;
+    std::ostringstream sink;
+    std::streambuf* coutBuf = std::cout.rdbuf( sink.rdbuf() );
+    vadSplit( reinterpret_cast<const char*>( signal.samples.data() ), signal.samples.size() * sizeof( int16_t ),
+              signal.sampleRate, expected, -1, aggressiveness );
+    std::cout.rdbuf( coutBuf );
+
+    std::vector<VadSegment> segments;
+    VadStreamSegmenter segmenter( signal.sampleRate, aggressiveness,
+                                  [&segments]( const VadSegment& segment ) { segments.push_back( segment ); } );
+    Buffers::SpscRingBuffer<int16_t> buffer( signal.sampleRate );
+    std::atomic<bool> done( false );
+    std::clock_t cpuStart = std::clock();
+    std::thread capture( [&]() {
+        size_t chunk = signal.sampleRate / 100;
+        size_t offset = 0;
+        while( offset < signal.samples.size() )
+        {
+            size_t n = std::min( chunk, signal.samples.size() - offset );
+            offset += buffer.write( signal.samples.data() + offset, n );
+            std::this_thread::yield();
+        }
+        done = true;
+    } );
+    while( !done.load() || buffer.readAvailable() > 0 )
+    {
+        if( segmenter.consume( buffer ) == 0 )
+            std::this_thread::yield();
+    }
+    capture.join();
+    segmenter.flush();
+    double cpuTime = double( std::clock() - cpuStart ) / CLOCKS_PER_SEC;
+
+    // vadSplit() drops the last frame when the audio ends on a frame boundary
+    bool match = segments.size() == expected.size();
+    for( size_t i = 0; match && i < segments.size(); i++ )
+    {
+        match = segments[i].offset == expected[i].offset &&
+                ( segments[i].length == expected[i].length || i + 1 == segments.size() );
+    }
+    std::printf( "%6u %5d %10.6f %8zu %s\n", signal.sampleRate, aggressiveness,
+                 cpuTime * signal.sampleRate / signal.samples.size(), segments.size(), match ? "ok" : "MISMATCH" );
+    return match;
+}
+
+} // namespace
+
+// Count every C++ allocation of the process.
+void* operator new( size_t size )
+{
+    g_allocations++;
+    void* p = malloc( size ? size : 1 );
+    if( p == nullptr )
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[]( size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete( void* p ) noexcept
+{
+    free( p );
+}
+
+void operator delete[]( void* p ) noexcept
+{
+    free( p );
+}
+
+void operator delete( void* p, size_t ) noexcept
+{
+    free( p );
+}
+
+void operator delete[]( void* p, size_t ) noexcept
+{
+    free( p );
+}
+
+int main( int argc, char* argv[] )
+{
+    BenchOptions options;
+    for( int i = 1; i < argc; i++ )
+    {
+        if( strcmp( argv[i], "--seconds" ) == 0 && i + 1 < argc )
+        {
+            options.seconds = atof( argv[++i] );
+        }
+        else if( strcmp( argv[i], "--repeat" ) == 0 && i + 1 < argc )
+        {
+            options.repeat = atoi( argv[++i] );
+        }
+        else if( strcmp( argv[i], "--wav" ) == 0 && i + 1 < argc )
+        {
+            options.wavFile = argv[++i];
+        }
+        else if( strcmp( argv[i], "--metrics" ) == 0 && i + 1 < argc )
+        {
+            options.metricsFile = argv[++i];
+        }
+        else
+        {
+            std::printf( "Usage: %s [--seconds n] [--repeat n] [--wav file] [--metrics file]\n", argv[0] );
+            return -1;
+        }
+    }
+    if( options.repeat < 1 )
+        options.repeat = 1;
+
+    // Resolve the input and output before changing directory.
+#if defined(WEBRTC_POSIX)
+    if( !options.metricsFile.empty() && options.metricsFile[0] != '/' )
+    {
+        char cwd[4096];
+        if( getcwd( cwd, sizeof( cwd ) ) != nullptr )
+            options.metricsFile = std::string( cwd ) + "/" + options.metricsFile;
+    }
+#endif
+    if( !options.metricsFile.empty() )
+        vadMetrics().setFrameTiming( true );
+    Signal recorded;
+    if( !options.wavFile.empty() && !readWav( options.wavFile, recorded ) )
+    {
+        std::printf( "Failed to read %s\n", options.wavFile.c_str() );
+        return -1;
+    }
+    ScratchDirectory scratch;
+    std::printf( "chunks are written to %s\n", scratch.path.empty() ? "the current directory" : scratch.path.c_str() );
+
+    std::printf( "%6s %5s %10s %10s %9s %10s %8s | %5s %5s %5s %5s %5s\n", "rate", "aggr", "RTF", "h/core-s",
+                 "peakRSS", "allocs/run", "segments", "read%", "frame%", "vad%", "coll%", "write%" );
+    std::printf( "%s\n", std::string( 106, '-' ).c_str() );
+
+    std::vector<Signal> signals;
+    if( recorded.samples.empty() )
+    {
+        const unsigned int rates[] = { 8000, 16000, 32000, 48000 };
+        for( unsigned int sampleRate : rates )
+        {
+            signals.push_back( makeSyntheticSignal( sampleRate, options.seconds ) );
+        }
+    }
+    else
+    {
+        signals.push_back( recorded );
+    }
+
+    for( const Signal& signal : signals )
+    {
+        char wavFile[64];
+        snprintf( wavFile, sizeof( wavFile ), "input-%u.wav", signal.sampleRate );
+        if( !writeWav( wavFile, signal ) )
+        {
+            std::printf( "Failed to write %s\n", wavFile );
+            return -1;
+        }
+        for( int aggressiveness = 0; aggressiveness <= 3; aggressiveness++ )
+        {
+            runPipeline( options, wavFile, signal.sampleRate, aggressiveness );
+        }
+        remove( wavFile );
+    }
+
+    if( recorded.samples.empty() )
+    {
+        const unsigned int kMaxBoundaryErrorMs = 240;
+        std::printf( "\ncoarse scan, max boundary error %u ms, sparse speech\n", kMaxBoundaryErrorMs );
+        std::printf( "%6s %5s %10s %10s %8s %5s %5s %10s\n", "rate", "aggr", "VAD-RTF", "coarse", "skipped%",
+                     "segs", "coarse", "max err ms" );
+        for( const Signal& signal : signals )
+        {
+            Signal sparse = makeSyntheticSignal( signal.sampleRate, options.seconds, 10 );
+            for( int aggressiveness = 0; aggressiveness <= 3; aggressiveness++ )
+            {
+                runCoarse( sparse, aggressiveness, kMaxBoundaryErrorMs );
+            }
+        }
+    }
+
+    if( recorded.samples.empty() )
+    {
+        const unsigned int kRefineWindowMs = 500;
+        std::printf( "\nboundary refinement, window %u ms\n", kRefineWindowMs );
+        std::printf( "%6s %5s %12s %12s %10s\n", "rate", "aggr", "frame err ms", "refined ms", "coll-RTF" );
+        for( const Signal& signal : signals )
+        {
+            for( int aggressiveness = 0; aggressiveness <= 3; aggressiveness++ )
+            {
+                runRefine( signal, aggressiveness, kRefineWindowMs );
+            }
+        }
+    }
+
+    if( recorded.samples.empty() )
+    {
+        const unsigned int kTonalRejectMs = 300;
+        std::printf( "\ntonal noise rejection, %u ms, seconds of segments\n", kTonalRejectMs );
+        std::printf( "%6s %5s %9s %9s %9s %9s %8s %10s %10s\n", "rate", "aggr", "tones", "tones rej", "bursts",
+                     "burst rej", "frames", "VAD-RTF", "rej-RTF" );
+        for( const Signal& signal : signals )
+        {
+            for( int aggressiveness = 0; aggressiveness <= 3; aggressiveness++ )
+            {
+                runTonal( signal, aggressiveness, kTonalRejectMs );
+            }
+        }
+    }
+
+    if( recorded.samples.empty() )
+    {
+        std::printf( "\nendpointing, 10 ms frames\n" );
+        std::printf( "%6s %5s %6s %6s %10s %10s %10s %10s %10s\n", "rate", "aggr", "starts", "ends", "end ms",
+                     "max end ms", "start lat", "end lat", "max proc" );
+        for( const Signal& signal : signals )
+        {
+            for( int aggressiveness = 0; aggressiveness <= 3; aggressiveness++ )
+            {
+                runEndpointer( signal, aggressiveness );
+            }
+        }
+    }
+
+    std::printf( "\nfloat engine\n" );
+    std::printf( "%6s %5s %10s %10s %5s %5s %10s\n", "rate", "aggr", "VAD-RTF", "float", "segs", "float",
+                 "max err ms" );
+    for( const Signal& signal : signals )
+    {
+        for( int aggressiveness = 0; aggressiveness <= 3; aggressiveness++ )
+        {
+            runEngines( signal, aggressiveness );
+        }
+    }
+
+    std::printf( "\nstreaming through SpscRingBuffer\n" );
+    std::printf( "%6s %5s %10s %8s %s\n", "rate", "aggr", "CPU-RTF", "segments", "vs vadSplit" );
+    bool streamOk = true;
+    for( const Signal& signal : signals )
+    {
+        for( int aggressiveness = 0; aggressiveness <= 3; aggressiveness++ )
+        {
+            streamOk = runStream( signal, aggressiveness ) && streamOk;
+        }
+    }
+
+    if( !options.metricsFile.empty() && !vadMetrics().writePrometheus( options.metricsFile.c_str() ) )
+    {
+        std::printf( "Failed to write %s\n", options.metricsFile.c_str() );
+        return -1;
+    }
+
+    // Only available when built with -DVAD_PROFILING=ON
+    WebRtcVadProfile profile;
+    if( WebRtcVad_GetProfile( nullptr, &profile ) == 0 )
+    {
+        const char* names[kVadNumStages] = { "process", "features", "gmm", "spectral", "read", "write" };
+        std::printf( "\n%10s %12s %14s\n", "stage", "calls", "ticks/call" );
+        for( int stage = 0; stage < kVadNumStages; stage++ )
+        {
+            std::printf( "%10s %12llu %14.1f\n", names[stage], static_cast<unsigned long long>( profile.calls[stage] ),
+                         profile.calls[stage] ? double( profile.ticks[stage] ) / profile.calls[stage] : 0.0 );
+        }
+    }
+
+    return streamOk ? 0 : -1;
+}
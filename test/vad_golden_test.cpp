@@ -0,0 +1,1889 @@
+/**
+ * Copyright (c) 2022 360Converter - Leo Huang
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Bit-exactness regression harness for the VAD.
+//
+// Usage:
+//     vad_golden_test golden_file            compare against the golden file
+//     vad_golden_test --update golden_file   regenerate the golden file
+//     vad_golden_test --diff                 compare dispatch tiers
+//     vad_golden_test --state                check reset, snapshot, restore, configured streams,
+//                                            workspaces, spectral features, the hangover and
+//                                            48 kHz lanes
+//     vad_golden_test --float                measure the agreement of the float engine
+//     vad_golden_test --init                 call the SPL based functions before any VAD instance
+//     vad_golden_test --split                check the segment boundaries of vadSplit()
+//
+// A corpus of generated signals (silence, tones, noise, chirps, speech-like
+// bursts, clipping) is run through WebRtcVad_Process() at every sample rate
+// and aggressiveness. For every case the per-frame decisions are stored
+// verbatim, while the per-frame features and the adaptive model state are
+// folded into hashes. The signals use integer arithmetic only, so the corpus
+// is identical on every platform.
+//
+// The differential mode runs every case with the SPL function pointers bound
+// to the generic C versions and to the native versions, and reports the first
+// frame where the decision, the features or the model state differ. It also
+// runs the SIMD kernels the CPU supports against the generic C versions on
+// vectors of every length up to 256 samples.
+//
+// The state mode checks on every case that an instance restored from a
+// snapshot taken half way continues exactly like the original, and that an
+// instance reset with WebRtcVad_Reset() behaves like a new one. It also checks
+// that a warm start from an adapted noise profile cuts spurious speech, and
+// that the silence gate with threshold 0 skips frames without changing any
+// decision.
+//
+// The float mode runs every case with the float engine and reports how many
+// of its decisions agree with the fixed point engine, which is checked against
+// a lower bound.
+//
+// The init mode has to run in a process of its own: it calls the public
+// functions built on the SPL function pointers before any VAD instance has
+// set them up, and the index functions after only WebRtcSpl_Init().
+//
+// The split mode runs vadSplit() on utterances with known onsets and offsets,
+// and checks that the coarse scan moves no boundary of the dense scan by more
+// than its maximum boundary error, that the boundary refinement lands within
+// 20 ms of the onsets and offsets, and that the segments keep their minimum
+// and maximum length, with long utterances cut in their pauses. The
+// endpointer has to report the end of every utterance within 100 ms.
+
+#include "vadMetrics.h"
+#include "vadSegmenter.h"
+#include "vadSplit.h"
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#include "webrtc/common_audio/signal_processing/dot_product_with_scale.h"
+#include "webrtc/common_audio/vad/vad_core.h"
+#include "webrtc/common_audio/vad/vad_periodicity.h"
+#include "webrtc/system_wrappers/include/cpu_features_wrapper.h"
+
+#include <algorithm> // std::copy, std::fill, std::max
+#include <cmath> // std::abs, std::isfinite
+#include <cstdint> // int16_t
+#include <cstdio> // printf
+#include <cstring> // strcmp
+#include <fstream> // std::ifstream
+#include <iterator> // std::begin
+#include <iostream> // std::cout
+#include <sstream> // std::istringstream
+#include <string> // std::string
+#include <vector> // std::vector
+
+namespace
+{
+
+const int kCorpusSeconds = 2;
+const unsigned int kRates[] = { 8000, 16000, 32000, 48000 };
+
+// Deterministic pseudo random generator (LCG).
+class Lcg
+{
+public:
+    explicit Lcg( uint32_t seed ) : m_state( seed ) {}
+
+    // Uniform value in [-amplitude, amplitude]
+    int next( int amplitude )
+    {
+        m_state = m_state * 1664525u + 1013904223u;
+        return static_cast<int>( ( m_state >> 16 ) % ( 2 * amplitude + 1 ) ) - amplitude;
+    }
+
+private:
+    uint32_t m_state;
+};
+
+// Integer sine of |phase| (a full cycle is 2^32) with |amplitude|, using
+// Bhaskara's approximation so that no floating point is involved.
+int isin( uint32_t phase, int amplitude )
+{
+    const int64_t kHalf = 1 << 15;
+    int64_t u = ( phase >> 16 ) & ( kHalf - 1 );
+    int64_t p = u * ( kHalf - u );
+    int64_t value = amplitude * 4 * p / ( 5 * kHalf * kHalf / 4 - p );
+    return static_cast<int>( ( phase & 0x80000000u ) ? -value : value );
+}
+
+// Phase increment of a |frequency| Hz oscillator.
+uint32_t phaseStep( int frequency, unsigned int sampleRate )
+{
+    return static_cast<uint32_t>( ( uint64_t( frequency ) << 32 ) / sampleRate );
+}
+
+int16_t saturate( int value )
+{
+    if( value > 32767 )
+        return 32767;
+    if( value < -32768 )
+        return -32768;
+    return static_cast<int16_t>( value );
+}
+
+// Speech-like voiced sound: harmonics of a gliding pitch.
+int voiced( uint32_t phase, int amplitude )
+{
+    int value = 0;
+    for( int h = 1; h <= 8; h++ )
+    {
+        value += isin( phase * h, amplitude / h );
+    }
+    return value;
+}
+
+std::vector<int16_t> makeSignal( const std::string& name, unsigned int sampleRate )
+{
+    size_t length = sampleRate * kCorpusSeconds;
+    std::vector<int16_t> samples( length, 0 );
+    Lcg rng( 4711 );
+    uint32_t phase = 0;
+    uint32_t pitchPhase = 0;
+    for( size_t i = 0; i < length; i++ )
+    {
+        // Time in ms, for gating.
+        size_t ms = i * 1000 / sampleRate;
+        int value = 0;
+        if( name == "silence" )
+        {
+            value = 0;
+        }
+        else if( name == "tone" )
+        {
+            phase += phaseStep( 440, sampleRate );
+            value = isin( phase, 8000 );
+        }
+        else if( name == "noise" )
+        {
+            value = rng.next( 2000 );
+        }
+        else if( name == "quiet" )
+        {
+            value = rng.next( 40 );
+        }
+        else if( name == "chirp" )
+        {
+            // 100 Hz to 3900 Hz over the whole signal.
+            int frequency = 100 + static_cast<int>( 3800 * i / length );
+            phase += phaseStep( frequency, sampleRate );
+            value = isin( phase, 10000 );
+        }
+        else if( name == "bursts" )
+        {
+            int pitch = 110 + static_cast<int>( ( ms / 7 ) % 90 );
+            pitchPhase += phaseStep( pitch, sampleRate );
+            value = rng.next( 150 );
+            if( ( ms / 300 ) % 2 == 1 )
+                value += voiced( pitchPhase, 6000 );
+        }
+        else if( name == "mixed" )
+        {
+            // Speech-like bursts on hum and noise, with a stretch of digital
+            // silence in the middle.
+            pitchPhase += phaseStep( 140 + static_cast<int>( ( ms / 11 ) % 60 ), sampleRate );
+            phase += phaseStep( 50, sampleRate );
+            value = rng.next( 300 ) + isin( phase, 400 );
+            if( ms % 700 < 350 )
+                value += voiced( pitchPhase, 9000 );
+            if( ms >= 800 && ms < 1300 )
+                value = 0;
+        }
+        else if( name == "clipped" )
+        {
+            // Full scale square wave, including -32768.
+            phase += phaseStep( 220, sampleRate );
+            value = ( phase & 0x80000000u ) ? -32768 : 32767;
+        }
+        samples[i] = saturate( value );
+    }
+    return samples;
+}
+
+const char* const kSignals[] = { "silence", "tone", "noise", "quiet", "chirp", "bursts", "mixed", "clipped" };
+
+// 64-bit FNV-1a.
+class Hash
+{
+public:
+    Hash() : m_value( 14695981039346656037ull ) {}
+
+    template <class T>
+    void add( const T* data, size_t count )
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>( data );
+        for( size_t i = 0; i < count * sizeof( T ); i++ )
+        {
+            m_value = ( m_value ^ bytes[i] ) * 1099511628211ull;
+        }
+    }
+
+    uint64_t value() const { return m_value; }
+
+private:
+    uint64_t m_value;
+};
+
+// Everything that is compared for one frame.
+struct FrameRecord
+{
+    int decision;
+    int raw;
+    int16_t features[kNumChannels];
+    int16_t totalPower;
+    uint64_t state;
+};
+
+// Hash of the adaptive state of |inst|.
+uint64_t stateHash( const VadInstT* inst )
+{
+    Hash hash;
+    hash.add( inst->downsampling_filter_states, 4 );
+    hash.add( &inst->state_48_to_8, 1 );
+    hash.add( inst->noise_means, kTableSize );
+    hash.add( inst->speech_means, kTableSize );
+    hash.add( inst->noise_stds, kTableSize );
+    hash.add( inst->speech_stds, kTableSize );
+    hash.add( &inst->frame_counter, 1 );
+    hash.add( &inst->over_hang, 1 );
+    hash.add( &inst->num_of_speech, 1 );
+    hash.add( inst->index_vector, 16 * kNumChannels );
+    hash.add( inst->low_value_vector, 16 * kNumChannels );
+    hash.add( inst->mean_value, kNumChannels );
+    hash.add( inst->upper_state, 5 );
+    hash.add( inst->lower_state, 5 );
+    hash.add( inst->hp_filter_state, 4 );
+    return hash.value();
+}
+
+struct Case
+{
+    std::string signal;
+    unsigned int sampleRate;
+    int mode;
+    int frameMs;
+
+    std::string key() const
+    {
+        char text[96];
+        snprintf( text, sizeof( text ), "%s %u %d %d", signal.c_str(), sampleRate, mode, frameMs );
+        return text;
+    }
+};
+
+std::vector<Case> corpus()
+{
+    std::vector<Case> cases;
+    int index = 0;
+    for( const char* signal : kSignals )
+    {
+        for( unsigned int sampleRate : kRates )
+        {
+            for( int mode = 0; mode <= 3; mode++ )
+            {
+                // Rotate through the frame sizes, so every combination of
+                // rate and frame size is covered by several signals.
+                Case c = { signal, sampleRate, mode, 10 * ( index++ % 3 + 1 ) };
+                cases.push_back( c );
+            }
+        }
+    }
+    return cases;
+}
+
+// Processes frames [begin, end) of |samples| with |vad| into |records|, with
+// WebRtcVad_Process() or, if given, the |configured| function.
+bool processFrames( VadInst* vad, const Case& c, const std::vector<int16_t>& samples, size_t begin, size_t end,
+                    std::vector<FrameRecord>& records, WebRtcVadProcessFn configured = nullptr )
+{
+    size_t frameLength = c.sampleRate / 1000 * c.frameMs;
+    const VadInstT* inst = reinterpret_cast<const VadInstT*>( vad );
+    for( size_t frame = begin; frame < end; frame++ )
+    {
+        FrameRecord record;
+        if( configured )
+            record.decision = configured( vad, &samples[frame * frameLength] );
+        else
+            record.decision = WebRtcVad_Process( vad, c.sampleRate, &samples[frame * frameLength], frameLength );
+        if( record.decision < 0 )
+            return false;
+        record.raw = inst->vad;
+        memcpy( record.features, inst->feature_vector, sizeof( record.features ) );
+        record.totalPower = inst->total_power;
+        record.state = stateHash( inst );
+        records.push_back( record );
+    }
+    return true;
+}
+
+// Runs |c| and returns one record per frame. Returns false on a VAD error.
+bool runCase( const Case& c, std::vector<FrameRecord>& records )
+{
+    std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+    size_t frames = samples.size() / ( c.sampleRate / 1000 * c.frameMs );
+
+    records.clear();
+    VadInst* vad = WebRtcVad_Create();
+    bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+              processFrames( vad, c, samples, 0, frames, records );
+    WebRtcVad_Free( vad );
+    return ok;
+}
+
+// One line of the golden file: case, decisions and hashes.
+std::string summarize( const Case& c, const std::vector<FrameRecord>& records )
+{
+    std::string decisions;
+    Hash features;
+    Hash state;
+    for( const FrameRecord& record : records )
+    {
+        decisions += static_cast<char>( '0' + record.decision );
+        features.add( record.features, kNumChannels );
+        features.add( &record.totalPower, 1 );
+        state.add( &record.raw, 1 );
+        state.add( &record.state, 1 );
+    }
+    char hashes[64];
+    snprintf( hashes, sizeof( hashes ), " %016llx %016llx ", static_cast<unsigned long long>( features.value() ),
+              static_cast<unsigned long long>( state.value() ) );
+    return c.key() + hashes + decisions;
+}
+
+int update( const char* goldenFile )
+{
+    FILE* pf = fopen( goldenFile, "w" );
+    if( nullptr == pf )
+    {
+        std::printf( "Failed to write %s\n", goldenFile );
+        return 1;
+    }
+    std::fprintf( pf, "# signal rate mode frame_ms feature_hash state_hash decisions\n" );
+    for( const Case& c : corpus() )
+    {
+        std::vector<FrameRecord> records;
+        if( !runCase( c, records ) )
+        {
+            std::printf( "VAD error in %s\n", c.key().c_str() );
+            fclose( pf );
+            return 1;
+        }
+        std::fprintf( pf, "%s\n", summarize( c, records ).c_str() );
+    }
+    fclose( pf );
+    std::printf( "Wrote %s\n", goldenFile );
+    return 0;
+}
+
+int verify( const char* goldenFile )
+{
+    std::ifstream in( goldenFile );
+    if( !in )
+    {
+        std::printf( "Failed to read %s\n", goldenFile );
+        return 1;
+    }
+    std::vector<std::string> golden;
+    std::string line;
+    while( std::getline( in, line ) )
+    {
+        if( !line.empty() && line[0] != '#' )
+            golden.push_back( line );
+    }
+
+    std::vector<Case> cases = corpus();
+    if( golden.size() != cases.size() )
+    {
+        std::printf( "Golden file has %zu cases, corpus has %zu\n", golden.size(), cases.size() );
+        return 1;
+    }
+
+    int failures = 0;
+    for( size_t i = 0; i < cases.size(); i++ )
+    {
+        std::vector<FrameRecord> records;
+        if( !runCase( cases[i], records ) )
+        {
+            std::printf( "FAIL %s: VAD error\n", cases[i].key().c_str() );
+            failures++;
+            continue;
+        }
+        std::string actual = summarize( cases[i], records );
+        if( actual == golden[i] )
+            continue;
+
+        failures++;
+        std::istringstream expectedFields( golden[i] );
+        std::istringstream actualFields( actual );
+        std::string expected[7], got[7];
+        for( int k = 0; k < 7; k++ )
+        {
+            expectedFields >> expected[k];
+            actualFields >> got[k];
+        }
+        std::printf( "FAIL %s:", cases[i].key().c_str() );
+        if( expected[6] != got[6] )
+        {
+            size_t frame = 0;
+            while( frame < expected[6].size() && frame < got[6].size() && expected[6][frame] == got[6][frame] )
+                frame++;
+            std::printf( " decisions differ from frame %zu (%.2f s)", frame,
+                         frame * cases[i].frameMs / 1000.0 );
+        }
+        if( expected[4] != got[4] )
+            std::printf( " features differ" );
+        if( expected[5] != got[5] )
+            std::printf( " model state differs" );
+        std::printf( "\n" );
+    }
+    std::printf( "%zu cases, %d failed\n", cases.size(), failures );
+    return failures == 0 ? 0 : 1;
+}
+
+bool sameRecords( const std::vector<FrameRecord>& a, const std::vector<FrameRecord>& b )
+{
+    if( a.size() != b.size() )
+        return false;
+    for( size_t i = 0; i < a.size(); i++ )
+    {
+        if( a[i].decision != b[i].decision || a[i].raw != b[i].raw || a[i].totalPower != b[i].totalPower ||
+            memcmp( a[i].features, b[i].features, sizeof( a[i].features ) ) != 0 || a[i].state != b[i].state )
+            return false;
+    }
+    return true;
+}
+
+int stateRoundTrip()
+{
+    int failures = 0;
+    std::vector<Case> cases = corpus();
+    std::vector<uint8_t> snapshot( WebRtcVad_SnapshotSize() );
+    for( const Case& c : cases )
+    {
+        std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+        size_t frames = samples.size() / ( c.sampleRate / 1000 * c.frameMs );
+        size_t half = frames / 2;
+
+        std::vector<FrameRecord> reference, original, restored, reset;
+        runCase( c, reference );
+
+        // Snapshot half way, continue in the original and in a new instance
+        VadInst* vad = WebRtcVad_Create();
+        VadInst* copy = WebRtcVad_Create();
+        bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+                  processFrames( vad, c, samples, 0, half, original ) &&
+                  WebRtcVad_Snapshot( vad, snapshot.data(), snapshot.size() ) == int( snapshot.size() ) &&
+                  WebRtcVad_Restore( copy, snapshot.data(), snapshot.size() ) == 0 &&
+                  processFrames( vad, c, samples, half, frames, original ) &&
+                  processFrames( copy, c, samples, half, frames, restored );
+        std::vector<FrameRecord> tail( original.begin() + half, original.end() );
+        ok = ok && sameRecords( original, reference ) && sameRecords( tail, restored );
+
+        // Reset after adapting to the whole signal, then start over
+        ok = ok && WebRtcVad_Reset( vad ) == 0 && processFrames( vad, c, samples, 0, frames, reset ) &&
+             sameRecords( reset, reference );
+        WebRtcVad_Free( vad );
+        WebRtcVad_Free( copy );
+        if( !ok )
+        {
+            std::printf( "FAIL %s: state round trip\n", c.key().c_str() );
+            failures++;
+        }
+    }
+
+    // The silence gate for exact zeros is bit exact on every case
+    int64_t silentFrames = 0;
+    for( const Case& c : cases )
+    {
+        std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+        size_t frames = samples.size() / ( c.sampleRate / 1000 * c.frameMs );
+        std::vector<FrameRecord> reference, gated;
+        runCase( c, reference );
+        VadInst* vad = WebRtcVad_Create();
+        bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+                  WebRtcVad_SetSilenceThreshold( vad, 0 ) == 0 && processFrames( vad, c, samples, 0, frames, gated ) &&
+                  sameRecords( gated, reference );
+        silentFrames += WebRtcVad_SilentFrames( vad );
+        WebRtcVad_Free( vad );
+        if( !ok )
+        {
+            std::printf( "FAIL %s: silence gate\n", c.key().c_str() );
+            failures++;
+        }
+    }
+    std::printf( "frames skipped by the silence gate: %lld\n", static_cast<long long>( silentFrames ) );
+    if( silentFrames == 0 )
+    {
+        std::printf( "FAIL silence gate skips no frames\n" );
+        failures++;
+    }
+
+    // The function of WebRtcVad_Configure() matches WebRtcVad_Process() on
+    // every case, with and without the silence gate
+    for( const Case& c : cases )
+    {
+        std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+        size_t frameLength = c.sampleRate / 1000 * c.frameMs;
+        size_t frames = samples.size() / frameLength;
+        bool ok = true;
+        for( int threshold = -1; threshold <= 0; threshold++ )
+        {
+            std::vector<FrameRecord> reference, configured;
+            VadInst* vad = WebRtcVad_Create();
+            VadInst* other = WebRtcVad_Create();
+            ok = ok && WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+                 WebRtcVad_SetSilenceThreshold( vad, threshold ) == 0 &&
+                 processFrames( vad, c, samples, 0, frames, reference ) && WebRtcVad_Init( other ) == 0 &&
+                 WebRtcVad_set_mode( other, c.mode ) == 0 && WebRtcVad_SetSilenceThreshold( other, threshold ) == 0;
+            WebRtcVadProcessFn process = WebRtcVad_Configure( other, c.sampleRate, frameLength );
+            ok = ok && process != nullptr && processFrames( other, c, samples, 0, frames, configured, process ) &&
+                 sameRecords( configured, reference );
+            WebRtcVad_Free( vad );
+            WebRtcVad_Free( other );
+        }
+        if( !ok )
+        {
+            std::printf( "FAIL %s: configured stream\n", c.key().c_str() );
+            failures++;
+        }
+    }
+    VadInst* unconfigured = WebRtcVad_Create();
+    WebRtcVad_Init( unconfigured );
+    if( WebRtcVad_Configure( unconfigured, 16000, 100 ) != nullptr ||
+        WebRtcVad_Configure( unconfigured, 44100, 441 ) != nullptr || WebRtcVad_Configure( nullptr, 8000, 80 ) )
+    {
+        std::printf( "FAIL WebRtcVad_Configure() accepts an invalid format\n" );
+        failures++;
+    }
+    WebRtcVadProcessFn stale = WebRtcVad_Configure( unconfigured, 8000, 80 );
+    WebRtcVad_Init( unconfigured );
+    std::vector<int16_t> frame( 80, 0 );
+    if( reinterpret_cast<const VadInstT*>( unconfigured )->configured_calc != nullptr ||
+        stale( unconfigured, frame.data() ) != -1 )
+    {
+        std::printf( "FAIL format of WebRtcVad_Configure() kept by WebRtcVad_Init()\n" );
+        failures++;
+    }
+    WebRtcVad_Free( unconfigured );
+    VadPool* configuredPool = WebRtcVad_CreatePool( 1 );
+    VadInst* pooled = WebRtcVad_PoolAcquire( configuredPool );
+    WebRtcVad_Init( pooled );
+    stale = WebRtcVad_Configure( pooled, 8000, 80 );
+    WebRtcVad_PoolRelease( configuredPool, pooled );
+    if( stale( pooled, frame.data() ) != -1 )
+    {
+        std::printf( "FAIL format of WebRtcVad_Configure() kept by WebRtcVad_PoolRelease()\n" );
+        failures++;
+    }
+    WebRtcVad_FreePool( configuredPool );
+
+    // The pool gives back only its own instances, once
+    {
+        VadPool* pool = WebRtcVad_CreatePool( 2 );
+        VadInst* first = WebRtcVad_PoolAcquire( pool );
+        VadInst* second = WebRtcVad_PoolAcquire( pool );
+        VadInst* foreign = WebRtcVad_Create();
+        VadInst* inside = reinterpret_cast<VadInst*>( reinterpret_cast<char*>( first ) + 8 );
+        bool ok = WebRtcVad_PoolRelease( pool, foreign ) == -1 && WebRtcVad_PoolRelease( pool, inside ) == -1 &&
+                  WebRtcVad_PoolRelease( pool, first ) == 0 && WebRtcVad_PoolRelease( pool, first ) == -1 &&
+                  WebRtcVad_PoolAvailable( pool ) == 1;
+        VadInst* again = WebRtcVad_PoolAcquire( pool );
+        ok = ok && again == first && WebRtcVad_PoolAcquire( pool ) == nullptr &&
+             WebRtcVad_PoolRelease( pool, second ) == 0 && WebRtcVad_PoolRelease( pool, again ) == 0 &&
+             WebRtcVad_PoolAvailable( pool ) == 2 && WebRtcVad_CreatePool( SIZE_MAX / 64 ) == nullptr;
+        if( !ok )
+        {
+            std::printf( "FAIL pool accepts a foreign or released instance\n" );
+            failures++;
+        }
+        WebRtcVad_Free( foreign );
+        WebRtcVad_FreePool( pool );
+    }
+
+    // The float engine: refused values, no snapshot or noise profile, reset
+    // like a new instance, forgotten by WebRtcVad_Init() and WebRtcVad_Restore()
+    {
+        Case c = { "mixed", 16000, 2, 10 };
+        std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+        size_t frames = samples.size() / ( c.sampleRate / 100 );
+        std::vector<FrameRecord> fresh, reset;
+        std::vector<uint8_t> snapshot( WebRtcVad_SnapshotSize() );
+        WebRtcVadNoiseProfile profile;
+        VadInst* vad = WebRtcVad_Create();
+        const VadInstT* inst = reinterpret_cast<const VadInstT*>( vad );
+        bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_Snapshot( vad, snapshot.data(), snapshot.size() ) > 0 &&
+                  WebRtcVad_set_mode( vad, c.mode ) == 0 && WebRtcVad_SetEngine( vad, 2 ) == -1 &&
+                  WebRtcVad_SetEngine( nullptr, kVadEngineFloat ) == -1 &&
+                  WebRtcVad_SetEngine( vad, kVadEngineFloat ) == 0 &&
+                  processFrames( vad, c, samples, 0, frames, fresh ) &&
+                  WebRtcVad_Snapshot( vad, snapshot.data(), snapshot.size() ) == -1 &&
+                  WebRtcVad_GetNoiseProfile( vad, &profile ) == -1 &&
+                  WebRtcVad_SetNoiseProfile( vad, &profile ) == -1 && WebRtcVad_Reset( vad ) == 0 &&
+                  processFrames( vad, c, samples, 0, frames, reset ) && sameRecords( fresh, reset ) &&
+                  WebRtcVad_Restore( vad, snapshot.data(), snapshot.size() ) == 0 &&
+                  inst->engine == kVadEngineFixed && WebRtcVad_SetEngine( vad, kVadEngineFloat ) == 0 &&
+                  WebRtcVad_Init( vad ) == 0 && inst->engine == kVadEngineFixed;
+        if( !ok )
+        {
+            std::printf( "FAIL float engine settings\n" );
+            failures++;
+        }
+        WebRtcVad_Free( vad );
+    }
+
+    // Spectral features leave the decisions unchanged on every case, and
+    // their flatness tells the noise from the tone signals
+    int64_t noiseFlatness = 0, toneFlatness = 0;
+    size_t noiseFrames = 0, toneFrames = 0;
+    for( const Case& c : cases )
+    {
+        std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+        size_t frames = samples.size() / ( c.sampleRate / 1000 * c.frameMs );
+        std::vector<FrameRecord> reference, spectral;
+        runCase( c, reference );
+        VadInst* vad = WebRtcVad_Create();
+        bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+                  WebRtcVad_EnableSpectralFeatures( vad, 1 ) == 0;
+        for( size_t frame = 0; ok && frame < frames; frame++ )
+        {
+            WebRtcVadSpectralFeatures features;
+            ok = processFrames( vad, c, samples, frame, frame + 1, spectral ) &&
+                 WebRtcVad_GetSpectralFeatures( vad, &features ) == 0;
+            if( !ok )
+                break;
+            if( c.signal == "noise" || c.signal == "quiet" )
+            {
+                noiseFlatness += features.flatness;
+                noiseFrames++;
+            }
+            else if( c.signal == "tone" || c.signal == "chirp" )
+            {
+                toneFlatness += features.flatness;
+                toneFrames++;
+            }
+        }
+        ok = ok && sameRecords( spectral, reference );
+        WebRtcVad_Free( vad );
+        if( !ok )
+        {
+            std::printf( "FAIL %s: spectral features\n", c.key().c_str() );
+            failures++;
+        }
+    }
+    double noiseMean = noiseFlatness / 16384.0 / std::max<size_t>( noiseFrames, 1 );
+    double toneMean = toneFlatness / 16384.0 / std::max<size_t>( toneFrames, 1 );
+    std::printf( "mean spectral flatness: %.3f noise, %.3f tones\n", noiseMean, toneMean );
+    if( noiseMean < 0.4 || toneMean > 0.1 )
+    {
+        std::printf( "FAIL spectral flatness does not separate noise from tones\n" );
+        failures++;
+    }
+    VadInst* plain = WebRtcVad_Create();
+    WebRtcVadSpectralFeatures unused;
+    WebRtcVad_Init( plain );
+    if( WebRtcVad_GetSpectralFeatures( plain, &unused ) == 0 )
+    {
+        std::printf( "FAIL spectral features without WebRtcVad_EnableSpectralFeatures()\n" );
+        failures++;
+    }
+    WebRtcVad_Free( plain );
+
+    // Without the hangover its frames turn unvoiced, and nothing else changes
+    for( const Case& c : cases )
+    {
+        std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+        size_t frames = samples.size() / ( c.sampleRate / 1000 * c.frameMs );
+        std::vector<FrameRecord> reference, direct;
+        runCase( c, reference );
+        VadInst* vad = WebRtcVad_Create();
+        bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+                  WebRtcVad_EnableHangover( vad, 0 ) == 0 && processFrames( vad, c, samples, 0, frames, direct ) &&
+                  direct.size() == reference.size();
+        for( size_t i = 0; ok && i < direct.size(); i++ )
+        {
+            ok = direct[i].decision == ( reference[i].raw > 1 ? 0 : reference[i].decision );
+            direct[i].decision = reference[i].decision;
+        }
+        ok = ok && sameRecords( direct, reference );
+        WebRtcVad_Free( vad );
+        if( !ok )
+        {
+            std::printf( "FAIL %s: hangover disabled\n", c.key().c_str() );
+            failures++;
+        }
+    }
+    if( WebRtcVad_EnableHangover( nullptr, 0 ) == 0 )
+    {
+        std::printf( "FAIL hangover setting on a null instance\n" );
+        failures++;
+    }
+
+    // 48 kHz streams resampled together match WebRtcVad_Process() on each,
+    // with a full and a partial batch of lanes and every setting that
+    // changes the path
+    for( size_t frameMs = 10; frameMs <= 30; frameMs += 10 )
+    {
+        const size_t kStreams = kResampleLanes + 3;
+        const unsigned int kRate = 48000;
+        size_t frameLength = kRate / 1000 * frameMs;
+        std::vector<std::vector<int16_t>> signals;
+        std::vector<VadInst*> single, lanes;
+        bool ok = true;
+        for( size_t i = 0; i < kStreams; i++ )
+        {
+            signals.push_back( makeSignal( kSignals[i % 8], kRate ) );
+            for( int k = 0; k < 2; k++ )
+            {
+                VadInst* vad = WebRtcVad_Create();
+                ok = ok && WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, int( i % 4 ) ) == 0;
+                if( i % 5 == 1 )
+                    ok = ok && WebRtcVad_SetEngine( vad, kVadEngineFloat ) == 0;
+                if( i % 3 == 0 )
+                    ok = ok && WebRtcVad_SetSilenceThreshold( vad, 100 ) == 0;
+                if( i % 4 == 2 )
+                    ok = ok && WebRtcVad_EnableSpectralFeatures( vad, 1 ) == 0;
+                if( i % 7 == 3 )
+                    ok = ok && WebRtcVad_EnableHangover( vad, 0 ) == 0;
+                ( k == 0 ? single : lanes ).push_back( vad );
+            }
+        }
+        std::vector<uint8_t> memory( WebRtcVad_LanesWorkspaceSize() + 4 );
+        void* workspace = memory.data() + ( 4 - reinterpret_cast<uintptr_t>( memory.data() ) % 4 ) % 4;
+        std::vector<const int16_t*> frames( kStreams );
+        std::vector<int> decisions( kStreams );
+        size_t count = signals[0].size() / frameLength;
+        for( size_t frame = 0; ok && frame < count; frame++ )
+        {
+            for( size_t i = 0; i < kStreams; i++ )
+                frames[i] = &signals[i][frame * frameLength];
+            ok = WebRtcVad_ProcessLanes48khz( lanes.data(), kStreams, frames.data(), frameLength, workspace,
+                                              WebRtcVad_LanesWorkspaceSize(), decisions.data() ) == 0;
+            for( size_t i = 0; ok && i < kStreams; i++ )
+            {
+                const VadInstT* a = reinterpret_cast<const VadInstT*>( single[i] );
+                const VadInstT* b = reinterpret_cast<const VadInstT*>( lanes[i] );
+                ok = WebRtcVad_Process( single[i], kRate, frames[i], frameLength ) == decisions[i] &&
+                     a->vad == b->vad && stateHash( a ) == stateHash( b ) &&
+                     memcmp( &a->float_state, &b->float_state, sizeof( a->float_state ) ) == 0 &&
+                     memcmp( a->spectral_energy, b->spectral_energy, sizeof( a->spectral_energy ) ) == 0 &&
+                     WebRtcVad_SilentFrames( single[i] ) == WebRtcVad_SilentFrames( lanes[i] );
+                if( !ok )
+                    std::printf( "FAIL lanes: stream %zu differs at frame %zu of %zu ms\n", i, frame, frameMs );
+            }
+        }
+        // Refused without processing anything
+        VadInst* uninitialized = WebRtcVad_Create();
+        std::vector<VadInst*> refused = lanes;
+        refused.back() = uninitialized;
+        uint64_t before = stateHash( reinterpret_cast<const VadInstT*>( lanes[0] ) );
+        ok = ok &&
+             WebRtcVad_ProcessLanes48khz( refused.data(), kStreams, frames.data(), frameLength, workspace,
+                                          WebRtcVad_LanesWorkspaceSize(), decisions.data() ) == -1 &&
+             WebRtcVad_ProcessLanes48khz( lanes.data(), kStreams, frames.data(), frameLength, workspace,
+                                          WebRtcVad_LanesWorkspaceSize() - 1, decisions.data() ) == -1 &&
+             WebRtcVad_ProcessLanes48khz( lanes.data(), kStreams, frames.data(), frameLength + 1, workspace,
+                                          WebRtcVad_LanesWorkspaceSize(), decisions.data() ) == -1 &&
+             stateHash( reinterpret_cast<const VadInstT*>( lanes[0] ) ) == before;
+        if( !ok )
+        {
+            std::printf( "FAIL lanes of %zu ms frames\n", frameMs );
+            failures++;
+        }
+        WebRtcVad_Free( uninitialized );
+        for( size_t i = 0; i < kStreams; i++ )
+        {
+            WebRtcVad_Free( single[i] );
+            WebRtcVad_Free( lanes[i] );
+        }
+    }
+
+    // Two instances sharing one workspace, filled with garbage, take turns
+    // and match the stack path on every case
+    std::vector<int32_t> workspace( WebRtcVad_WorkspaceSize() / 4 + 1 );
+    for( const Case& c : cases )
+    {
+        std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+        size_t frames = samples.size() / ( c.sampleRate / 1000 * c.frameMs );
+        std::vector<FrameRecord> reference, first, second;
+        runCase( c, reference );
+        std::fill( workspace.begin(), workspace.end(), 0x5a5a5a5a );
+        VadInst* vad = WebRtcVad_Create();
+        VadInst* other = WebRtcVad_Create();
+        bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+                  WebRtcVad_Init( other ) == 0 && WebRtcVad_set_mode( other, c.mode ) == 0 &&
+                  WebRtcVad_SetWorkspace( vad, workspace.data(), WebRtcVad_WorkspaceSize() ) == 0 &&
+                  WebRtcVad_SetWorkspace( other, workspace.data(), WebRtcVad_WorkspaceSize() ) == 0;
+        for( size_t frame = 0; ok && frame < frames; frame++ )
+        {
+            ok = processFrames( vad, c, samples, frame, frame + 1, first ) &&
+                 processFrames( other, c, samples, frame, frame + 1, second );
+        }
+        ok = ok && sameRecords( first, reference ) && sameRecords( second, reference );
+        WebRtcVad_Free( vad );
+        WebRtcVad_Free( other );
+        if( !ok )
+        {
+            std::printf( "FAIL %s: workspace\n", c.key().c_str() );
+            failures++;
+        }
+    }
+
+    // Workspaces that are too small or misaligned are refused, and
+    // WebRtcVad_Init() detaches the workspace
+    VadInst* attached = WebRtcVad_Create();
+    WebRtcVad_Init( attached );
+    if( WebRtcVad_SetWorkspace( attached, workspace.data(), WebRtcVad_WorkspaceSize() - 1 ) == 0 ||
+        WebRtcVad_SetWorkspace( attached, reinterpret_cast<char*>( workspace.data() ) + 2,
+                                WebRtcVad_WorkspaceSize() ) == 0 )
+    {
+        std::printf( "FAIL bad workspace accepted\n" );
+        failures++;
+    }
+    WebRtcVad_SetWorkspace( attached, workspace.data(), WebRtcVad_WorkspaceSize() );
+    WebRtcVad_Init( attached );
+    if( reinterpret_cast<const VadInstT*>( attached )->workspace != nullptr )
+    {
+        std::printf( "FAIL workspace kept by WebRtcVad_Init()\n" );
+        failures++;
+    }
+    WebRtcVad_Free( attached );
+
+    // A warm start from the noise profile adapted on a noise case reports
+    // less spurious speech than the built-in model
+    uint64_t coldSpeech = 0, warmSpeech = 0;
+    for( const Case& c : cases )
+    {
+        if( c.signal != "noise" && c.signal != "quiet" )
+            continue;
+        std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+        size_t frames = samples.size() / ( c.sampleRate / 1000 * c.frameMs );
+        std::vector<FrameRecord> cold, warm;
+        WebRtcVadNoiseProfile profile;
+        VadInst* vad = WebRtcVad_Create();
+        bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+                  processFrames( vad, c, samples, 0, frames, cold ) &&
+                  WebRtcVad_GetNoiseProfile( vad, &profile ) == 0 && WebRtcVad_Init( vad ) == 0 &&
+                  WebRtcVad_set_mode( vad, c.mode ) == 0 && WebRtcVad_SetNoiseProfile( vad, &profile ) == 0 &&
+                  processFrames( vad, c, samples, 0, frames / 2, warm );
+        WebRtcVad_Free( vad );
+        if( !ok )
+        {
+            std::printf( "FAIL %s: noise profile\n", c.key().c_str() );
+            failures++;
+            continue;
+        }
+        for( size_t i = 0; i < frames / 2; i++ )
+        {
+            coldSpeech += cold[i].decision;
+            warmSpeech += warm[i].decision;
+        }
+    }
+    std::printf( "speech frames in the first half of the noise cases: %llu cold, %llu warm\n",
+                 static_cast<unsigned long long>( coldSpeech ), static_cast<unsigned long long>( warmSpeech ) );
+    if( warmSpeech >= coldSpeech )
+    {
+        std::printf( "FAIL warm start does not reduce spurious speech\n" );
+        failures++;
+    }
+
+    // Damaged snapshots and profiles are refused
+    VadInst* vad = WebRtcVad_Create();
+    WebRtcVad_Init( vad );
+    WebRtcVad_Snapshot( vad, snapshot.data(), snapshot.size() );
+    if( WebRtcVad_Restore( vad, snapshot.data(), snapshot.size() - 1 ) == 0 )
+    {
+        std::printf( "FAIL truncated snapshot accepted\n" );
+        failures++;
+    }
+    // A zero noise deviation and thresholds of no mode: magic and version,
+    // 45 32 bit words of filter states, then the means before the deviations
+    const size_t kNoiseStds = 6 + 4 * 45 + 2 * 2 * kTableSize;
+    std::vector<uint8_t> intact( snapshot ), damaged( snapshot ), after( snapshot.size() );
+    damaged[kNoiseStds] = 0;
+    damaged[kNoiseStds + 1] = 0;
+    bool refused = WebRtcVad_Restore( vad, damaged.data(), damaged.size() ) == -1;
+    damaged = intact;
+    damaged[damaged.size() - 2] ^= 0x40;
+    refused = refused && WebRtcVad_Restore( vad, damaged.data(), damaged.size() ) == -1;
+    WebRtcVad_Snapshot( vad, after.data(), after.size() );
+    if( !refused || after != intact )
+    {
+        std::printf( "FAIL snapshot with invalid models or thresholds accepted\n" );
+        failures++;
+    }
+    // Restored into an instance that was never initialized, with whatever its
+    // memory held
+    VadInst* fresh = WebRtcVad_Create();
+    std::memset( reinterpret_cast<char*>( fresh ), 0x5a, sizeof( VadInstT ) );
+    if( WebRtcVad_Restore( fresh, intact.data(), intact.size() ) != 0 || WebRtcVad_SilentFrames( fresh ) != 0 )
+    {
+        std::printf( "FAIL snapshot restored into a new instance keeps its memory\n" );
+        failures++;
+    }
+    WebRtcVad_Free( fresh );
+    snapshot[4] ^= 0xff;
+    if( WebRtcVad_Restore( vad, snapshot.data(), snapshot.size() ) == 0 )
+    {
+        std::printf( "FAIL snapshot of unknown version accepted\n" );
+        failures++;
+    }
+    WebRtcVadNoiseProfile profile;
+    WebRtcVad_GetNoiseProfile( vad, &profile );
+    profile.noise_stds[3] = 0;
+    if( WebRtcVad_SetNoiseProfile( vad, &profile ) == 0 )
+    {
+        std::printf( "FAIL noise profile with zero deviation accepted\n" );
+        failures++;
+    }
+    WebRtcVad_Free( vad );
+
+    std::printf( "%zu cases, %d failed\n", cases.size(), failures );
+    return failures == 0 ? 0 : 1;
+}
+
+// Fills |v| with one of the kernel test patterns: full scale noise with
+// -32768 in it, zeros, only -32768 and quiet noise.
+void fillPattern( std::vector<int16_t>& v, int pattern, Lcg& rng )
+{
+    for( size_t i = 0; i < v.size(); i++ )
+    {
+        if( pattern == 0 )
+            v[i] = i % 7 == 3 ? -32768 : saturate( rng.next( 32767 ) );
+        else if( pattern == 1 )
+            v[i] = 0;
+        else if( pattern == 2 )
+            v[i] = -32768;
+        else
+            v[i] = saturate( rng.next( 100 ) );
+    }
+}
+
+struct MinMaxKernels
+{
+    const char* name;
+    MaxAbsValueW16 maxAbsValueW16;
+    MaxAbsValueW32 maxAbsValueW32;
+    MaxValueW16 maxValueW16;
+    MaxValueW32 maxValueW32;
+    MinValueW16 minValueW16;
+    MinValueW32 minValueW32;
+    MaxAbsIndexW16 maxAbsIndexW16;
+    MaxIndexW16 maxIndexW16;
+    MaxIndexW32 maxIndexW32;
+    MinIndexW16 minIndexW16;
+    MinIndexW32 minIndexW32;
+};
+
+// Compares every min/max kernel against the C versions. Small ranges give
+// repeated extremes, so the index functions must return the first one.
+int minMaxDifferential( size_t& checks )
+{
+    std::vector<MinMaxKernels> kernels;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if( WebRtc_GetCPUInfo( kSSE4_1 ) )
+        kernels.push_back( { "SSE41", WebRtcSpl_MaxAbsValueW16SSE41, WebRtcSpl_MaxAbsValueW32SSE41,
+                             WebRtcSpl_MaxValueW16SSE41, WebRtcSpl_MaxValueW32SSE41, WebRtcSpl_MinValueW16SSE41,
+                             WebRtcSpl_MinValueW32SSE41, WebRtcSpl_MaxAbsIndexW16SSE41, WebRtcSpl_MaxIndexW16SSE41,
+                             WebRtcSpl_MaxIndexW32SSE41, WebRtcSpl_MinIndexW16SSE41, WebRtcSpl_MinIndexW32SSE41 } );
+#if defined(WEBRTC_ENABLE_AVX2)
+    if( WebRtc_GetCPUInfo( kAVX2 ) )
+        kernels.push_back( { "AVX2", WebRtcSpl_MaxAbsValueW16AVX2, WebRtcSpl_MaxAbsValueW32AVX2,
+                             WebRtcSpl_MaxValueW16AVX2, WebRtcSpl_MaxValueW32AVX2, WebRtcSpl_MinValueW16AVX2,
+                             WebRtcSpl_MinValueW32AVX2, WebRtcSpl_MaxAbsIndexW16AVX2, WebRtcSpl_MaxIndexW16AVX2,
+                             WebRtcSpl_MaxIndexW32AVX2, WebRtcSpl_MinIndexW16AVX2, WebRtcSpl_MinIndexW32AVX2 } );
+#endif
+#endif
+
+    int failures = 0;
+    Lcg rng( 11 );
+    for( size_t length = 1; length <= 256; length++ )
+    {
+        std::vector<int16_t> v( length );
+        std::vector<int32_t> w( length );
+        for( int pattern = 0; pattern < 4; pattern++ )
+        {
+            fillPattern( v, pattern, rng );
+            for( size_t i = 0; i < length; i++ )
+                w[i] = v[i] == -32768 ? INT32_MIN : v[i] * 65537;
+            const int64_t expected[11] = {
+                WebRtcSpl_MaxAbsValueW16C( v.data(), length ), WebRtcSpl_MaxAbsValueW32C( w.data(), length ),
+                WebRtcSpl_MaxValueW16C( v.data(), length ),    WebRtcSpl_MaxValueW32C( w.data(), length ),
+                WebRtcSpl_MinValueW16C( v.data(), length ),    WebRtcSpl_MinValueW32C( w.data(), length ),
+                (int64_t)WebRtcSpl_MaxAbsIndexW16C( v.data(), length ),
+                (int64_t)WebRtcSpl_MaxIndexW16C( v.data(), length ),
+                (int64_t)WebRtcSpl_MaxIndexW32C( w.data(), length ),
+                (int64_t)WebRtcSpl_MinIndexW16C( v.data(), length ),
+                (int64_t)WebRtcSpl_MinIndexW32C( w.data(), length ) };
+            static const char* const names[11] = { "MaxAbsValueW16", "MaxAbsValueW32", "MaxValueW16",
+                                                   "MaxValueW32",    "MinValueW16",    "MinValueW32",
+                                                   "MaxAbsIndexW16", "MaxIndexW16",    "MaxIndexW32",
+                                                   "MinIndexW16",    "MinIndexW32" };
+            for( const MinMaxKernels& kernel : kernels )
+            {
+                const int64_t value[11] = {
+                    kernel.maxAbsValueW16( v.data(), length ), kernel.maxAbsValueW32( w.data(), length ),
+                    kernel.maxValueW16( v.data(), length ),    kernel.maxValueW32( w.data(), length ),
+                    kernel.minValueW16( v.data(), length ),    kernel.minValueW32( w.data(), length ),
+                    (int64_t)kernel.maxAbsIndexW16( v.data(), length ),
+                    (int64_t)kernel.maxIndexW16( v.data(), length ),
+                    (int64_t)kernel.maxIndexW32( w.data(), length ),
+                    (int64_t)kernel.minIndexW16( v.data(), length ),
+                    (int64_t)kernel.minIndexW32( w.data(), length ) };
+                for( int k = 0; k < 11; k++ )
+                {
+                    checks++;
+                    if( value[k] != expected[k] )
+                    {
+                        std::printf( "FAIL WebRtcSpl_%s%s: length %zu pattern %d: %lld, expected %lld\n", names[k],
+                                     kernel.name, length, pattern, (long long)value[k], (long long)expected[k] );
+                        failures++;
+                    }
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+// Compares the correlation kernels against the C versions, with shifts up to
+// 15 and lag steps in both directions.
+int correlationDifferential( size_t& checks )
+{
+    struct Kernels
+    {
+        const char* suffix;
+        CrossCorrelation crossCorrelation;
+        DotProductWithScale dotProduct;
+    };
+    std::vector<Kernels> kernels;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if( WebRtc_GetCPUInfo( kSSE2 ) )
+        kernels.push_back( { "SSE2", WebRtcSpl_CrossCorrelationSSE2, WebRtcSpl_DotProductWithScaleSSE2 } );
+#if defined(WEBRTC_ENABLE_AVX2)
+    if( WebRtc_GetCPUInfo( kAVX2 ) )
+        kernels.push_back( { "AVX2", WebRtcSpl_CrossCorrelationAVX2, WebRtcSpl_DotProductWithScaleAVX2 } );
+#endif
+#endif
+
+    const int shifts[] = { 0, 1, 6, 15 };
+    const int steps[] = { 1, -1, -6 };
+    const size_t kLags = 5;
+    const size_t kMargin = 6 * kLags;
+    int failures = 0;
+    Lcg rng( 13 );
+    for( size_t length = 0; length <= 256; length++ )
+    {
+        std::vector<int16_t> v( length + 2 * kMargin );
+        for( int pattern = 0; pattern < 4; pattern++ )
+        {
+            fillPattern( v, pattern, rng );
+            const int16_t* seq1 = v.data() + kMargin;
+            const int16_t* seq2 = v.data() + kMargin + pattern;
+            for( int shift : shifts )
+            {
+                int32_t expected = WebRtcSpl_DotProductWithScaleC( seq1, seq2, length, shift );
+                for( const Kernels& kernel : kernels )
+                {
+                    int32_t value = kernel.dotProduct( seq1, seq2, length, shift );
+                    checks++;
+                    if( value != expected )
+                    {
+                        std::printf( "FAIL WebRtcSpl_DotProductWithScale%s: length %zu pattern %d shift %d: %d, "
+                                     "expected %d\n", kernel.suffix, length, pattern, shift, value, expected );
+                        failures++;
+                    }
+                }
+                for( int step : steps )
+                {
+                    int32_t expectedCorr[kLags];
+                    WebRtcSpl_CrossCorrelationC( expectedCorr, seq1, seq2, length, kLags, shift, step );
+                    for( const Kernels& kernel : kernels )
+                    {
+                        int32_t corr[kLags];
+                        kernel.crossCorrelation( corr, seq1, seq2, length, kLags, shift, step );
+                        checks++;
+                        if( memcmp( corr, expectedCorr, sizeof( corr ) ) != 0 )
+                        {
+                            std::printf( "FAIL WebRtcSpl_CrossCorrelation%s: length %zu pattern %d shift %d step %d\n",
+                                         kernel.suffix, length, pattern, shift, step );
+                            failures++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+// Runs the multi-stream 48 to 8 kHz resamplers next to kResampleLanes single
+// stream ones, over frames that switch pattern per lane so the states carry
+// every kind of history into the next frame.
+int resampleLanesDifferential( size_t& checks )
+{
+    struct Kernel
+    {
+        const char* suffix;
+        Resample48khzTo8khzLanes function;
+        WebRtcSpl_State48khzTo8khzLanes state;
+    };
+    std::vector<Kernel> kernels;
+    kernels.push_back( { "C", WebRtcSpl_Resample48khzTo8khzLanesC, {} } );
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if( WebRtc_GetCPUInfo( kSSE4_1 ) )
+        kernels.push_back( { "SSE41", WebRtcSpl_Resample48khzTo8khzLanesSSE41, {} } );
+#if defined(WEBRTC_ENABLE_AVX2)
+    if( WebRtc_GetCPUInfo( kAVX2 ) )
+        kernels.push_back( { "AVX2", WebRtcSpl_Resample48khzTo8khzLanesAVX2, {} } );
+#endif
+#endif
+    for( Kernel& kernel : kernels )
+        WebRtcSpl_ResetResample48khzTo8khzLanes( &kernel.state );
+
+    WebRtcSpl_State48khzTo8khz states[kResampleLanes];
+    for( WebRtcSpl_State48khzTo8khz& state : states )
+        WebRtcSpl_ResetResample48khzTo8khz( &state );
+
+    std::vector<std::vector<int16_t>> in( kResampleLanes, std::vector<int16_t>( 480 ) );
+    std::vector<std::vector<int16_t>> expected( kResampleLanes, std::vector<int16_t>( 80 ) );
+    std::vector<std::vector<int16_t>> out( kResampleLanes, std::vector<int16_t>( 80 ) );
+    const int16_t* inLanes[kResampleLanes];
+    int16_t* outLanes[kResampleLanes];
+    for( int lane = 0; lane < kResampleLanes; lane++ )
+    {
+        inLanes[lane] = in[lane].data();
+        outLanes[lane] = out[lane].data();
+    }
+    std::vector<int32_t> tmpmem( kResample48khzTo8khzLanesMem );
+
+    int failures = 0;
+    Lcg rng( 17 );
+    uint32_t phases[kResampleLanes] = {};
+    for( int frame = 0; frame < 24; frame++ )
+    {
+        for( int lane = 0; lane < kResampleLanes; lane++ )
+        {
+            // Clipped tones up to above the 4 kHz band edge, next to the
+            // kernel patterns.
+            int pattern = ( frame / 3 + lane ) % 5;
+            if( pattern < 4 )
+                fillPattern( in[lane], pattern, rng );
+            else
+                for( int16_t& sample : in[lane] )
+                    sample = saturate( isin( phases[lane] += phaseStep( 250 + 700 * lane, 48000 ), 40000 ) );
+            WebRtcSpl_Resample48khzTo8khz( in[lane].data(), expected[lane].data(), &states[lane], tmpmem.data() );
+        }
+        for( Kernel& kernel : kernels )
+        {
+            kernel.function( inLanes, outLanes, &kernel.state, tmpmem.data() );
+            for( int lane = 0; lane < kResampleLanes; lane++ )
+            {
+                checks++;
+                if( out[lane] != expected[lane] )
+                {
+                    std::printf( "FAIL WebRtcSpl_Resample48khzTo8khzLanes%s: frame %d lane %d\n", kernel.suffix,
+                                 frame, lane );
+                    failures++;
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+// Checks that resampling 1 to 3 blocks in one pass gives the same output and
+// state as one WebRtcSpl_Resample48khzTo8khz() call per block.
+int resampleBlocksDifferential( size_t& checks )
+{
+    const size_t kBlock = 480;
+    std::vector<int16_t> in( 20 * kBlock );
+    Lcg rng( 19 );
+    for( size_t block = 0; block < 20; block++ )
+    {
+        std::vector<int16_t> v( kBlock );
+        fillPattern( v, block % 4, rng );
+        std::copy( v.begin(), v.end(), in.begin() + block * kBlock );
+    }
+
+    int failures = 0;
+    std::vector<int32_t> tmpmem( 16 + 3 * kBlock );
+    for( size_t blocks = 1; blocks <= 3; blocks++ )
+    {
+        WebRtcSpl_State48khzTo8khz single, whole;
+        WebRtcSpl_ResetResample48khzTo8khz( &single );
+        WebRtcSpl_ResetResample48khzTo8khz( &whole );
+        std::vector<int16_t> expected( 80 * blocks ), out( 80 * blocks );
+        for( size_t start = 0; start + blocks <= 20; start += blocks )
+        {
+            for( size_t k = 0; k < blocks; k++ )
+                WebRtcSpl_Resample48khzTo8khz( &in[( start + k ) * kBlock], &expected[80 * k], &single,
+                                               tmpmem.data() );
+            WebRtcSpl_Resample48khzTo8khzBlocks( &in[start * kBlock], blocks, out.data(), &whole, tmpmem.data() );
+            checks++;
+            if( out != expected || memcmp( &single, &whole, sizeof( single ) ) != 0 )
+            {
+                std::printf( "FAIL WebRtcSpl_Resample48khzTo8khzBlocks: %zu blocks from block %zu\n", blocks, start );
+                failures++;
+            }
+        }
+    }
+    return failures;
+}
+
+// Checks that WebRtcVad_SelectCalcVad() accepts exactly the supported rates
+// and frame lengths, and that each specialization matches the generic
+// WebRtcVad_CalcVad*khz() function of its rate.
+int specializationDifferential( size_t& checks )
+{
+    int failures = 0;
+    const int rates[] = { 0, 4000, 8000, 11025, 16000, 22050, 24000, 32000, 44100, 48000, 96000 };
+    for( int rate : rates )
+    {
+        for( size_t length = 0; length <= 3000; length++ )
+        {
+            bool supported = ( rate == 8000 || rate == 16000 || rate == 32000 || rate == 48000 ) &&
+                             ( length == size_t( rate / 100 ) || length == size_t( rate / 50 ) ||
+                               length == size_t( 3 * rate / 100 ) );
+            checks++;
+            if( ( WebRtcVad_SelectCalcVad( rate, length ) != nullptr ) != supported ||
+                ( WebRtcVad_ValidRateAndFrameLength( rate, length ) == 0 ) != supported )
+            {
+                std::printf( "FAIL WebRtcVad_SelectCalcVad: %d Hz, %zu samples\n", rate, length );
+                failures++;
+            }
+        }
+    }
+
+    Lcg rng( 23 );
+    for( unsigned int sampleRate : kRates )
+    {
+        for( int frameMs = 10; frameMs <= 30; frameMs += 10 )
+        {
+            size_t frameLength = sampleRate / 1000 * frameMs;
+            VadCalcFn calc = WebRtcVad_SelectCalcVad( sampleRate, frameLength );
+            VadInstT generic, specialized;
+            WebRtcVad_InitCore( &generic );
+            WebRtcVad_InitCore( &specialized );
+            // The generic core with the whole workspace, the specialized one
+            // with the least memory, resampling 48 kHz one block at a time
+            std::vector<int32_t> memory( ( WebRtcVad_WorkspaceSize() + 3 ) / 4 );
+            std::vector<int32_t> least( ( WebRtcVad_WorkspaceBytes( sampleRate, kVadEngineFixed, 0, 1 ) + 3 ) / 4 );
+            VadWorkspaceT work, leastWork;
+            WebRtcVad_InitWorkspace( memory.data(), memory.size() * 4, sampleRate, &work );
+            WebRtcVad_InitWorkspace( least.data(), least.size() * 4, sampleRate, &leastWork );
+            std::vector<int16_t> frame( frameLength );
+            for( int k = 0; k < 40; k++ )
+            {
+                fillPattern( frame, k / 10, rng );
+                int expected = 0;
+                if( sampleRate == 48000 )
+                    expected = WebRtcVad_CalcVad48khz( &generic, frame.data(), frameLength, &work );
+                else if( sampleRate == 32000 )
+                    expected = WebRtcVad_CalcVad32khz( &generic, frame.data(), frameLength, &work );
+                else if( sampleRate == 16000 )
+                    expected = WebRtcVad_CalcVad16khz( &generic, frame.data(), frameLength, &work );
+                else
+                    expected = WebRtcVad_CalcVad8khz( &generic, frame.data(), frameLength, &work );
+                int value = calc( &specialized, frame.data(), &leastWork );
+                checks++;
+                if( value != expected || stateHash( &generic ) != stateHash( &specialized ) ||
+                    memcmp( generic.feature_vector, specialized.feature_vector, sizeof( generic.feature_vector ) ) )
+                {
+                    std::printf( "FAIL VadCalcVad<%u, %d>: frame %d\n", sampleRate, frameMs, k );
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+int kernelDifferential()
+{
+    struct EnergyKernel
+    {
+        const char* name;
+        Energy function;
+    };
+    std::vector<EnergyKernel> energy;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if( WebRtc_GetCPUInfo( kSSE2 ) )
+        energy.push_back( { "WebRtcSpl_EnergySSE2", WebRtcSpl_EnergySSE2 } );
+#if defined(WEBRTC_ENABLE_AVX2)
+    if( WebRtc_GetCPUInfo( kAVX2 ) )
+        energy.push_back( { "WebRtcSpl_EnergyAVX2", WebRtcSpl_EnergyAVX2 } );
+#endif
+#endif
+
+    int failures = 0;
+    size_t checks = 0;
+    Lcg rng( 7 );
+    for( size_t length = 0; length <= 256; length++ )
+    {
+        std::vector<int16_t> v( length );
+        for( int pattern = 0; pattern < 4; pattern++ )
+        {
+            fillPattern( v, pattern, rng );
+            int expectedScale = 0;
+            int32_t expected = WebRtcSpl_EnergyC( v.data(), length, &expectedScale );
+            for( const EnergyKernel& kernel : energy )
+            {
+                int scale = -1;
+                int32_t value = kernel.function( v.data(), length, &scale );
+                checks++;
+                if( value != expected || scale != expectedScale )
+                {
+                    std::printf( "FAIL %s: length %zu pattern %d: %d >> %d, expected %d >> %d\n", kernel.name, length,
+                                 pattern, value, scale, expected, expectedScale );
+                    failures++;
+                }
+            }
+        }
+    }
+    failures += minMaxDifferential( checks );
+    failures += correlationDifferential( checks );
+    failures += resampleLanesDifferential( checks );
+    failures += resampleBlocksDifferential( checks );
+    failures += specializationDifferential( checks );
+    std::printf( "%zu kernel checks, %d differ from the generic C versions\n", checks, failures );
+    return failures;
+}
+
+int differential()
+{
+    int failures = 0;
+    std::vector<Case> cases = corpus();
+    for( const Case& c : cases )
+    {
+        std::vector<FrameRecord> generic, native;
+        WebRtcSpl_SetDispatch( kSplDispatchGeneric );
+        bool ok = runCase( c, generic );
+        WebRtcSpl_SetDispatch( kSplDispatchNative );
+        ok = runCase( c, native ) && ok;
+        if( !ok || generic.size() != native.size() )
+        {
+            std::printf( "FAIL %s: VAD error\n", c.key().c_str() );
+            failures++;
+            continue;
+        }
+        for( size_t frame = 0; frame < generic.size(); frame++ )
+        {
+            const FrameRecord& a = generic[frame];
+            const FrameRecord& b = native[frame];
+            bool same = a.decision == b.decision && a.raw == b.raw && a.totalPower == b.totalPower &&
+                        memcmp( a.features, b.features, sizeof( a.features ) ) == 0 && a.state == b.state;
+            if( same )
+                continue;
+            failures++;
+            std::printf( "FAIL %s: frame %zu differs: decision %d/%d, power %d/%d, features", c.key().c_str(),
+                         frame, a.raw, b.raw, a.totalPower, b.totalPower );
+            for( int k = 0; k < kNumChannels; k++ )
+            {
+                std::printf( " %d/%d", a.features[k], b.features[k] );
+            }
+            std::printf( "%s\n", a.state == b.state ? "" : ", model state differs" );
+            break;
+        }
+    }
+    std::printf( "%zu cases, %d differ between generic and native dispatch\n", cases.size(), failures );
+    failures += kernelDifferential();
+    return failures == 0 ? 0 : 1;
+}
+
+// Runs |c| with the float engine, the silence gate at |threshold|, into
+// |decisions|. Returns false on a VAD error or features that are not finite.
+bool runFloatCase( const Case& c, const std::vector<int16_t>& samples, int threshold, std::vector<int>& decisions,
+                   int64_t& silentFrames )
+{
+    size_t frameLength = c.sampleRate / 1000 * c.frameMs;
+    size_t frames = samples.size() / frameLength;
+    VadInst* vad = WebRtcVad_Create();
+    const VadInstT* inst = reinterpret_cast<const VadInstT*>( vad );
+    bool ok = WebRtcVad_Init( vad ) == 0 && WebRtcVad_set_mode( vad, c.mode ) == 0 &&
+              WebRtcVad_SetEngine( vad, kVadEngineFloat ) == 0 &&
+              WebRtcVad_SetSilenceThreshold( vad, threshold ) == 0;
+    decisions.clear();
+    for( size_t frame = 0; ok && frame < frames; frame++ )
+    {
+        int decision = WebRtcVad_Process( vad, c.sampleRate, &samples[frame * frameLength], frameLength );
+        ok = decision >= 0;
+        for( int k = 0; k < kNumChannels; k++ )
+            ok = ok && std::isfinite( inst->float_state.feature_vector[k] );
+        decisions.push_back( decision );
+    }
+    silentFrames = WebRtcVad_SilentFrames( vad );
+    WebRtcVad_Free( vad );
+    return ok;
+}
+
+// Decision agreement of the float engine with the fixed point engine over the
+// corpus, which is not bit exact, so only a lower bound is checked. The
+// silence gate is checked to keep the float decisions unchanged.
+int engineAgreement()
+{
+    // Lowest agreement over the whole corpus accepted, a little below the
+    // measured 94.5%. Most of the difference is the pure tone in modes 2 and
+    // 3, where the rounding noise of the fixed point filters in the empty
+    // bands tips the decision to speech.
+    const double kMinAgreement = 0.93;
+    int failures = 0;
+    size_t total = 0;
+    size_t agree = 0;
+    std::vector<Case> cases = corpus();
+    for( const char* signal : kSignals )
+    {
+        size_t signalTotal = 0;
+        size_t signalAgree = 0;
+        size_t fixedSpeech = 0;
+        size_t floatSpeech = 0;
+        for( const Case& c : cases )
+        {
+            if( c.signal != signal )
+                continue;
+            std::vector<int16_t> samples = makeSignal( c.signal, c.sampleRate );
+            std::vector<FrameRecord> fixed;
+            std::vector<int> floats, gated;
+            int64_t silentFrames = 0;
+            int64_t gatedSilentFrames = 0;
+            bool ok = runCase( c, fixed ) && runFloatCase( c, samples, -1, floats, silentFrames ) &&
+                      runFloatCase( c, samples, 0, gated, gatedSilentFrames ) && fixed.size() == floats.size();
+            if( !ok )
+            {
+                std::printf( "FAIL %s: float engine error\n", c.key().c_str() );
+                failures++;
+                continue;
+            }
+            if( gated != floats || ( c.signal == "silence" && gatedSilentFrames == 0 ) )
+            {
+                std::printf( "FAIL %s: silence gate changes the float engine\n", c.key().c_str() );
+                failures++;
+            }
+            for( size_t frame = 0; frame < fixed.size(); frame++ )
+            {
+                signalAgree += fixed[frame].decision == floats[frame];
+                fixedSpeech += fixed[frame].decision;
+                floatSpeech += floats[frame];
+            }
+            signalTotal += fixed.size();
+        }
+        std::printf( "%-8s %6zu frames, %5.1f%% agree, speech %5zu fixed, %5zu float\n", signal, signalTotal,
+                     100.0 * signalAgree / signalTotal, fixedSpeech, floatSpeech );
+        total += signalTotal;
+        agree += signalAgree;
+    }
+    double agreement = static_cast<double>( agree ) / total;
+    std::printf( "%zu frames, %.2f%% of the float decisions agree with fixed point\n", total, 100.0 * agreement );
+    if( agreement < kMinAgreement )
+    {
+        std::printf( "FAIL agreement below %.0f%%\n", 100.0 * kMinAgreement );
+        failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Runs before anything else in the process, see main().
+int withoutInstance()
+{
+    int failures = 0;
+
+    // 200 Hz voiced sound at 16 kHz, a pitch lag of 80 samples.
+    const unsigned int kRate = 16000;
+    std::vector<int16_t> samples( 800 );
+    uint32_t phase = 0;
+    for( int16_t& sample : samples )
+    {
+        sample = saturate( voiced( phase, 8000 ) );
+        phase += phaseStep( 200, kRate );
+    }
+
+    // Callers of the SPL without a VAD instance that never run WebRtcSpl_Init(),
+    // e.g. a level meter.
+    int scale[2] = { 0, 0 };
+    int32_t energy[2] = { WebRtcSpl_Energy( samples.data(), samples.size(), &scale[0] ),
+                          WebRtcSpl_EnergyC( samples.data(), samples.size(), &scale[1] ) };
+    if( energy[0] != energy[1] || scale[0] != scale[1] )
+    {
+        std::printf( "FAIL WebRtcSpl_Energy before WebRtcSpl_Init differs from the C version\n" );
+        failures++;
+    }
+
+    std::vector<int32_t> wide( samples.begin(), samples.end() );
+    const size_t indices[][2] = {
+        { WebRtcSpl_MaxAbsIndexW16( samples.data(), samples.size() ),
+          WebRtcSpl_MaxAbsIndexW16C( samples.data(), samples.size() ) },
+        { WebRtcSpl_MaxIndexW16( samples.data(), samples.size() ),
+          WebRtcSpl_MaxIndexW16C( samples.data(), samples.size() ) },
+        { WebRtcSpl_MaxIndexW32( wide.data(), wide.size() ), WebRtcSpl_MaxIndexW32C( wide.data(), wide.size() ) },
+        { WebRtcSpl_MinIndexW16( samples.data(), samples.size() ),
+          WebRtcSpl_MinIndexW16C( samples.data(), samples.size() ) },
+        { WebRtcSpl_MinIndexW32( wide.data(), wide.size() ), WebRtcSpl_MinIndexW32C( wide.data(), wide.size() ) } };
+    for( const auto& index : indices )
+    {
+        if( index[0] != index[1] )
+        {
+            std::printf( "FAIL index function returned %zu, the C version %zu\n", index[0], index[1] );
+            failures++;
+        }
+    }
+
+    const size_t kFrame = 480;
+    size_t lag = 0;
+    int16_t periodicity = WebRtcVad_Periodicity( samples.data() + samples.size() - kFrame, kFrame,
+                                                 samples.size() - kFrame, kRate, &lag );
+    std::printf( "WebRtcVad_Periodicity: %.3f at lag %zu\n", periodicity / 16384.0, lag );
+    if( periodicity < 14746 || lag != 80 )
+    {
+        std::printf( "FAIL expected a periodicity above 0.9 at lag 80\n" );
+        failures++;
+    }
+
+    std::printf( "%d failed\n", failures );
+    return failures == 0 ? 0 : 1;
+}
+
+// Utterance of the split corpus, in ms.
+struct Utterance
+{
+    unsigned int begin;
+    unsigned int end;
+};
+
+// Sparse speech: one utterance every few seconds, of 340 ms syllables with
+// 60 ms pauses, ending on a syllable.
+const Utterance kUtterances[] = { { 1500, 2640 }, { 6000, 6740 }, { 11000, 13740 }, { 17500, 18640 } };
+const unsigned int kUtteranceSeconds = 20;
+
+// Syllables of voiced sound with a gliding pitch on hum and noise, during the
+// utterances of |utterances|.
+std::vector<int16_t> makeUtterances( unsigned int sampleRate, unsigned int seconds,
+                                     const std::vector<Utterance>& utterances )
+{
+    std::vector<int16_t> samples( sampleRate * seconds );
+    Lcg rng( 1234 );
+    uint32_t phase = 0;
+    uint32_t pitchPhase = 0;
+    for( size_t i = 0; i < samples.size(); i++ )
+    {
+        size_t ms = i * 1000 / sampleRate;
+        pitchPhase += phaseStep( 120 + static_cast<int>( ( ms / 9 ) % 70 ), sampleRate );
+        phase += phaseStep( 50, sampleRate );
+        int value = rng.next( 300 ) + isin( phase, 200 );
+        for( const Utterance& utterance : utterances )
+        {
+            if( ms >= utterance.begin && ms < utterance.end && ( ms - utterance.begin ) % 400 < 340 )
+                value += voiced( pitchPhase, 6000 );
+        }
+        samples[i] = saturate( value );
+    }
+    return samples;
+}
+
+// Runs vadSplit() on |samples| with |options|, without its output.
+std::vector<VadSegment> split( const std::vector<int16_t>& samples, unsigned int sampleRate,
+                               const VadSplitOptions& options )
+{
+    std::vector<VadSegment> segments;
+    std::ostringstream sink;
+    std::streambuf* coutBuf = std::cout.rdbuf( sink.rdbuf() );
+    vadSplit( reinterpret_cast<const char*>( samples.data() ), samples.size() * sizeof( int16_t ), sampleRate,
+              segments, options );
+    std::cout.rdbuf( coutBuf );
+    return segments;
+}
+
+// Start and end of |segment| in ms.
+double startMs( const VadSegment& segment, unsigned int sampleRate )
+{
+    return 1000.0 * segment.offset / ( 2.0 * sampleRate );
+}
+
+double endMs( const VadSegment& segment, unsigned int sampleRate )
+{
+    return 1000.0 * ( segment.offset + segment.length ) / ( 2.0 * sampleRate );
+}
+
+// The coarse scan finds the segments of the dense scan, with no boundary
+// moved by more than the maximum boundary error, and skips frames doing so.
+int coarseScanChecks( unsigned int sampleRate, const std::vector<int16_t>& samples )
+{
+    const unsigned int kMaxBoundaryErrorMs = 240;
+    int failures = 0;
+    VadSplitOptions options;
+    std::vector<VadSegment> dense = split( samples, sampleRate, options );
+    VadSplitStats stats;
+    options.stats = &stats;
+    options.maxBoundaryErrorMs = kMaxBoundaryErrorMs;
+    uint64_t classified = vadMetrics().frames();
+    std::vector<VadSegment> coarse = split( samples, sampleRate, options );
+    classified = vadMetrics().frames() - classified;
+
+    double maxError = 0.0;
+    for( size_t i = 0; i < coarse.size() && i < dense.size(); i++ )
+    {
+        maxError = std::max( maxError, std::abs( startMs( coarse[i], sampleRate ) - startMs( dense[i], sampleRate ) ) );
+        maxError = std::max( maxError, std::abs( endMs( coarse[i], sampleRate ) - endMs( dense[i], sampleRate ) ) );
+    }
+    std::printf( "%6u coarse scan: %zu segments, dense %zu, %.1f%% skipped, max error %.0f ms\n", sampleRate,
+                 coarse.size(), dense.size(), 100.0 * stats.skippedFrames / stats.frames, maxError );
+    if( dense.size() != sizeof( kUtterances ) / sizeof( kUtterances[0] ) || coarse.size() != dense.size() )
+    {
+        std::printf( "FAIL expected one segment per utterance\n" );
+        failures++;
+    }
+    if( maxError > kMaxBoundaryErrorMs )
+    {
+        std::printf( "FAIL boundary moved by more than %u ms\n", kMaxBoundaryErrorMs );
+        failures++;
+    }
+    if( classified != stats.frames - stats.skippedFrames )
+    {
+        std::printf( "FAIL %llu frames counted, %llu not skipped\n", (unsigned long long)classified,
+                     (unsigned long long)( stats.frames - stats.skippedFrames ) );
+        failures++;
+    }
+    if( stats.skippedFrames * 5 < stats.frames * 2 )
+    {
+        std::printf( "FAIL expected more than 40%% of the frames skipped\n" );
+        failures++;
+    }
+    return failures;
+}
+
+// Every refined segment covers one utterance, and starts and ends within
+// a few ms of its onset and offset, which the frame boundaries miss by the
+// padding of the trigger.
+int refineChecks( unsigned int sampleRate, const std::vector<int16_t>& samples )
+{
+    const unsigned int kRefineWindowMs = 500;
+    const double kMaxErrorMs = 20.0;
+    int failures = 0;
+    const size_t count = sizeof( kUtterances ) / sizeof( kUtterances[0] );
+    VadSplitOptions options;
+    double error[2] = { 0.0, 0.0 };
+    for( int k = 0; k < 2; k++ )
+    {
+        options.refineWindowMs = k == 0 ? 0 : kRefineWindowMs;
+        std::vector<VadSegment> segments = split( samples, sampleRate, options );
+        if( segments.size() != count )
+        {
+            std::printf( "FAIL %zu segments for %zu utterances\n", segments.size(), count );
+            failures++;
+            continue;
+        }
+        for( size_t i = 0; i < count; i++ )
+        {
+            error[k] = std::max( error[k], std::abs( startMs( segments[i], sampleRate ) - kUtterances[i].begin ) );
+            error[k] = std::max( error[k], std::abs( endMs( segments[i], sampleRate ) - kUtterances[i].end ) );
+        }
+    }
+    std::printf( "%6u refinement: max error %.1f ms, frame boundaries %.1f ms\n", sampleRate, error[1], error[0] );
+    if( error[1] > kMaxErrorMs )
+    {
+        std::printf( "FAIL refined boundary off by more than %.0f ms\n", kMaxErrorMs );
+        failures++;
+    }
+    return failures;
+}
+
+// A long utterance is split in its pauses into segments of at most
+// maxSegmentMs, and a short one is merged or widened to minSegmentMs.
+int lengthChecks( unsigned int sampleRate )
+{
+    const unsigned int kMinSegmentMs = 1000;
+    const unsigned int kMaxSegmentMs = 3000;
+    const Utterance kLong = { 1000, 10340 };
+    const Utterance kShort = { 12500, 12840 };
+    int failures = 0;
+    std::vector<int16_t> samples = makeUtterances( sampleRate, 16, { kLong, kShort, { 14000, 15140 } } );
+    VadSplitOptions options;
+    options.minSegmentMs = kMinSegmentMs;
+    options.maxSegmentMs = kMaxSegmentMs;
+    std::vector<VadSegment> segments = split( samples, sampleRate, options );
+
+    size_t longParts = 0;
+    bool shortCovered = false;
+    double previousEnd = 0.0;
+    for( const VadSegment& segment : segments )
+    {
+        double start = startMs( segment, sampleRate );
+        double end = endMs( segment, sampleRate );
+        if( end - start > kMaxSegmentMs + 0.5 || end - start < kMinSegmentMs - 0.5 )
+        {
+            std::printf( "FAIL segment %.0f - %.0f ms out of bounds\n", start, end );
+            failures++;
+        }
+        if( start < previousEnd )
+        {
+            std::printf( "FAIL segment %.0f - %.0f ms overlaps the one before\n", start, end );
+            failures++;
+        }
+        // A cut inside the long utterance lies in a pause, up to a frame off.
+        unsigned int phase = static_cast<unsigned int>( start - kLong.begin ) % 400;
+        if( start == previousEnd && start > kLong.begin && start < kLong.end && phase < 310 )
+        {
+            std::printf( "FAIL long utterance cut at %.0f ms, not in a pause\n", start );
+            failures++;
+        }
+        if( start < kLong.end && end > kLong.begin )
+            longParts++;
+        shortCovered = shortCovered || ( start <= kShort.begin && end >= kShort.end );
+        previousEnd = end;
+    }
+    std::printf( "%6u length bounds: %zu segments, %zu for the long utterance\n", sampleRate, segments.size(),
+                 longParts );
+    if( longParts < ( kLong.end - kLong.begin ) / kMaxSegmentMs + 1 )
+    {
+        std::printf( "FAIL long utterance not split\n" );
+        failures++;
+    }
+    if( !shortCovered )
+    {
+        std::printf( "FAIL short utterance not covered\n" );
+        failures++;
+    }
+    return failures;
+}
+
+// The endpointer with the default config reports the start and the end of
+// every utterance, the end within 100 ms of the offset.
+int endpointChecks( unsigned int sampleRate, const std::vector<int16_t>& samples )
+{
+    const double kMaxEndLatencyMs = 100.0;
+    const size_t count = sizeof( kUtterances ) / sizeof( kUtterances[0] );
+    int failures = 0;
+    VadEndpointerConfig zeroFrame;
+    zeroFrame.frameMs = 0;
+    if( VadEndpointer( sampleRate, zeroFrame, nullptr ).valid() )
+    {
+        std::printf( "FAIL endpointer accepted a frame of 0 ms\n" );
+        failures++;
+    }
+
+    std::vector<VadEndpointEvent> events;
+    VadEndpointer endpointer( sampleRate, VadEndpointerConfig(),
+                              [&events]( const VadEndpointEvent& event ) { events.push_back( event ); } );
+    size_t chunk = sampleRate / 100;
+    for( size_t offset = 0; offset < samples.size(); offset += chunk )
+        endpointer.process( samples.data() + offset, std::min( chunk, samples.size() - offset ) );
+    endpointer.flush();
+
+    double maxStart = 0.0, maxEnd = 0.0;
+    bool paired = events.size() == 2 * count;
+    for( size_t i = 0; paired && i < events.size(); i++ )
+    {
+        const VadEndpointEvent& event = events[i];
+        const Utterance& utterance = kUtterances[i / 2];
+        paired = event.type == ( i % 2 == 0 ? VadEndpointEvent::kStart : VadEndpointEvent::kEnd );
+        if( event.type == VadEndpointEvent::kStart )
+        {
+            maxStart = std::max( maxStart, std::abs( 1000.0 * event.sample / sampleRate - utterance.begin ) );
+        }
+        else
+        {
+            double latency = 1000.0 * event.decisionSample / sampleRate - utterance.end;
+            maxEnd = std::max( maxEnd, latency );
+            paired = paired && latency >= 0.0;
+        }
+    }
+    std::printf( "%6u endpointer: %zu events, start error %.0f ms, end latency %.0f ms\n", sampleRate, events.size(),
+                 maxStart, maxEnd );
+    if( !paired )
+    {
+        std::printf( "FAIL expected a start and an end for every utterance\n" );
+        failures++;
+    }
+    if( maxStart > VadEndpointerConfig().startMs )
+    {
+        std::printf( "FAIL start off by more than startMs\n" );
+        failures++;
+    }
+    if( maxEnd > kMaxEndLatencyMs )
+    {
+        std::printf( "FAIL end reported more than %.0f ms after the offset\n", kMaxEndLatencyMs );
+        failures++;
+    }
+    return failures;
+}
+
+// Instances for an unsupported sample rate ignore their input.
+int invalidStreamChecks()
+{
+    const unsigned int kRate = 500;
+    int failures = 0;
+    std::vector<int16_t> samples( 160 );
+    Buffers::SpscRingBuffer<int16_t> buffer( 256 );
+    buffer.write( samples.data(), samples.size() );
+
+    VadStreamSegmenter segmenter( kRate, 2, nullptr );
+    VadEndpointer endpointer( kRate, VadEndpointerConfig(), nullptr );
+    segmenter.process( samples.data(), samples.size() );
+    endpointer.process( samples.data(), samples.size() );
+    if( segmenter.valid() || endpointer.valid() || segmenter.consume( buffer ) != 0 || endpointer.consume( buffer ) != 0 )
+    {
+        std::printf( "FAIL %u Hz accepted\n", kRate );
+        failures++;
+    }
+    return failures;
+}
+
+// Segment boundaries of vadSplit() on utterances with known onsets and
+// offsets.
+int splitChecks()
+{
+    int failures = invalidStreamChecks();
+    std::vector<Utterance> utterances( std::begin( kUtterances ), std::end( kUtterances ) );
+    for( unsigned int sampleRate : kRates )
+    {
+        std::vector<int16_t> samples = makeUtterances( sampleRate, kUtteranceSeconds, utterances );
+        failures += coarseScanChecks( sampleRate, samples );
+        failures += refineChecks( sampleRate, samples );
+        failures += lengthChecks( sampleRate );
+        failures += endpointChecks( sampleRate, samples );
+    }
+    std::printf( "%d failed\n", failures );
+    return failures == 0 ? 0 : 1;
+}
+
+} // namespace
+
+int main( int argc, char* argv[] )
+{
+    if( argc == 2 && strcmp( argv[1], "--diff" ) == 0 )
+        return differential();
+    if( argc == 2 && strcmp( argv[1], "--state" ) == 0 )
+        return stateRoundTrip();
+    if( argc == 2 && strcmp( argv[1], "--float" ) == 0 )
+        return engineAgreement();
+    if( argc == 2 && strcmp( argv[1], "--init" ) == 0 )
+        return withoutInstance();
+    if( argc == 2 && strcmp( argv[1], "--split" ) == 0 )
+        return splitChecks();
+    if( argc == 3 && strcmp( argv[1], "--update" ) == 0 )
+        return update( argv[2] );
+    if( argc == 2 )
+        return verify( argv[1] );
+
+    std::printf( "Usage:\n" );
+    std::printf( "    %s golden_file\n", argv[0] );
+    std::printf( "    %s --update golden_file\n", argv[0] );
+    std::printf( "    %s --diff\n", argv[0] );
+    std::printf( "    %s --state\n", argv[0] );
+    std::printf( "    %s --float\n", argv[0] );
+    std::printf( "    %s --init\n", argv[0] );
+    std::printf( "    %s --split\n", argv[0] );
+    return 1;
+}
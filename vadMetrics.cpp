@@ -0,0 +1,277 @@
+/**
+ * Copyright (c) 2022 360Converter - Leo Huang 
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vadMetrics.h"
+
+#include <cstdio> // snprintf
+#include <sstream> // std::ostringstream
+
+namespace
+{
+
+// Upper bounds of the segment duration buckets in seconds
+const std::vector<double> kSegmentBounds = { 0.5, 1.0, 2.0, 5.0, 10.0, 20.0, 30.0, 60.0 };
+
+// Upper bounds of the frame latency buckets in seconds
+const std::vector<double> kLatencyBounds = { 2.5e-6, 5e-6, 1e-5, 2.5e-5, 5e-5, 1e-4, 2.5e-4, 1e-3 };
+
+// Prometheus floats, "+Inf" for the last bucket
+std::string formatValue( double value )
+{
+    char text[32];
+    snprintf( text, sizeof( text ), "%.9g", value );
+    return text;
+}
+
+void renderHistogram( std::ostringstream& out, const char* name, const std::string& labels, const VadHistogram& histogram )
+{
+    std::string prefix = labels.empty() ? "{" : "{" + labels + ",";
+    uint64_t cumulative = 0;
+    for( size_t i = 0; i < histogram.bounds().size(); i++ )
+    {
+        cumulative += histogram.bucket( i );
+        out << name << "_bucket" << prefix << "le=\"" << formatValue( histogram.bounds()[i] ) << "\"} " << cumulative
+            << "\n";
+    }
+    cumulative += histogram.bucket( histogram.bounds().size() );
+    out << name << "_bucket" << prefix << "le=\"+Inf\"} " << cumulative << "\n";
+    std::string suffix = labels.empty() ? "" : "{" + labels + "}";
+    out << name << "_sum" << suffix << " " << formatValue( histogram.sum() ) << "\n";
+    out << name << "_count" << suffix << " " << cumulative << "\n";
+}
+
+} // namespace
+
+VadHistogram::VadHistogram( const std::vector<double>& bounds )
+: m_bounds( bounds )
+, m_buckets( new std::atomic<uint64_t>[bounds.size() + 1] )
+, m_count( 0 )
+, m_sum( 0.0 )
+{
+    for( size_t i = 0; i <= m_bounds.size(); i++ )
+    {
+        m_buckets[i].store( 0, std::memory_order_relaxed );
+    }
+}
+
+void VadHistogram::observe( double value )
+{
+    size_t i = 0;
+    while( i < m_bounds.size() && value > m_bounds[i] )
+        i++;
+    m_buckets[i].fetch_add( 1, std::memory_order_relaxed );
+    m_count.fetch_add( 1, std::memory_order_relaxed );
+    double sum = m_sum.load( std::memory_order_relaxed );
+    while( !m_sum.compare_exchange_weak( sum, sum + value, std::memory_order_relaxed ) )
+    {
+    }
+}
+
+void VadHistogram::add( const std::vector<uint64_t>& buckets, uint64_t count, double sum )
+{
+    if( count == 0 )
+        return;
+    for( size_t i = 0; i <= m_bounds.size() && i < buckets.size(); i++ )
+    {
+        if( buckets[i] )
+            m_buckets[i].fetch_add( buckets[i], std::memory_order_relaxed );
+    }
+    m_count.fetch_add( count, std::memory_order_relaxed );
+    double total = m_sum.load( std::memory_order_relaxed );
+    while( !m_sum.compare_exchange_weak( total, total + sum, std::memory_order_relaxed ) )
+    {
+    }
+}
+
+void VadHistogram::reset()
+{
+    for( size_t i = 0; i <= m_bounds.size(); i++ )
+    {
+        m_buckets[i].store( 0, std::memory_order_relaxed );
+    }
+    m_count.store( 0, std::memory_order_relaxed );
+    m_sum.store( 0.0, std::memory_order_relaxed );
+}
+
+VadFrameTally::VadFrameTally()
+: frames( 0 )
+, speechFrames( 0 )
+, timedFrames( 0 )
+, seconds( 0.0 )
+, latency( kLatencyBounds.size() + 1, 0 )
+{
+}
+
+void VadFrameTally::add( bool speech, double seconds )
+{
+    frames++;
+    if( speech )
+        speechFrames++;
+    if( seconds < 0.0 )
+        return;
+    size_t i = 0;
+    while( i < kLatencyBounds.size() && seconds > kLatencyBounds[i] )
+        i++;
+    latency[i]++;
+    timedFrames++;
+    this->seconds += seconds;
+}
+
+const unsigned int VadMetrics::kRates[4] = { 8000, 16000, 32000, 48000 };
+
+VadMetrics::VadMetrics()
+: m_frames( 0 )
+, m_speechFrames( 0 )
+, m_segments( 0 )
+, m_writerQueueDepth( 0 )
+, m_frameTiming( false )
+, m_segmentDuration( kSegmentBounds )
+{
+    for( size_t i = 0; i < sizeof( kRates ) / sizeof( kRates[0] ); i++ )
+    {
+        m_frameLatency.emplace_back( new VadHistogram( kLatencyBounds ) );
+    }
+}
+
+void VadMetrics::frameProcessed( unsigned int sampleRate, bool speech, double seconds )
+{
+    m_frames.fetch_add( 1, std::memory_order_relaxed );
+    if( speech )
+        m_speechFrames.fetch_add( 1, std::memory_order_relaxed );
+    for( size_t i = 0; i < m_frameLatency.size() && seconds >= 0.0; i++ )
+    {
+        if( kRates[i] == sampleRate )
+            m_frameLatency[i]->observe( seconds );
+    }
+}
+
+void VadMetrics::framesProcessed( unsigned int sampleRate, const VadFrameTally& tally )
+{
+    m_frames.fetch_add( tally.frames, std::memory_order_relaxed );
+    m_speechFrames.fetch_add( tally.speechFrames, std::memory_order_relaxed );
+    for( size_t i = 0; i < m_frameLatency.size(); i++ )
+    {
+        if( kRates[i] == sampleRate )
+            m_frameLatency[i]->add( tally.latency, tally.timedFrames, tally.seconds );
+    }
+}
+
+void VadMetrics::segmentEmitted( double seconds )
+{
+    m_segments.fetch_add( 1, std::memory_order_relaxed );
+    m_segmentDuration.observe( seconds );
+}
+
+void VadMetrics::writerQueued( uint64_t count )
+{
+    m_writerQueueDepth.fetch_add( count, std::memory_order_relaxed );
+}
+
+void VadMetrics::writerDequeued()
+{
+    m_writerQueueDepth.fetch_sub( 1, std::memory_order_relaxed );
+}
+
+double VadMetrics::speechRatio() const
+{
+    uint64_t total = frames();
+    return total ? double( speechFrames() ) / total : 0.0;
+}
+
+const VadHistogram* VadMetrics::frameLatency( unsigned int sampleRate ) const
+{
+    for( size_t i = 0; i < m_frameLatency.size(); i++ )
+    {
+        if( kRates[i] == sampleRate )
+            return m_frameLatency[i].get();
+    }
+    return nullptr;
+}
+
+std::string VadMetrics::renderPrometheus() const
+{
+    std::ostringstream out;
+    out << "# HELP vad_frames_total Frames classified by the VAD.\n";
+    out << "# TYPE vad_frames_total counter\n";
+    out << "vad_frames_total " << frames() << "\n";
+    out << "# HELP vad_speech_frames_total Frames classified as speech.\n";
+    out << "# TYPE vad_speech_frames_total counter\n";
+    out << "vad_speech_frames_total " << speechFrames() << "\n";
+    out << "# HELP vad_speech_ratio Share of the frames classified as speech.\n";
+    out << "# TYPE vad_speech_ratio gauge\n";
+    out << "vad_speech_ratio " << formatValue( speechRatio() ) << "\n";
+    out << "# HELP vad_segments_total Speech segments emitted.\n";
+    out << "# TYPE vad_segments_total counter\n";
+    out << "vad_segments_total " << segments() << "\n";
+    out << "# HELP vad_segment_duration_seconds Duration of the emitted segments.\n";
+    out << "# TYPE vad_segment_duration_seconds histogram\n";
+    renderHistogram( out, "vad_segment_duration_seconds", "", m_segmentDuration );
+    out << "# HELP vad_frame_processing_seconds Processing time of one frame by the VAD.\n";
+    out << "# TYPE vad_frame_processing_seconds histogram\n";
+    for( size_t i = 0; i < m_frameLatency.size(); i++ )
+    {
+        renderHistogram( out, "vad_frame_processing_seconds", "rate=\"" + std::to_string( kRates[i] ) + "\"",
+                         *m_frameLatency[i] );
+    }
+    out << "# HELP vad_writer_queue_depth Segments waiting to be written.\n";
+    out << "# TYPE vad_writer_queue_depth gauge\n";
+    out << "vad_writer_queue_depth " << writerQueueDepth() << "\n";
+    return out.str();
+}
+
+bool VadMetrics::writePrometheus( const char* fileName ) const
+{
+    // Write a temporary file and rename it, so a reader never sees a
+    // partially written file.
+    std::string text = renderPrometheus();
+    std::string tmpName = std::string( fileName ) + ".tmp";
+    FILE* pf = fopen( tmpName.c_str(), "wb" );
+    if( nullptr == pf )
+        return false;
+    bool ok = fwrite( text.data(), sizeof( char ), text.size(), pf ) == text.size();
+    ok = fclose( pf ) == 0 && ok;
+    if( !ok || rename( tmpName.c_str(), fileName ) != 0 )
+    {
+        remove( tmpName.c_str() );
+        return false;
+    }
+    return true;
+}
+
+void VadMetrics::exportPrometheus( const std::function<void( const std::string& )>& callback ) const
+{
+    callback( renderPrometheus() );
+}
+
+void VadMetrics::reset()
+{
+    m_frames.store( 0, std::memory_order_relaxed );
+    m_speechFrames.store( 0, std::memory_order_relaxed );
+    m_segments.store( 0, std::memory_order_relaxed );
+    m_segmentDuration.reset();
+    for( auto& histogram : m_frameLatency )
+    {
+        histogram->reset();
+    }
+}
+
+VadMetrics& vadMetrics()
+{
+    static VadMetrics metrics;
+    return metrics;
+}
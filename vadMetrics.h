@@ -0,0 +1,152 @@
+/**
+ * Copyright (c) 2022 360Converter - Leo Huang 
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _VAD_METRICS_H_
+#define _VAD_METRICS_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Cumulative histogram with fixed upper bounds, as in Prometheus. Observing is
+// lock free, so it can be done from the processing threads while another
+// thread renders the metrics.
+class VadHistogram
+{
+public:
+    explicit VadHistogram( const std::vector<double>& bounds );
+
+    // Add one observation
+    void observe( double value );
+
+    // Upper bounds of the buckets, without the implicit +Inf bucket
+    const std::vector<double>& bounds() const { return m_bounds; }
+
+    // Observations in bucket i (not cumulative), i == bounds().size() is +Inf
+    uint64_t bucket( size_t i ) const { return m_buckets[i].load( std::memory_order_relaxed ); }
+
+    uint64_t count() const { return m_count.load( std::memory_order_relaxed ); }
+
+    double sum() const { return m_sum.load( std::memory_order_relaxed ); }
+
+    // Add the observations counted in |buckets| (one per bucket as above),
+    // |count| of them summing up to |sum|
+    void add( const std::vector<uint64_t>& buckets, uint64_t count, double sum );
+
+    void reset();
+
+private:
+    std::vector<double> m_bounds;
+    std::unique_ptr<std::atomic<uint64_t>[]> m_buckets;
+    std::atomic<uint64_t> m_count;
+    std::atomic<double> m_sum;
+};
+
+// Frames counted by one thread without atomics, e.g. over one vadSplit() call,
+// and published at once with VadMetrics::framesProcessed().
+struct VadFrameTally
+{
+    VadFrameTally();
+
+    // A frame classified in |seconds| of processing time, < 0 if not timed
+    void add( bool speech, double seconds );
+
+    uint64_t frames;
+    uint64_t speechFrames;
+    uint64_t timedFrames;
+    double seconds;
+    // Timed frames per frame latency bucket, see VadMetrics::frameLatency()
+    std::vector<uint64_t> latency;
+};
+
+// Metrics of the segmentation, updated by vadSplit(). Scrape them with
+// renderPrometheus(), or export them with writePrometheus() or
+// exportPrometheus() in Prometheus text exposition format.
+class VadMetrics
+{
+public:
+    VadMetrics();
+
+    // Sample rates with their own latency histogram
+    static const unsigned int kRates[4];
+
+    // A frame classified by the VAD in |seconds| of processing time, < 0 if it
+    // was not timed. Costs a few atomics per frame, batch work publishes a
+    // VadFrameTally instead.
+    void frameProcessed( unsigned int sampleRate, bool speech, double seconds );
+
+    // The frames of |tally|, classified at |sampleRate|
+    void framesProcessed( unsigned int sampleRate, const VadFrameTally& tally );
+
+    // Frames are only timed for the latency histograms when enabled, off by
+    // default as it reads the clock twice per frame.
+    void setFrameTiming( bool enabled ) { m_frameTiming.store( enabled, std::memory_order_relaxed ); }
+    bool frameTiming() const { return m_frameTiming.load( std::memory_order_relaxed ); }
+
+    // A segment of |seconds| audio has been emitted
+    void segmentEmitted( double seconds );
+
+    // |count| segments wait to be written, and one of them has been written.
+    // The depth is summed over all concurrent writers.
+    void writerQueued( uint64_t count );
+    void writerDequeued();
+
+    uint64_t frames() const { return m_frames.load( std::memory_order_relaxed ); }
+    uint64_t speechFrames() const { return m_speechFrames.load( std::memory_order_relaxed ); }
+    uint64_t segments() const { return m_segments.load( std::memory_order_relaxed ); }
+    uint64_t writerQueueDepth() const { return m_writerQueueDepth.load( std::memory_order_relaxed ); }
+
+    // Share of the frames classified as speech, 0 before the first frame
+    double speechRatio() const;
+
+    const VadHistogram& segmentDuration() const { return m_segmentDuration; }
+
+    // Latency histogram of |sampleRate|, nullptr for other rates
+    const VadHistogram* frameLatency( unsigned int sampleRate ) const;
+
+    // Metrics in Prometheus text format
+    std::string renderPrometheus() const;
+
+    // Writes the metrics to |fileName|, e.g. for the node exporter textfile
+    // collector. The file is replaced atomically.
+    bool writePrometheus( const char* fileName ) const;
+
+    // Passes the rendered metrics to |callback|
+    void exportPrometheus( const std::function<void( const std::string& )>& callback ) const;
+
+    // Clears the counters and histograms. The writer queue depth is live state
+    // and stays.
+    void reset();
+
+private:
+    std::atomic<uint64_t> m_frames;
+    std::atomic<uint64_t> m_speechFrames;
+    std::atomic<uint64_t> m_segments;
+    std::atomic<uint64_t> m_writerQueueDepth;
+    std::atomic<bool> m_frameTiming;
+    VadHistogram m_segmentDuration;
+    std::vector<std::unique_ptr<VadHistogram>> m_frameLatency;
+};
+
+// The metrics of all vadSplit() calls of the process
+VadMetrics& vadMetrics();
+
+#endif // _VAD_METRICS_H_
@@ -0,0 +1,324 @@
+/**
+ * Copyright (c) 2022 360Converter - Leo Huang 
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vadSegmenter.h"
+
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+#include "vadMetrics.h"
+
+#include <algorithm> // std::min, std::max
+#include <chrono> // std::chrono
+
+VadTrigger::VadTrigger()
+: m_triggered( false )
+, m_begin( 0 )
+, m_frames( 0 )
+{
+}
+
+unsigned int VadTrigger::count( bool speech ) const
+{
+    unsigned int num = 0;
+    for( bool decision : m_window.first() )
+        num += decision == speech;
+    for( bool decision : m_window.second() )
+        num += decision == speech;
+    return num;
+}
+
+VadTrigger::Event VadTrigger::push( bool speech )
+{
+    m_frames++;
+    m_window.push_back( speech );
+    if( !m_triggered )
+    {
+        // If we're NOTTRIGGERED and more than 90% of the frames in the
+        // window are voiced frames, then enter the TRIGGERED state. The
+        // segment starts with the frames already in the window.
+        if( count( true ) > 0.9 * m_window.capacity() )
+        {
+            m_triggered = true;
+            m_begin = m_frames - m_window.size();
+            m_window.clear();
+            return kStart;
+        }
+    }
+    else
+    {
+        // If more than 90% of the frames in the window are unvoiced, then
+        // enter NOTTRIGGERED and yield whatever audio we've collected.
+        if( count( false ) > 0.9 * m_window.capacity() )
+        {
+            m_triggered = false;
+            m_window.clear();
+            return kEnd;
+        }
+    }
+    return kNone;
+}
+
+void VadTrigger::reset()
+{
+    m_window.clear();
+    m_triggered = false;
+    m_begin = 0;
+    m_frames = 0;
+}
+
+VadStreamSegmenter::VadStreamSegmenter( unsigned int sampleRate, int aggressiveness, const Callback& onSegment )
+: m_vad( WebRtcVad_Create() )
+, m_sampleRate( sampleRate )
+, m_onSegment( onSegment )
+, m_frame( sampleRate / 1000 * VadTrigger::kFrameDurationMs )
+, m_fill( 0 )
+, m_workspace( ( WebRtcVad_WorkspaceSize() + 3 ) / 4 )
+{
+    if( WebRtcVad_Init( m_vad ) || WebRtcVad_set_mode( m_vad, aggressiveness ) ||
+        WebRtcVad_SetWorkspace( m_vad, m_workspace.data(), m_workspace.size() * sizeof( int32_t ) ) ||
+        WebRtcVad_ValidRateAndFrameLength( sampleRate, m_frame.size() ) )
+    {
+        WebRtcVad_Free( m_vad );
+        m_vad = nullptr;
+    }
+}
+
+VadStreamSegmenter::~VadStreamSegmenter()
+{
+    WebRtcVad_Free( m_vad );
+}
+
+void VadStreamSegmenter::process( const int16_t* samples, size_t count )
+{
+    // An invalid instance may have no frame to fill
+    if( !valid() )
+        return;
+    while( count > 0 )
+    {
+        size_t n = std::min( count, m_frame.size() - m_fill );
+        std::copy( samples, samples + n, m_frame.begin() + m_fill );
+        m_fill += n;
+        samples += n;
+        count -= n;
+        if( m_fill == m_frame.size() )
+            processFrame();
+    }
+}
+
+size_t VadStreamSegmenter::consume( Buffers::SpscRingBuffer<int16_t>& buffer )
+{
+    if( !valid() )
+        return 0;
+    size_t total = 0;
+    for( ;; )
+    {
+        size_t n = buffer.read( m_frame.data() + m_fill, m_frame.size() - m_fill );
+        if( n == 0 )
+            break;
+        m_fill += n;
+        total += n;
+        if( m_fill == m_frame.size() )
+            processFrame();
+    }
+    return total;
+}
+
+void VadStreamSegmenter::flush()
+{
+    // A partial frame is dropped, as in vadSplit()
+    m_fill = 0;
+    if( m_trigger.triggered() )
+        emit( m_trigger.frames() );
+    m_trigger.reset();
+}
+
+bool VadStreamSegmenter::setNoiseProfile( const WebRtcVadNoiseProfile& profile )
+{
+    return valid() && WebRtcVad_SetNoiseProfile( m_vad, &profile ) == 0;
+}
+
+bool VadStreamSegmenter::noiseProfile( WebRtcVadNoiseProfile& profile ) const
+{
+    return valid() && WebRtcVad_GetNoiseProfile( m_vad, &profile ) == 0;
+}
+
+void VadStreamSegmenter::processFrame()
+{
+    m_fill = 0;
+    if( !valid() )
+        return;
+    bool timed = vadMetrics().frameTiming();
+    std::chrono::steady_clock::time_point start = timed ? std::chrono::steady_clock::now()
+                                                        : std::chrono::steady_clock::time_point();
+    bool speech = WebRtcVad_Process( m_vad, m_sampleRate, m_frame.data(), m_frame.size() ) > 0;
+    vadMetrics().frameProcessed( m_sampleRate, speech,
+                                 timed ? std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count()
+                                       : -1.0 );
+    if( m_trigger.push( speech ) == VadTrigger::kEnd )
+        emit( m_trigger.frames() );
+}
+
+void VadStreamSegmenter::emit( uint64_t endFrame )
+{
+    uint64_t frameBytes = m_frame.size() * sizeof( int16_t );
+    uint64_t offset = m_trigger.segmentBegin() * frameBytes;
+    uint64_t length = ( endFrame - m_trigger.segmentBegin() ) * frameBytes;
+    float startTime = offset * 1.0f / ( m_sampleRate * 2 );
+    float endTime = startTime + length * 1.0f / ( m_sampleRate * 2 );
+    vadMetrics().segmentEmitted( endTime - startTime );
+    if( m_onSegment )
+        m_onSegment( VadSegment( offset, length, startTime, endTime ) );
+}
+
+// Number of frames of |frameMs| covering |ms|, at least one
+static unsigned int framesFor( unsigned int ms, unsigned int frameMs )
+{
+    return std::max( 1u, ( ms + frameMs - 1 ) / frameMs );
+}
+
+VadEndpointer::VadEndpointer( unsigned int sampleRate, const VadEndpointerConfig& config, const Callback& onEvent )
+: m_vad( WebRtcVad_Create() )
+, m_sampleRate( sampleRate )
+, m_startFrames( 1 )
+, m_hangoverFrames( 1 )
+, m_onEvent( onEvent )
+, m_frame( sampleRate / 1000 * config.frameMs )
+, m_fill( 0 )
+, m_samples( 0 )
+, m_speech( false )
+, m_run( 0 )
+, m_runStart( 0 )
+, m_workspace( ( WebRtcVad_WorkspaceSize() + 3 ) / 4 )
+{
+    if( WebRtcVad_Init( m_vad ) || WebRtcVad_set_mode( m_vad, config.aggressiveness ) ||
+        WebRtcVad_SetWorkspace( m_vad, m_workspace.data(), m_workspace.size() * sizeof( int32_t ) ) ||
+        WebRtcVad_EnableHangover( m_vad, 0 ) || WebRtcVad_ValidRateAndFrameLength( sampleRate, m_frame.size() ) )
+    {
+        WebRtcVad_Free( m_vad );
+        m_vad = nullptr;
+        return;
+    }
+    // Only once the frame duration is known to be supported
+    m_startFrames = framesFor( config.startMs, config.frameMs );
+    m_hangoverFrames = framesFor( config.hangoverMs, config.frameMs );
+}
+
+VadEndpointer::~VadEndpointer()
+{
+    WebRtcVad_Free( m_vad );
+}
+
+void VadEndpointer::process( const int16_t* samples, size_t count )
+{
+    // An invalid instance may have no frame to fill
+    if( !valid() )
+        return;
+    Clock::time_point arrival = Clock::now();
+    while( count > 0 )
+    {
+        size_t n = std::min( count, m_frame.size() - m_fill );
+        std::copy( samples, samples + n, m_frame.begin() + m_fill );
+        m_fill += n;
+        samples += n;
+        count -= n;
+        if( m_fill == m_frame.size() )
+            processFrame( arrival );
+    }
+}
+
+size_t VadEndpointer::consume( Buffers::SpscRingBuffer<int16_t>& buffer )
+{
+    if( !valid() )
+        return 0;
+    size_t total = 0;
+    for( ;; )
+    {
+        Clock::time_point arrival = Clock::now();
+        size_t n = buffer.read( m_frame.data() + m_fill, m_frame.size() - m_fill );
+        if( n == 0 )
+            break;
+        m_fill += n;
+        total += n;
+        if( m_fill == m_frame.size() )
+            processFrame( arrival );
+    }
+    return total;
+}
+
+void VadEndpointer::flush()
+{
+    m_fill = 0;
+    if( m_speech )
+    {
+        m_speech = false;
+        fire( VadEndpointEvent::kEnd, m_run > 0 ? m_runStart : m_samples, Clock::now() );
+    }
+    m_run = 0;
+}
+
+void VadEndpointer::processFrame( Clock::time_point arrival )
+{
+    m_fill = 0;
+    if( !valid() )
+        return;
+    bool timed = vadMetrics().frameTiming();
+    Clock::time_point start = timed ? Clock::now() : Clock::time_point();
+    bool speech = WebRtcVad_Process( m_vad, m_sampleRate, m_frame.data(), m_frame.size() ) > 0;
+    vadMetrics().frameProcessed( m_sampleRate, speech,
+                                 timed ? std::chrono::duration<double>( Clock::now() - start ).count() : -1.0 );
+
+    uint64_t frameStart = m_samples;
+    m_samples += m_frame.size();
+    if( speech == m_speech )
+    {
+        m_run = 0;
+        return;
+    }
+    if( m_run++ == 0 )
+        m_runStart = frameStart;
+    if( m_run >= ( m_speech ? m_hangoverFrames : m_startFrames ) )
+    {
+        m_speech = speech;
+        m_run = 0;
+        fire( speech ? VadEndpointEvent::kStart : VadEndpointEvent::kEnd, m_runStart, arrival );
+    }
+}
+
+void VadEndpointer::fire( VadEndpointEvent::Type type, uint64_t sample, Clock::time_point arrival )
+{
+    VadEndpointEvent event;
+    event.type = type;
+    event.sample = sample;
+    event.decisionSample = m_samples;
+    event.latencyMs = 1000.0 * ( m_samples - sample ) / m_sampleRate;
+    event.processingMs = 1000.0 * std::chrono::duration<double>( Clock::now() - arrival ).count();
+
+    if( type == VadEndpointEvent::kStart )
+    {
+        m_stats.starts++;
+        m_stats.meanStartLatencyMs += ( event.latencyMs - m_stats.meanStartLatencyMs ) / m_stats.starts;
+    }
+    else
+    {
+        m_stats.ends++;
+        m_stats.meanEndLatencyMs += ( event.latencyMs - m_stats.meanEndLatencyMs ) / m_stats.ends;
+        m_stats.maxEndLatencyMs = std::max( m_stats.maxEndLatencyMs, event.latencyMs );
+    }
+    m_stats.maxProcessingMs = std::max( m_stats.maxProcessingMs, event.processingMs );
+    if( m_onEvent )
+        m_onEvent( event );
+}
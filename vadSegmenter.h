@@ -0,0 +1,234 @@
+/**
+ * Copyright (c) 2022 360Converter - Leo Huang 
+ *
+ * See LICENSE for clarification regarding multiple authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _VAD_SEGMENTER_H_
+#define _VAD_SEGMENTER_H_
+
+#include <chrono>
+#include <functional>
+#include <stdint.h>
+#include <vector>
+
+#include "RingBuffer.h"
+#include "vadSplit.h"
+
+typedef struct WebRtcVadInst VadInst;
+
+// State machine turning per-frame VAD decisions into segments. A segment
+// starts with the padding window once more than 90% of the frames in it are
+// voiced, and ends once more than 90% of the frames in the window are
+// unvoiced.
+class VadTrigger
+{
+public:
+    // Frame size passed to the VAD, and the window of frames the trigger looks at
+    static const unsigned int kFrameDurationMs = 30;
+    static const unsigned int kPaddingDurationMs = 300;
+    static const unsigned int kNumPaddingFrames = kPaddingDurationMs / kFrameDurationMs;
+
+    enum Event
+    {
+        kNone,
+        kStart, // a segment started at segmentBegin()
+        kEnd    // the segment [segmentBegin(), frames()) ended
+    };
+
+    VadTrigger();
+
+    // Feed the decision of the next frame
+    Event push( bool speech );
+
+    bool triggered() const { return m_triggered; }
+
+    // First frame of the current or just ended segment
+    uint64_t segmentBegin() const { return m_begin; }
+
+    // Number of frames pushed
+    uint64_t frames() const { return m_frames; }
+
+    void reset();
+
+private:
+    // Number of frames in the window with the given decision
+    unsigned int count( bool speech ) const;
+
+    Buffers::StaticRingBuffer<bool, kNumPaddingFrames> m_window;
+    bool m_triggered;
+    uint64_t m_begin;
+    uint64_t m_frames;
+};
+
+// Streaming segmentation of 16-bit mono PCM. Samples are pushed in chunks of
+// any size, or pulled from an SpscRingBuffer filled by a capture thread, and
+// every finished segment is passed to the callback with its byte offset from
+// the start of the stream. The segments are the same as those of vadSplit()
+// on the whole stream, the audio itself is not kept.
+class VadStreamSegmenter
+{
+public:
+    typedef std::function<void( const VadSegment& )> Callback;
+
+    VadStreamSegmenter( unsigned int sampleRate, int aggressiveness, const Callback& onSegment );
+    ~VadStreamSegmenter();
+
+    VadStreamSegmenter( const VadStreamSegmenter& ) = delete;
+    VadStreamSegmenter& operator=( const VadStreamSegmenter& ) = delete;
+
+    // False if the sample rate or aggressiveness is not supported
+    bool valid() const { return m_vad != nullptr; }
+
+    // Process |count| samples, nothing if not valid()
+    void process( const int16_t* samples, size_t count );
+
+    // Process every sample available in |buffer|, returns the number read.
+    // Reads nothing if not valid(). Call it from the consumer thread only.
+    size_t consume( Buffers::SpscRingBuffer<int16_t>& buffer );
+
+    // End of stream, emits the pending segment if any
+    void flush();
+
+    // Warm start from a stored noise profile, call before the first samples
+    bool setNoiseProfile( const WebRtcVadNoiseProfile& profile );
+
+    // The noise profile adapted so far
+    bool noiseProfile( WebRtcVadNoiseProfile& profile ) const;
+
+private:
+    void processFrame();
+    void emit( uint64_t endFrame );
+
+    VadInst* m_vad;
+    unsigned int m_sampleRate;
+    Callback m_onSegment;
+    VadTrigger m_trigger;
+    std::vector<int16_t> m_frame;
+    size_t m_fill;
+    std::vector<int32_t> m_workspace; // scratch memory of m_vad
+};
+
+// Settings of VadEndpointer
+struct VadEndpointerConfig
+{
+    unsigned int frameMs;    // VAD frame duration, 10, 20 or 30 ms
+    int aggressiveness;      // 0 to 3, see vadSplit()
+    unsigned int startMs;    // voiced time in a row before a start is reported
+    unsigned int hangoverMs; // unvoiced time in a row before an end is reported
+    VadEndpointerConfig()
+    : frameMs( 10 )
+    , aggressiveness( 2 )
+    , startMs( 30 )
+    , hangoverMs( 70 )
+    {
+    }
+};
+
+// Start or end of an utterance, reported by VadEndpointer
+struct VadEndpointEvent
+{
+    enum Type
+    {
+        kStart,
+        kEnd
+    };
+
+    Type type;
+    uint64_t sample;         // first sample of the speech (kStart) or the first one after it (kEnd)
+    uint64_t decisionSample; // first sample after the frame the decision was taken on
+    double latencyMs;        // audio from the boundary to the decision, excluding the VAD's own hangover
+    double processingMs;     // wall clock time from receiving the deciding frame to the callback
+};
+
+// Latencies of the events reported so far, in ms
+struct VadEndpointerStats
+{
+    uint64_t starts;
+    uint64_t ends;
+    double meanStartLatencyMs;
+    double meanEndLatencyMs;
+    double maxEndLatencyMs;
+    double maxProcessingMs;
+    VadEndpointerStats()
+    : starts( 0 )
+    , ends( 0 )
+    , meanStartLatencyMs( 0.0 )
+    , meanEndLatencyMs( 0.0 )
+    , maxEndLatencyMs( 0.0 )
+    , maxProcessingMs( 0.0 )
+    {
+    }
+};
+
+// Low latency endpointing for voice bots. Unlike VadTrigger it looks at no
+// window: an utterance starts after startMs and ends after hangoverMs of
+// frames in a row with the other decision, and the callback is fired while
+// processing the frame the decision is taken on, with the boundary backdated
+// to the first frame of that run. The hangover of the VAD itself is disabled,
+// see WebRtcVad_EnableHangover(), so hangoverMs is the only one: with the
+// defaults the end of an utterance is reported 80 - 90 ms after the speech in
+// modes 0 to 2, and pauses up to about 60 ms are bridged. Mode 3 needs a longer
+// hangoverMs not to end utterances in their pauses.
+class VadEndpointer
+{
+public:
+    typedef std::function<void( const VadEndpointEvent& )> Callback;
+
+    VadEndpointer( unsigned int sampleRate, const VadEndpointerConfig& config, const Callback& onEvent );
+    ~VadEndpointer();
+
+    VadEndpointer( const VadEndpointer& ) = delete;
+    VadEndpointer& operator=( const VadEndpointer& ) = delete;
+
+    // False if the sample rate, frame duration or aggressiveness is not supported
+    bool valid() const { return m_vad != nullptr; }
+
+    // Process |count| samples, nothing if not valid()
+    void process( const int16_t* samples, size_t count );
+
+    // Process every sample available in |buffer|, returns the number read.
+    // Reads nothing if not valid(). Call it from the consumer thread only.
+    size_t consume( Buffers::SpscRingBuffer<int16_t>& buffer );
+
+    // End of stream, reports the end of a pending utterance
+    void flush();
+
+    bool inSpeech() const { return m_speech; }
+
+    const VadEndpointerStats& stats() const { return m_stats; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void processFrame( Clock::time_point arrival );
+    void fire( VadEndpointEvent::Type type, uint64_t sample, Clock::time_point arrival );
+
+    VadInst* m_vad;
+    unsigned int m_sampleRate;
+    unsigned int m_startFrames;
+    unsigned int m_hangoverFrames;
+    Callback m_onEvent;
+    std::vector<int16_t> m_frame;
+    size_t m_fill;
+    uint64_t m_samples;  // samples processed
+    bool m_speech;
+    unsigned int m_run;  // frames in a row against m_speech
+    uint64_t m_runStart; // first sample of the run
+    std::vector<int32_t> m_workspace; // scratch memory of m_vad
+    VadEndpointerStats m_stats;
+};
+
+#endif // _VAD_SEGMENTER_H_
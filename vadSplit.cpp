@@ -16,16 +16,32 @@
  * limitations under the License.
  */
 
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 #include "webrtc/common_audio/vad/include/webrtc_vad.h"
+#include "webrtc/common_audio/vad/vad_periodicity.h"
+#include "webrtc/common_audio/vad/vad_profile.h"
 #include "RingBuffer.h"
+#include "vadMetrics.h"
+#include "vadSegmenter.h"
 #include "vadSplit.h"
 
+#include <algorithm> // std::min_element
 #include <cassert> // assert
+#include <cmath> // std::log10
+#include <chrono> // std::chrono
 #include <iostream> // std::cout
 #include <string> // std::string
 #include <vector> // std::vector
 #include <fstream> // std::ifstream
 
+typedef std::chrono::steady_clock Clock;
+
+// Seconds elapsed since |start|
+static double secondsSince( Clock::time_point start )
+{
+    return std::chrono::duration<double>( Clock::now() - start ).count();
+}
+
 bool vadProcess(VadInst* handle, long sampleRate, const char* buf, long frame_length)
 {
     assert( frame_length % 2 == 0 );
@@ -38,12 +54,20 @@ bool vadProcess(VadInst* handle, long sampleRate, const char* buf, long frame_le
 
 bool readWavFile(const char* fileName, unsigned int& sampleRate, char** audioData, uint64_t& audioLength)
 {
-    // TODO: read sample rate
-    sampleRate = 16000;
+    VAD_PROFILE_BEGIN( readStart );
     FILE *pf = fopen( fileName, "rb" );
     if( nullptr == pf )
         return false;
 
+    // Sample rate is stored little endian at offset 24 of the wav header
+    unsigned char header[44];
+    if( fread( header, sizeof( char ), sizeof( header ), pf ) != sizeof( header ) )
+    {
+        fclose( pf );
+        return false;
+    }
+    sampleRate = header[24] | ( header[25] << 8 ) | ( header[26] << 16 ) | ( header[27] << 24 );
+
     // Get file size
     std::ifstream inFile(fileName, std::ios::binary);
     inFile.seekg(0, std::ios::end);
@@ -57,6 +81,7 @@ bool readWavFile(const char* fileName, unsigned int& sampleRate, char** audioDat
     fread( *audioData, sizeof( char ), bufSize, pf );
 
     fclose( pf );
+    VAD_PROFILE_END( nullptr, kVadStageRead, readStart );
 
     return true;
 }
@@ -193,22 +218,139 @@ std::vector<Frame> frame_generator(int frame_duration_ms, const char* audio, uns
     return frames;
 }
 
-std::vector<Segment> vadCollector(VadInst* handle, unsigned int sample_rate, unsigned int frame_duration_ms,
-        unsigned int padding_duration_ms, std::vector<Frame>& frames)
+// Tells stationary tonal noise from voiced speech by the pitch lag of strongly
+// periodic frames. A hum or a beep keeps its lag, the pitch of speech moves on
+// within a few hundred milliseconds.
+struct TonalTracker
 {
-    int num_padding_frames = padding_duration_ms / frame_duration_ms;
+    static const int16_t kMinPeriodicity = 14746; // 0.9 in Q14
 
-    // We have two states: TRIGGERED and NOTTRIGGERED. We start in the
-    // NOTTRIGGERED state.
-    bool triggered = false;
+    size_t lag; // lag the run started with, 0 for none
+    size_t run; // periodic frames since then with a lag within the tolerance
 
-    std::vector<Segment> segments;
-    std::vector<Frame> voiced_frames;
-    Buffers::RingBuffer<Frame> ring_buffer(num_padding_frames);
+    TonalTracker()
+    : lag( 0 )
+    , run( 0 )
+    {
+    }
 
-    for( Frame& frame : frames )
+    // Returns the length of the run including this frame.
+    size_t push( int16_t periodicity, size_t frameLag, size_t tolerance )
     {
+        if( periodicity < kMinPeriodicity )
+        {
+            reset();
+            return 0;
+        }
+        if( lag > 0 && frameLag + tolerance >= lag && frameLag <= lag + tolerance )
+        {
+            return ++run;
+        }
+        lag = frameLag;
+        run = 1;
+        return run;
+    }
+
+    void reset()
+    {
+        lag = 0;
+        run = 0;
+    }
+};
+
+// Runs the VAD on the frames and collects the voiced ones into segments. With
+// |stride| > 1, inside a run of at least kNumPaddingFrames unvoiced frames only
+// every |stride|-th frame is passed to the VAD, and the frames in between
+// inherit its decision while it stays unvoiced. Otherwise the VAD state from
+// before the probe is restored and the frames are scanned densely, so the
+// start of speech is found frame exact and only a voiced stretch shorter than
+// |stride| frames between two probes can be missed. Voiced runs are always
+// scanned densely, the VAD counts its hangover in frames.
+//
+// With |maxFrames| > 0 a segment reaching that many frames is split at the
+// frame least likely to be speech among its last kSplitWindowMs, at most half
+// of it. Every frame gets a score, its log energy raised by kSpeechScore if it
+// is voiced, so any unvoiced frame is preferred. Frames skipped by the coarse
+// scan take the score of the probe.
+//
+// With |tonalFrames| > 0 voiced frames are checked with
+// WebRtcVad_Periodicity(), and overruled once that many of them in a row are
+// periodic with the same pitch lag.
+std::vector<Segment> vadCollector(VadInst* handle, unsigned int sample_rate, std::vector<Frame>& frames,
+        size_t stride, size_t maxFrames, size_t tonalFrames, VadSplitStats* stats)
+{
+    static const unsigned int kSplitWindowMs = 3000;
+    static const float kSpeechScore = 10.0f;
+    std::vector<Segment> segments;
+    VadTrigger trigger;
+    std::vector<float> scores( frames.size() );
+    float score = 0.0f;
+    TonalTracker tonal;
+    // Published once at the end, the frames are only timed on request
+    VadFrameTally tally;
+    bool timed = stats || vadMetrics().frameTiming();
+    // Cost of the last classify(), counted by account() only for the
+    // decisions that are kept
+    double vadTime = -1.0;
+    bool overruled = false;
+
+    auto classify = [&]( const Frame& frame )
+    {
+        Clock::time_point vadStart = timed ? Clock::now() : Clock::time_point();
+        overruled = false;
         bool speech = vadProcess(handle, sample_rate, frame.bytes, frame.length);
+        if( tonalFrames > 0 && !speech )
+        {
+            tonal.reset();
+        }
+        else if( tonalFrames > 0 )
+        {
+            size_t lag = 0;
+            size_t history = ( frame.bytes - frames[0].bytes ) / 2;
+            int16_t periodicity = WebRtcVad_Periodicity( reinterpret_cast<const int16_t*>( frame.bytes ),
+                                                         frame.length / 2, history, sample_rate, &lag );
+            if( tonal.push( periodicity, lag, sample_rate / 8000 ) >= tonalFrames )
+            {
+                speech = false;
+                overruled = true;
+            }
+        }
+        vadTime = timed ? secondsSince( vadStart ) : -1.0;
+        if( maxFrames > 0 )
+        {
+            int scale = 0;
+            int32_t energy = WebRtcSpl_Energy( (int16_t*)frame.bytes, frame.length / 2, &scale );
+            score = std::log10( 1.0f + std::ldexp( float( energy ), scale ) / ( frame.length / 2 ) ) +
+                    ( speech ? kSpeechScore : 0.0f );
+        }
+        return speech;
+    };
+
+    auto account = [&]( bool speech )
+    {
+        tally.add( speech, vadTime );
+        if( stats )
+        {
+            stats->vadTime += vadTime;
+            if( overruled )
+                stats->tonalFrames++;
+        }
+        return speech;
+    };
+
+    auto emit = [&]( uint64_t begin, uint64_t end )
+    {
+        Segment segment;
+        segment.data = frames[begin].bytes;
+        segment.length = ( end - begin ) * frames[begin].length;
+        segments.push_back( segment );
+    };
+
+    bool last = false;
+    size_t run = 0;
+    uint64_t begin = 0;
+    auto collect = [&]( Frame& frame, bool speech )
+    {
         if( speech )
         {
             std::cout<<"1";
@@ -218,111 +360,347 @@ std::vector<Segment> vadCollector(VadInst* handle, unsigned int sample_rate, uns
             std::cout<<"0";
         }
         frame.silence = !speech;
+        run = ( run > 0 && speech == last ) ? run + 1 : 1;
+        last = speech;
 
-        if( !triggered )
+        scores[trigger.frames()] = score;
+        VadTrigger::Event event = trigger.push( speech );
+        if( event == VadTrigger::kStart )
+        {
+            begin = trigger.segmentBegin();
+            std::cout<<"+("<<frames[begin].timestamp<<")";
+        }
+        else if( event == VadTrigger::kEnd )
+        {
+            std::cout<<"-("<<frame.timestamp + frame.duration<<")";
+            emit( begin, trigger.frames() );
+        }
+        else if( trigger.triggered() && maxFrames > 0 && trigger.frames() - begin >= maxFrames )
         {
-            ring_buffer.push_back(frame);
-            unsigned int num_voiced = 0;
-            for(auto it = ring_buffer.begin(); it != ring_buffer.end(); it++) 
+            uint64_t end = trigger.frames();
+            uint64_t window = std::min<uint64_t>( maxFrames / 2, kSplitWindowMs / VadTrigger::kFrameDurationMs );
+            uint64_t split = end - window;
+            for( uint64_t k = split + 1; k < end; k++ )
             {
-                if( !(*it).silence )
-                    num_voiced++;
+                if( scores[k] < scores[split] )
+                    split = k;
             }
+            std::cout<<"|("<<frames[split].timestamp<<")";
+            emit( begin, split );
+            begin = split;
+        }
+    };
 
-            // If we're NOTTRIGGERED and more than 90% of the frames in
-            // the ring buffer are voiced frames, then enter the
-            // TRIGGERED state.
-            if ( num_voiced > 0.9 * ring_buffer.capacity())
+    std::vector<uint8_t> snapshot( stride > 1 ? WebRtcVad_SnapshotSize() : 0 );
+    size_t i = 0;
+    while( i < frames.size() )
+    {
+        if( stride > 1 && !last && run >= VadTrigger::kNumPaddingFrames && i + stride <= frames.size() )
+        {
+            size_t probe = i + stride - 1;
+            TonalTracker tonalBefore = tonal;
+            WebRtcVad_Snapshot( handle, snapshot.data(), snapshot.size() );
+            if( !classify( frames[probe] ) )
             {
-                triggered = true;
-                std::cout<<"+("<<ring_buffer.front().timestamp<<")";
-
-                // We want to yield all the audio we see from now until
-                // we are NOTTRIGGERED, but we have to start with the
-                // audio that's already in the ring buffer.
-                for(auto it = ring_buffer.begin(); it != ring_buffer.end(); it++) 
-                {
-                    voiced_frames.push_back( *it );
-                }
-                ring_buffer.clear();
+                account( false );
+                for( ; i <= probe; i++ )
+                    collect( frames[i], false );
+                if( stats )
+                    stats->skippedFrames += stride - 1;
+                continue;
             }
+            // Speech starts in between, the probe is classified again
+            WebRtcVad_Restore( handle, snapshot.data(), snapshot.size() );
+            tonal = tonalBefore;
+            for( ; i <= probe; i++ )
+                collect( frames[i], account( classify( frames[i] ) ) );
         }
         else
         {
-            // We're in the TRIGGERED state, so collect the audio data
-            // and add it to the ring buffer.
-            voiced_frames.push_back(frame);
-            ring_buffer.push_back(frame);
-            unsigned int num_unvoiced = 0;
-            for(auto it = ring_buffer.begin(); it != ring_buffer.end(); it++) 
-            {
-                if( (*it).silence )
-                    num_unvoiced++;
-            }
-
-            // If more than 90% of the frames in the ring buffer are
-            // unvoiced, then enter NOTTRIGGERED and yield whatever
-            // audio we've collected.
-            if( num_unvoiced > 0.9 * ring_buffer.capacity())
-            {
-                std::cout<<"-("<<frame.timestamp + frame.duration<<")";
-                triggered = false;
-                Segment segment;
-                segment.data = voiced_frames[0].bytes;
-                segment.length = voiced_frames.size() * voiced_frames[0].length;
-                segments.push_back( segment );
-                ring_buffer.clear();
-                voiced_frames.clear();
-            }
+            collect( frames[i], account( classify( frames[i] ) ) );
+            i++;
         }
     }
     std::cout<<std::endl;
 
     // If we have any leftover voiced audio when we run out of input,
     // yield it.
-    if( voiced_frames.size() > 0 )
+    if( trigger.triggered() )
     {
-        Segment segment;
-        segment.data = voiced_frames[0].bytes;
-        segment.length = voiced_frames.size() * voiced_frames[0].length;
-        segments.push_back( segment );
+        emit( begin, trigger.frames() );
     }
+    vadMetrics().framesProcessed( sample_rate, tally );
 
     return segments;
 }
 
-int vadSplit( const char* fileName, std::vector<VadSegment>& segment, int outputFmt /*= -1*/, int aggressiveness /*= 2*/ )
+// Block size and guard of the boundary refinement
+static const unsigned int kRefineBlockMs = 5;
+static const unsigned int kRefineGuardMs = 10;
+
+// Moves the cut at sample |cut| to the onset (|start|) or offset of speech
+// within |windowMs| around it, but not outside [|lower|, |upper|). The energy of 5 ms blocks in the window is
+// compared to a threshold 30% of the way from the quietest to the loudest
+// block in dB, and the cut placed kRefineGuardMs outside the first or last
+// block above it, at the nearest zero crossing towards the silence. The cut is
+// kept when the window has less than 10 dB contrast. Costs O(window).
+static uint64_t refineCut( const int16_t* samples, uint64_t lower, uint64_t upper, unsigned int sampleRate,
+                           uint64_t cut, unsigned int windowMs, bool start )
+{
+    uint64_t block = sampleRate * kRefineBlockMs / 1000;
+    uint64_t guard = sampleRate * kRefineGuardMs / 1000;
+    uint64_t window = uint64_t( sampleRate ) * windowMs / 1000;
+    uint64_t begin = std::max( lower, cut > window ? cut - window : 0 );
+    uint64_t end = std::min( upper, cut + window );
+    if( end <= begin )
+        return cut;
+    size_t blocks = ( end - begin ) / block;
+    if( blocks < 2 )
+        return cut;
+
+    std::vector<double> energy( blocks );
+    for( size_t k = 0; k < blocks; k++ )
+    {
+        int64_t sum = 0;
+        for( const int16_t* p = samples + begin + k * block; p < samples + begin + ( k + 1 ) * block; p++ )
+            sum += int32_t( *p ) * *p;
+        energy[k] = std::log10( 1.0 + double( sum ) / block );
+    }
+    double floor = *std::min_element( energy.begin(), energy.end() );
+    double peak = *std::max_element( energy.begin(), energy.end() );
+    if( peak - floor < 1.0 )
+        return cut;
+    double threshold = floor + 0.3 * ( peak - floor );
+
+    uint64_t refined;
+    if( start )
+    {
+        size_t k = 0;
+        while( energy[k] <= threshold )
+            k++;
+        refined = begin + k * block;
+        refined = refined > begin + guard ? refined - guard : begin;
+        // Back to the nearest zero crossing
+        for( uint64_t i = refined; i > begin && refined - i < block; i-- )
+        {
+            if( ( samples[i - 1] < 0 ) != ( samples[i] < 0 ) || samples[i] == 0 )
+                return i;
+        }
+    }
+    else
+    {
+        size_t k = blocks - 1;
+        while( energy[k] <= threshold )
+            k--;
+        refined = std::min( end, begin + ( k + 1 ) * block + guard );
+        // On to the nearest zero crossing
+        for( uint64_t i = refined; i < end && i - refined < block; i++ )
+        {
+            if( ( samples[i - 1] < 0 ) != ( samples[i] < 0 ) || samples[i] == 0 )
+                return i;
+        }
+    }
+    return refined;
+}
+
+// Snaps the frame aligned segment boundaries to sample accurate cut points,
+// re-analyzing |windowMs| around each boundary only. Segments keep their order
+// and never overlap, nor grow beyond |maxLength| bytes.
+static void refineSegments( const char* audioData, uint64_t audioLength, unsigned int sampleRate,
+                            unsigned int windowMs, uint64_t maxLength, std::vector<Segment>& segments )
 {
+    const int16_t* samples = reinterpret_cast<const int16_t*>( audioData );
+    uint64_t count = audioLength / 2;
+    uint64_t previousEnd = 0;
+    for( size_t i = 0; i < segments.size(); i++ )
+    {
+        Segment& segment = segments[i];
+        uint64_t begin = ( segment.data - audioData ) / 2;
+        uint64_t end = begin + segment.length / 2;
+        uint64_t nextBegin = i + 1 < segments.size() ? ( segments[i + 1].data - audioData ) / 2 : count;
+        uint64_t refinedBegin = refineCut( samples, previousEnd, end, sampleRate, begin, windowMs, true );
+        uint64_t refinedEnd = refineCut( samples, refinedBegin, nextBegin, sampleRate, end, windowMs, false );
+        if( refinedEnd > refinedBegin && 2 * ( refinedEnd - refinedBegin ) <= maxLength )
+        {
+            begin = refinedBegin;
+            end = refinedEnd;
+        }
+        segment.data = audioData + 2 * begin;
+        segment.length = static_cast<unsigned int>( 2 * ( end - begin ) );
+        previousEnd = end;
+    }
+}
+
+// Merges every segment shorter than |minLength| bytes into its closer
+// neighbour, as long as the merged segment stays within |maxLength| bytes, and
+// widens the ones left over with the audio around them, without overlapping
+// the neighbours. Costs O(segments).
+static void enforceMinLength( const char* audioData, uint64_t audioLength, uint64_t minLength, uint64_t maxLength,
+                              std::vector<Segment>& segments )
+{
+    size_t i = 0;
+    while( i < segments.size() )
+    {
+        const char* begin = segments[i].data;
+        const char* end = begin + segments[i].length;
+        if( uint64_t( end - begin ) >= minLength )
+        {
+            i++;
+            continue;
+        }
+        const Segment* previous = i > 0 ? &segments[i - 1] : nullptr;
+        const Segment* next = i + 1 < segments.size() ? &segments[i + 1] : nullptr;
+        const char* lower = previous ? previous->data + previous->length : audioData;
+        const char* upper = next ? next->data : audioData + audioLength;
+        bool mergePrevious = previous && uint64_t( end - previous->data ) <= maxLength;
+        bool mergeNext = next && uint64_t( next->data + next->length - begin ) <= maxLength;
+        if( mergePrevious && ( !mergeNext || begin - lower <= upper - end ) )
+        {
+            // Check the merged segment again
+            segments[i - 1].length = static_cast<unsigned int>( end - previous->data );
+            segments.erase( segments.begin() + i );
+            i--;
+        }
+        else if( mergeNext )
+        {
+            segments[i].length = static_cast<unsigned int>( next->data + next->length - begin );
+            segments.erase( segments.begin() + i + 1 );
+        }
+        else
+        {
+            // Half of the missing audio in front, whole samples only
+            uint64_t missing = minLength - ( end - begin );
+            begin -= std::min<uint64_t>( missing / 4 * 2, begin - lower );
+            end = begin + std::min<uint64_t>( minLength, upper - begin );
+            begin = end - std::min<uint64_t>( minLength, end - lower );
+            segments[i].data = begin;
+            segments[i].length = static_cast<unsigned int>( end - begin );
+            i++;
+        }
+    }
+}
+
+int vadSplit( const char* fileName, std::vector<VadSegment>& segment, int outputFmt /*= -1*/, int aggressiveness /*= 2*/,
+              VadSplitStats* stats /*= nullptr*/ )
+{
+    VadSplitOptions options;
+    options.outputFmt = outputFmt;
+    options.aggressiveness = aggressiveness;
+    options.stats = stats;
+    return vadSplit( fileName, segment, options );
+}
+
+int vadSplit( const char* audioData, uint64_t audioLength, unsigned int sampleRate,  std::vector<VadSegment>& vadSegments, int outputFmt /*= -1*/, int aggressiveness /*= 2*/,
+              VadSplitStats* stats /*= nullptr*/ )
+{
+    VadSplitOptions options;
+    options.outputFmt = outputFmt;
+    options.aggressiveness = aggressiveness;
+    options.stats = stats;
+    return vadSplit( audioData, audioLength, sampleRate, vadSegments, options );
+}
+
+int vadSplit( const char* fileName, std::vector<VadSegment>& segment, const VadSplitOptions& options )
+{
+    VadSplitStats* stats = options.stats;
     unsigned int sampleRate = 0;
     char* audioData = nullptr;
     uint64_t audioLength = 0;
+    Clock::time_point readStart = Clock::now();
     if( !readWavFile( fileName, sampleRate, &audioData, audioLength ))
     {
         std::cout<<"Failed to read wav file"<<std::endl;
         return -2;
     }
-    return vadSplit( audioData, audioLength, sampleRate, segment, outputFmt, aggressiveness );
+    if( stats )
+        stats->readTime += secondsSince( readStart );
+    int result = vadSplit( audioData, audioLength, sampleRate, segment, options );
+    delete []audioData;
+    return result;
 }
 
 
-int vadSplit( const char* audioData, uint64_t audioLength, unsigned int sampleRate,  std::vector<VadSegment>& vadSegments, int outputFmt /*= -1*/, int aggressiveness /*= 2*/ )
+int vadSplit( const char* audioData, uint64_t audioLength, unsigned int sampleRate, std::vector<VadSegment>& vadSegments,
+              const VadSplitOptions& options )
 {
+    VadSplitStats* stats = options.stats;
+    int outputFmt = options.outputFmt;
     VadInst *vad = WebRtcVad_Create();
-    if (WebRtcVad_Init(vad)) 
+    // Scratch memory of the VAD for the whole run, instead of the stack
+    std::vector<int32_t> workspace( ( WebRtcVad_WorkspaceSize() + 3 ) / 4 );
+    if (WebRtcVad_Init(vad) || WebRtcVad_SetWorkspace( vad, workspace.data(), workspace.size() * sizeof( int32_t ) ))
+    {
+        WebRtcVad_Free(vad);
+        return -1;
+    }
+
+    if (WebRtcVad_set_mode(vad, options.aggressiveness)) 
     {
+        WebRtcVad_Free(vad);
         return -1;
     }
 
-    if (WebRtcVad_set_mode(vad, aggressiveness)) 
+    if( WebRtcVad_SetEngine( vad, options.engine ) )
+    {
+        WebRtcVad_Free(vad);
+        return -1;
+    }
+    if( options.noiseProfile && WebRtcVad_SetNoiseProfile( vad, options.noiseProfile ) )
+    {
+        WebRtcVad_Free(vad);
+        return -1;
+    }
+    if( options.silenceThreshold >= 0 && WebRtcVad_SetSilenceThreshold( vad, options.silenceThreshold ) )
     {
+        WebRtcVad_Free(vad);
         return -1;
     }
-    auto frames = frame_generator(30, audioData, audioLength, sampleRate);
-    auto segments = vadCollector(vad, sampleRate, 30, 300, frames);
+    Clock::time_point stageStart = Clock::now();
+    auto frames = frame_generator(VadTrigger::kFrameDurationMs, audioData, audioLength, sampleRate);
+    if( stats )
+    {
+        stats->frameTime += secondsSince( stageStart );
+        stats->frames += frames.size();
+        stats->audioDuration += audioLength / ( 2.0 * sampleRate );
+        stageStart = Clock::now();
+    }
+    double vadTime = stats ? stats->vadTime : 0.0;
+    // A stretch that can start or end a segment spans more than 90% of the
+    // padding window, keep the stride below it so a probe always lands in it.
+    size_t stride = options.maxBoundaryErrorMs > 0 ? options.maxBoundaryErrorMs / VadTrigger::kFrameDurationMs : 1;
+    if( stride < 1 )
+        stride = 1;
+    if( stride > VadTrigger::kNumPaddingFrames - 1 )
+        stride = VadTrigger::kNumPaddingFrames - 1;
+    size_t maxFrames = options.maxSegmentMs / VadTrigger::kFrameDurationMs;
+    if( options.maxSegmentMs > 0 && maxFrames < 1 )
+        maxFrames = 1;
+    uint64_t maxLength = maxFrames > 0 && !frames.empty() ? uint64_t( maxFrames ) * frames[0].length : UINT64_MAX;
+    size_t tonalFrames = ( options.tonalRejectMs + VadTrigger::kFrameDurationMs - 1 ) / VadTrigger::kFrameDurationMs;
+    auto segments = vadCollector(vad, sampleRate, frames, stride, maxFrames, tonalFrames, stats);
+    if( options.refineWindowMs > 0 )
+        refineSegments( audioData, audioLength, sampleRate, options.refineWindowMs, maxLength, segments );
+    if( options.minSegmentMs > 0 )
+        enforceMinLength( audioData, audioLength, uint64_t( options.minSegmentMs ) * sampleRate / 1000 * 2, maxLength,
+                          segments );
+    if( options.adaptedProfile )
+        WebRtcVad_GetNoiseProfile( vad, options.adaptedProfile );
+    if( stats )
+        stats->silentFrames += WebRtcVad_SilentFrames( vad );
+    WebRtcVad_Free(vad);
+    if( stats )
+    {
+        // VAD calls are timed separately inside the collector
+        stats->collectTime += secondsSince( stageStart ) - ( stats->vadTime - vadTime );
+        stats->segments += segments.size();
+        stageStart = Clock::now();
+    }
     int num = 0;
+    vadMetrics().writerQueued( segments.size() );
     for( auto& segment : segments )
     {
         char path[256];
+        VAD_PROFILE_BEGIN( writeStart );
         if( outputFmt == 0 )
         {
             snprintf(path, sizeof(path), "chunk-%02d.pcm", num++);
@@ -338,17 +716,17 @@ int vadSplit( const char* audioData, uint64_t audioLength, unsigned int sampleRa
         {
             // do nothing
         }
+        VAD_PROFILE_END( nullptr, kVadStageWrite, writeStart );
         float startTime = (segment.data-audioData)*1.0f/(sampleRate*2);
         float endTime = startTime + segment.length * 1.0f/(sampleRate*2);
         std::cout<<"("<<startTime<<" - "<<endTime<<")"<<std::endl;
         VadSegment vs(segment.data - audioData, segment.length, startTime, endTime);
         vadSegments.push_back( vs );
+        vadMetrics().segmentEmitted( endTime - startTime );
+        vadMetrics().writerDequeued();
     }
-    if( nullptr != audioData )
-    {
-        delete []audioData;
-        audioData = nullptr;
-    }
-        
+    if( stats )
+        stats->writeTime += secondsSince( stageStart );
+
     return segments.size();
 }
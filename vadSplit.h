@@ -19,8 +19,11 @@
 #ifndef _VAD_SPLIT_H_
 #define _VAD_SPLIT_H_
 
+#include <stdint.h>
 #include <vector>
 
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+
 // offset to data pointer
 struct VadSegment
 {
@@ -37,6 +40,69 @@ struct VadSegment
     }
 };
 
+// Time spent in each stage of vadSplit(), in seconds of wall clock time. The
+// values are accumulated, so one instance can collect several calls.
+struct VadSplitStats
+{
+    double readTime;      // reading the wav file
+    double frameTime;     // splitting the audio into frames
+    double vadTime;       // WebRtcVad_Process() calls
+    double collectTime;   // collecting voiced frames into segments
+    double writeTime;     // writing the chunk files
+    double audioDuration; // duration of the processed audio
+    uint64_t frames;      // number of frames passed to the VAD
+    uint64_t segments;    // number of segments emitted
+    uint64_t silentFrames; // number of frames skipped by the silence gate
+    uint64_t skippedFrames; // number of frames not passed to the VAD by the coarse scan
+    uint64_t tonalFrames; // number of voiced frames overruled as tonal noise
+    VadSplitStats()
+    : readTime( 0.0 )
+    , frameTime( 0.0 )
+    , vadTime( 0.0 )
+    , collectTime( 0.0 )
+    , writeTime( 0.0 )
+    , audioDuration( 0.0 )
+    , frames( 0 )
+    , segments( 0 )
+    , silentFrames( 0 )
+    , skippedFrames( 0 )
+    , tonalFrames( 0 )
+    {
+    }
+};
+
+// Settings of vadSplit()
+struct VadSplitOptions
+{
+    int outputFmt;                           // see below
+    int aggressiveness;                      // see below
+    VadSplitStats* stats;                    // optional, accumulates the time spent in each stage
+    const WebRtcVadNoiseProfile* noiseProfile; // optional, warm start from a stored noise profile
+    WebRtcVadNoiseProfile* adaptedProfile;   // optional, receives the noise profile adapted by the end
+    int silenceThreshold;                    // see WebRtcVad_SetSilenceThreshold(), -1 disables the gate
+    unsigned int maxBoundaryErrorMs;         // coarse scan, see below, 0 scans every frame
+    unsigned int refineWindowMs;             // boundary refinement, see below, 0 keeps frame boundaries
+    unsigned int minSegmentMs;               // shorter segments are merged or widened, 0 for no minimum
+    unsigned int maxSegmentMs;               // longer segments are split, 0 for no maximum
+    unsigned int tonalRejectMs;              // stationary tonal noise, see below, 0 keeps it
+    int engine;                              // see WebRtcVad_SetEngine()
+    VadSplitOptions()
+    : outputFmt( -1 )
+    , aggressiveness( 2 )
+    , stats( nullptr )
+    , noiseProfile( nullptr )
+    , adaptedProfile( nullptr )
+    , silenceThreshold( -1 )
+    , maxBoundaryErrorMs( 0 )
+    , refineWindowMs( 0 )
+    , minSegmentMs( 0 )
+    , maxSegmentMs( 0 )
+    , tonalRejectMs( 0 )
+    , engine( kVadEngineFixed )
+    {
+    }
+};
+
 /**
 * @aggressiveness 
 * it is an integer between 0 and 3. 
@@ -45,9 +111,46 @@ struct VadSegment
 *     0: pcm
 *     1: wav
 *     -1: don't write output file
+* @stats
+*     optional, accumulates the time spent in each stage
+* @maxBoundaryErrorMs
+*     coarse scan for batch work on sparse speech: inside long silence only one frame per maxBoundaryErrorMs
+*     (at most 270 ms) is passed to the VAD. The start of speech is still located frame exact, but a voiced
+*     stretch shorter than that between two probed frames can be missed, moving a boundary by up to
+*     maxBoundaryErrorMs. The noise model adapts on the probed frames only.
+* @refineWindowMs
+*     segment boundaries are multiples of 30 ms frames and include the padding of the trigger. With refineWindowMs
+*     the energy within that distance of each boundary is re-analyzed in 5 ms blocks, and the boundary moved to the
+*     onset or offset of speech plus 10 ms, at a zero crossing. Costs O(segments), not O(audio). The trigger ends
+*     a segment up to about 400 ms after the speech, 500 ms covers it.
+* @minSegmentMs, maxSegmentMs
+*     bounds of the segment duration, e.g. 500 and 30000 for ASR batches. A segment reaching maxSegmentMs is split
+*     at the quietest unvoiced frame of its last 3 s, from scores kept per frame while collecting. A segment shorter
+*     than minSegmentMs is merged into its closer neighbour if the result stays within maxSegmentMs, otherwise
+*     widened with the audio around it.
+* @tonalRejectMs
+*     the GMM takes stationary tonal noise (hum, beeps, ringing, machinery) for speech. With tonalRejectMs every
+*     voiced frame is checked with WebRtcVad_Periodicity(), and once the frames have been strongly periodic (0.9)
+*     with the same pitch lag (within 125 us) for that long they are treated as unvoiced. The pitch of speech moves
+*     on sooner, 300 ms or more leaves sustained vowels alone. The first tonalRejectMs of a tone still count as
+*     voiced. Costs a correlation over the pitch lags per voiced frame.
+* @engine
+*     kVadEngineFloat runs the filterbank and the GMM in float for batch work. Its decisions agree with the fixed
+*     point engine on about 94% of the frames of the test corpus, see README.md. It has no noise profile, so
+*     noiseProfile and adaptedProfile need kVadEngineFixed.
+*
+* Every call also updates the process wide metrics, see vadMetrics().
 */
-int vadSplit( const char* fileName, std::vector<VadSegment>& segment, int outputFmt = -1, int aggressiveness = 2 );
+int vadSplit( const char* fileName, std::vector<VadSegment>& segment, int outputFmt = -1, int aggressiveness = 2,
+              VadSplitStats* stats = nullptr );
+
+// The audio data is owned by the caller, it must be 16-bit mono PCM.
+int vadSplit( const char* audioData, uint64_t audioLength, unsigned int sampleRate,  std::vector<VadSegment>& segment, int outputFmt = -1, int aggressiveness = 2,
+              VadSplitStats* stats = nullptr );
+
+int vadSplit( const char* fileName, std::vector<VadSegment>& segment, const VadSplitOptions& options );
 
-int vadSplit( const char* audioData, uint64_t audioLength, unsigned int sampleRate,  std::vector<VadSegment>& segment, int outputFmt = -1, int aggressiveness = 2 );
+int vadSplit( const char* audioData, uint64_t audioLength, unsigned int sampleRate, std::vector<VadSegment>& segment,
+              const VadSplitOptions& options );
 
 #endif // _VAD_SPLIT_H_
@@ -0,0 +1,72 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+// Sum of (seq1[j] * seq2[j]) >> |right_shifts|, wrapping like the C version.
+// The products are formed exactly in 32 bit lanes from their low and high
+// halves, so the shift applies per term. Without a shift the pairwise sums of
+// PMADDWD wrap the same way and are used directly.
+static int32_t DotProductWithShift(const int16_t* seq1,
+                                   const int16_t* seq2,
+                                   size_t length,
+                                   int right_shifts) {
+  const __m128i shift = _mm_cvtsi32_si128(right_shifts);
+  __m128i sum0 = _mm_setzero_si128();
+  __m128i sum1 = _mm_setzero_si128();
+  int32_t lanes[4];
+  uint32_t corr;
+  size_t j = 0;
+
+  if (right_shifts == 0) {
+    for (; j + 16 <= length; j += 16) {
+      __m128i x0 = _mm_loadu_si128((const __m128i*)&seq1[j]);
+      __m128i y0 = _mm_loadu_si128((const __m128i*)&seq2[j]);
+      __m128i x1 = _mm_loadu_si128((const __m128i*)&seq1[j + 8]);
+      __m128i y1 = _mm_loadu_si128((const __m128i*)&seq2[j + 8]);
+      sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(x0, y0));
+      sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(x1, y1));
+    }
+  }
+  for (; j + 8 <= length; j += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&seq1[j]);
+    __m128i y = _mm_loadu_si128((const __m128i*)&seq2[j]);
+    __m128i lo = _mm_mullo_epi16(x, y);
+    __m128i hi = _mm_mulhi_epi16(x, y);
+    sum0 = _mm_add_epi32(sum0,
+                         _mm_sra_epi32(_mm_unpacklo_epi16(lo, hi), shift));
+    sum1 = _mm_add_epi32(sum1,
+                         _mm_sra_epi32(_mm_unpackhi_epi16(lo, hi), shift));
+  }
+  _mm_storeu_si128((__m128i*)lanes, _mm_add_epi32(sum0, sum1));
+  corr = (uint32_t)lanes[0] + (uint32_t)lanes[1] + (uint32_t)lanes[2] +
+         (uint32_t)lanes[3];
+  for (; j < length; j++)
+    corr += (uint32_t)((seq1[j] * seq2[j]) >> right_shifts);
+  return (int32_t)corr;
+}
+
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2) {
+  size_t i = 0;
+
+  for (i = 0; i < dim_cross_correlation; i++) {
+    *cross_correlation++ =
+        DotProductWithShift(seq1, seq2, dim_seq, right_shifts);
+    seq2 += step_seq2;
+  }
+}
@@ -10,12 +10,12 @@
 
 #include "webrtc/common_audio/signal_processing/dot_product_with_scale.h"
 
-#include "webrtc/rtc_base/numerics/safe_conversions.h"
+#include <limits>
 
-int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
-                                      const int16_t* vector2,
-                                      size_t length,
-                                      int scaling) {
+int32_t WebRtcSpl_DotProductWithScaleC(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling) {
   int64_t sum = 0;
   size_t i = 0;
 
@@ -30,5 +30,9 @@ int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
     sum += (vector1[i] * vector2[i]) >> scaling;
   }
 
-  return rtc::saturated_cast<int32_t>(sum);
+  if (sum > std::numeric_limits<int32_t>::max())
+    return std::numeric_limits<int32_t>::max();
+  if (sum < std::numeric_limits<int32_t>::min())
+    return std::numeric_limits<int32_t>::min();
+  return static_cast<int32_t>(sum);
 }
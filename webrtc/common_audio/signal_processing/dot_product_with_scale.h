@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "webrtc/typedefs.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -28,11 +30,31 @@ extern "C" {
 //                        during calculation to avoid overflow, i.e., the
 //                        output will be in Q(-|scaling|)
 //
-// Return value         : The dot product in Q(-scaling)
-int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
-                                      const int16_t* vector2,
-                                      size_t length,
-                                      int scaling);
+// Return value         : The dot product in Q(-scaling), saturated to 32 bits
+//
+// The function pointer starts out at WebRtcSpl_DotProductWithScaleC(),
+// WebRtcSpl_Init() in spl_init.c switches it to SIMD.
+typedef int32_t (*DotProductWithScale)(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling);
+extern DotProductWithScale WebRtcSpl_DotProductWithScale;
+int32_t WebRtcSpl_DotProductWithScaleC(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_DotProductWithScaleSSE2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling);
+#if defined(WEBRTC_ENABLE_AVX2)
+int32_t WebRtcSpl_DotProductWithScaleAVX2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling);
+#endif
+#endif
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/signal_processing/dot_product_with_scale.h"
+
+#include <immintrin.h>
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+// Adds the eight 32 bit lanes of |terms| to the four 64 bit lanes of |sum|.
+static __m256i AddWidened(__m256i sum, __m256i terms) {
+  const __m256i sign = _mm256_srai_epi32(terms, 31);
+  sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(terms, sign));
+  return _mm256_add_epi64(sum, _mm256_unpackhi_epi32(terms, sign));
+}
+
+int32_t WebRtcSpl_DotProductWithScaleAVX2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling) {
+  // Each product is formed exactly in its own 32 bit lane from the zero
+  // extended samples and shifted, then summed in 64 bits like the C version.
+  const __m256i zero = _mm256_setzero_si256();
+  const __m128i shift = _mm_cvtsi32_si128(scaling);
+  __m256i sum = zero;
+  int64_t lanes[4];
+  int64_t total;
+  size_t i = 0;
+
+  for (; i + 16 <= length; i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&vector1[i]);
+    __m256i y = _mm256_loadu_si256((const __m256i*)&vector2[i]);
+    __m256i lo = _mm256_madd_epi16(_mm256_unpacklo_epi16(x, zero),
+                                   _mm256_unpacklo_epi16(y, zero));
+    __m256i hi = _mm256_madd_epi16(_mm256_unpackhi_epi16(x, zero),
+                                   _mm256_unpackhi_epi16(y, zero));
+    sum = AddWidened(sum, _mm256_sra_epi32(lo, shift));
+    sum = AddWidened(sum, _mm256_sra_epi32(hi, shift));
+  }
+  _mm256_storeu_si256((__m256i*)lanes, sum);
+  total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < length; i++) {
+    total += (vector1[i] * vector2[i]) >> scaling;
+  }
+
+  if (total > WEBRTC_SPL_WORD32_MAX)
+    return WEBRTC_SPL_WORD32_MAX;
+  if (total < WEBRTC_SPL_WORD32_MIN)
+    return WEBRTC_SPL_WORD32_MIN;
+  return (int32_t)total;
+}
@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/signal_processing/dot_product_with_scale.h"
+
+#include <emmintrin.h>
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+// Adds the four 32 bit lanes of |terms| to the two 64 bit lanes of |sum|.
+static __m128i AddWidened(__m128i sum, __m128i terms) {
+  const __m128i sign = _mm_srai_epi32(terms, 31);
+  sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(terms, sign));
+  return _mm_add_epi64(sum, _mm_unpackhi_epi32(terms, sign));
+}
+
+int32_t WebRtcSpl_DotProductWithScaleSSE2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling) {
+  // Each product is formed exactly in its own 32 bit lane from the zero
+  // extended samples and shifted, then summed in 64 bits like the C version.
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i shift = _mm_cvtsi32_si128(scaling);
+  __m128i sum = zero;
+  int64_t lanes[2];
+  int64_t total;
+  size_t i = 0;
+
+  for (; i + 8 <= length; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&vector1[i]);
+    __m128i y = _mm_loadu_si128((const __m128i*)&vector2[i]);
+    __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi16(x, zero),
+                                _mm_unpacklo_epi16(y, zero));
+    __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi16(x, zero),
+                                _mm_unpackhi_epi16(y, zero));
+    sum = AddWidened(sum, _mm_sra_epi32(lo, shift));
+    sum = AddWidened(sum, _mm_sra_epi32(hi, shift));
+  }
+  _mm_storeu_si128((__m128i*)lanes, sum);
+  total = lanes[0] + lanes[1];
+  for (; i < length; i++) {
+    total += (vector1[i] * vector2[i]) >> scaling;
+  }
+
+  if (total > WEBRTC_SPL_WORD32_MAX)
+    return WEBRTC_SPL_WORD32_MAX;
+  if (total < WEBRTC_SPL_WORD32_MIN)
+    return WEBRTC_SPL_WORD32_MIN;
+  return (int32_t)total;
+}
@@ -10,16 +10,16 @@
 
 
 /*
- * This file contains the function WebRtcSpl_Energy().
+ * This file contains the function WebRtcSpl_EnergyC().
  * The description header can be found in signal_processing_library.h
  *
  */
 
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 
-int32_t WebRtcSpl_Energy(int16_t* vector,
-                         size_t vector_length,
-                         int* scale_factor)
+int32_t WebRtcSpl_EnergyC(int16_t* vector,
+                          size_t vector_length,
+                          int* scale_factor)
 {
     int32_t en = 0;
     size_t i;
@@ -0,0 +1,91 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+/*
+ * This file contains the function WebRtcSpl_EnergyAVX2(). It is built with
+ * -mavx2 and only called when WebRtc_GetCPUInfo(kAVX2) says so.
+ * The description header can be found in signal_processing_library.h
+ *
+ */
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <immintrin.h>
+
+int32_t WebRtcSpl_EnergyAVX2(int16_t* vector,
+                             size_t vector_length,
+                             int* scale_factor)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i vmax = _mm256_set1_epi16(-1);
+    __m256i sum = zero;
+    __m128i shift;
+    __m128i half;
+    int16_t max_lanes[8];
+    int32_t lanes[4];
+    int32_t en;
+    int16_t nbits = WebRtcSpl_GetSizeInBits((uint32_t)vector_length);
+    int16_t smax = -1;
+    int16_t sabs;
+    int scaling = 0;
+    size_t i;
+    int k;
+
+    // The 16 bit absolute value of -32768 is -32768, as in
+    // WebRtcSpl_GetScalingSquare(), so it never wins.
+    for (i = 0; i + 16 <= vector_length; i += 16)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)&vector[i]);
+        vmax = _mm256_max_epi16(vmax, _mm256_abs_epi16(x));
+    }
+    half = _mm_max_epi16(_mm256_castsi256_si128(vmax),
+                         _mm256_extracti128_si256(vmax, 1));
+    _mm_storeu_si128((__m128i*)max_lanes, half);
+    for (k = 0; k < 8; k++)
+    {
+        smax = (max_lanes[k] > smax ? max_lanes[k] : smax);
+    }
+    for (; i < vector_length; i++)
+    {
+        sabs = (vector[i] > 0 ? vector[i] : -vector[i]);
+        smax = (sabs > smax ? sabs : smax);
+    }
+    if (smax != 0)
+    {
+        int16_t t = WebRtcSpl_NormW32(WEBRTC_SPL_MUL(smax, smax));
+        scaling = (t > nbits) ? 0 : nbits - t;
+    }
+
+    // Squares of the zero extended lanes, one per 32 bit lane.
+    shift = _mm_cvtsi32_si128(scaling);
+    for (i = 0; i + 16 <= vector_length; i += 16)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i*)&vector[i]);
+        __m256i lo = _mm256_unpacklo_epi16(x, zero);
+        __m256i hi = _mm256_unpackhi_epi16(x, zero);
+        sum = _mm256_add_epi32(sum,
+                               _mm256_sra_epi32(_mm256_madd_epi16(lo, lo), shift));
+        sum = _mm256_add_epi32(sum,
+                               _mm256_sra_epi32(_mm256_madd_epi16(hi, hi), shift));
+    }
+    half = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                         _mm256_extracti128_si256(sum, 1));
+    _mm_storeu_si128((__m128i*)lanes, half);
+    en = (int32_t)((uint32_t)lanes[0] + (uint32_t)lanes[1] +
+                   (uint32_t)lanes[2] + (uint32_t)lanes[3]);
+    for (; i < vector_length; i++)
+    {
+        en += (vector[i] * vector[i]) >> scaling;
+    }
+    *scale_factor = scaling;
+
+    return en;
+}
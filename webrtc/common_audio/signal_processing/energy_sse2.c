@@ -0,0 +1,85 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+
+/*
+ * This file contains the function WebRtcSpl_EnergySSE2().
+ * The description header can be found in signal_processing_library.h
+ *
+ */
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+#include <emmintrin.h>
+
+int32_t WebRtcSpl_EnergySSE2(int16_t* vector,
+                             size_t vector_length,
+                             int* scale_factor)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i vmax = _mm_set1_epi16(-1);
+    __m128i sum = zero;
+    __m128i shift;
+    int16_t max_lanes[8];
+    int32_t lanes[4];
+    int32_t en;
+    int16_t nbits = WebRtcSpl_GetSizeInBits((uint32_t)vector_length);
+    int16_t smax = -1;
+    int16_t sabs;
+    int scaling = 0;
+    size_t i;
+    int k;
+
+    // The 16 bit absolute value of -32768 is -32768, as in
+    // WebRtcSpl_GetScalingSquare(), so it never wins.
+    for (i = 0; i + 8 <= vector_length; i += 8)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)&vector[i]);
+        __m128i sign = _mm_srai_epi16(x, 15);
+        vmax = _mm_max_epi16(vmax,
+                             _mm_sub_epi16(_mm_xor_si128(x, sign), sign));
+    }
+    _mm_storeu_si128((__m128i*)max_lanes, vmax);
+    for (k = 0; k < 8; k++)
+    {
+        smax = (max_lanes[k] > smax ? max_lanes[k] : smax);
+    }
+    for (; i < vector_length; i++)
+    {
+        sabs = (vector[i] > 0 ? vector[i] : -vector[i]);
+        smax = (sabs > smax ? sabs : smax);
+    }
+    if (smax != 0)
+    {
+        int16_t t = WebRtcSpl_NormW32(WEBRTC_SPL_MUL(smax, smax));
+        scaling = (t > nbits) ? 0 : nbits - t;
+    }
+
+    // Squares of the zero extended lanes, one per 32 bit lane.
+    shift = _mm_cvtsi32_si128(scaling);
+    for (i = 0; i + 8 <= vector_length; i += 8)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)&vector[i]);
+        __m128i lo = _mm_unpacklo_epi16(x, zero);
+        __m128i hi = _mm_unpackhi_epi16(x, zero);
+        sum = _mm_add_epi32(sum, _mm_sra_epi32(_mm_madd_epi16(lo, lo), shift));
+        sum = _mm_add_epi32(sum, _mm_sra_epi32(_mm_madd_epi16(hi, hi), shift));
+    }
+    _mm_storeu_si128((__m128i*)lanes, sum);
+    en = (int32_t)((uint32_t)lanes[0] + (uint32_t)lanes[1] +
+                   (uint32_t)lanes[2] + (uint32_t)lanes[3]);
+    for (; i < vector_length; i++)
+    {
+        en += (vector[i] * vector[i]) >> scaling;
+    }
+    *scale_factor = scaling;
+
+    return en;
+}
@@ -19,6 +19,7 @@
 
 #include <string.h>
 #include "webrtc/common_audio/signal_processing/dot_product_with_scale.h"
+#include "webrtc/typedefs.h"
 
 // Macros specific for the fixed point implementation
 #define WEBRTC_SPL_WORD16_MAX 32767
@@ -107,6 +108,18 @@ extern "C" {
 // functions.
 void WebRtcSpl_Init(void);
 
+// Implementations the SPL function pointers can be bound to.
+enum {
+  kSplDispatchGeneric = 0,  // Generic C versions.
+  kSplDispatchNative = 1    // Best versions for the platform (the default).
+};
+
+// Rebinds the SPL function pointers to the given |dispatch| implementations,
+// calling WebRtcSpl_Init() first if needed. Meant for tests and benchmarks
+// comparing implementations. It is not safe to call while other threads use
+// SPL functions.
+void WebRtcSpl_SetDispatch(int dispatch);
+
 int16_t WebRtcSpl_GetScalingSquare(int16_t* in_vector,
                                    size_t in_vector_length,
                                    size_t times);
@@ -143,6 +156,12 @@ void WebRtcSpl_ZerosArrayW32(int32_t* vector, size_t vector_length);
 typedef int16_t (*MaxAbsValueW16)(const int16_t* vector, size_t length);
 extern MaxAbsValueW16 WebRtcSpl_MaxAbsValueW16;
 int16_t WebRtcSpl_MaxAbsValueW16C(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MaxAbsValueW16SSE41(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+int16_t WebRtcSpl_MaxAbsValueW16AVX2(const int16_t* vector, size_t length);
+#endif
+#endif
 #if defined(WEBRTC_HAS_NEON)
 int16_t WebRtcSpl_MaxAbsValueW16Neon(const int16_t* vector, size_t length);
 #endif
@@ -160,6 +179,12 @@ int16_t WebRtcSpl_MaxAbsValueW16_mips(const int16_t* vector, size_t length);
 typedef int32_t (*MaxAbsValueW32)(const int32_t* vector, size_t length);
 extern MaxAbsValueW32 WebRtcSpl_MaxAbsValueW32;
 int32_t WebRtcSpl_MaxAbsValueW32C(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MaxAbsValueW32SSE41(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+int32_t WebRtcSpl_MaxAbsValueW32AVX2(const int32_t* vector, size_t length);
+#endif
+#endif
 #if defined(WEBRTC_HAS_NEON)
 int32_t WebRtcSpl_MaxAbsValueW32Neon(const int32_t* vector, size_t length);
 #endif
@@ -177,6 +202,12 @@ int32_t WebRtcSpl_MaxAbsValueW32_mips(const int32_t* vector, size_t length);
 typedef int16_t (*MaxValueW16)(const int16_t* vector, size_t length);
 extern MaxValueW16 WebRtcSpl_MaxValueW16;
 int16_t WebRtcSpl_MaxValueW16C(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MaxValueW16SSE41(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+int16_t WebRtcSpl_MaxValueW16AVX2(const int16_t* vector, size_t length);
+#endif
+#endif
 #if defined(WEBRTC_HAS_NEON)
 int16_t WebRtcSpl_MaxValueW16Neon(const int16_t* vector, size_t length);
 #endif
@@ -194,6 +225,12 @@ int16_t WebRtcSpl_MaxValueW16_mips(const int16_t* vector, size_t length);
 typedef int32_t (*MaxValueW32)(const int32_t* vector, size_t length);
 extern MaxValueW32 WebRtcSpl_MaxValueW32;
 int32_t WebRtcSpl_MaxValueW32C(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MaxValueW32SSE41(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+int32_t WebRtcSpl_MaxValueW32AVX2(const int32_t* vector, size_t length);
+#endif
+#endif
 #if defined(WEBRTC_HAS_NEON)
 int32_t WebRtcSpl_MaxValueW32Neon(const int32_t* vector, size_t length);
 #endif
@@ -211,6 +248,12 @@ int32_t WebRtcSpl_MaxValueW32_mips(const int32_t* vector, size_t length);
 typedef int16_t (*MinValueW16)(const int16_t* vector, size_t length);
 extern MinValueW16 WebRtcSpl_MinValueW16;
 int16_t WebRtcSpl_MinValueW16C(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int16_t WebRtcSpl_MinValueW16SSE41(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+int16_t WebRtcSpl_MinValueW16AVX2(const int16_t* vector, size_t length);
+#endif
+#endif
 #if defined(WEBRTC_HAS_NEON)
 int16_t WebRtcSpl_MinValueW16Neon(const int16_t* vector, size_t length);
 #endif
@@ -228,6 +271,12 @@ int16_t WebRtcSpl_MinValueW16_mips(const int16_t* vector, size_t length);
 typedef int32_t (*MinValueW32)(const int32_t* vector, size_t length);
 extern MinValueW32 WebRtcSpl_MinValueW32;
 int32_t WebRtcSpl_MinValueW32C(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_MinValueW32SSE41(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+int32_t WebRtcSpl_MinValueW32AVX2(const int32_t* vector, size_t length);
+#endif
+#endif
 #if defined(WEBRTC_HAS_NEON)
 int32_t WebRtcSpl_MinValueW32Neon(const int32_t* vector, size_t length);
 #endif
@@ -245,7 +294,18 @@ int32_t WebRtcSpl_MinValueW32_mips(const int32_t* vector, size_t length);
 //                 If there are multiple equal maxima, return the index of the
 //                 first. -32768 will always have precedence over 32767 (despite
 //                 -32768 presenting an int16 absolute value of 32767).
-size_t WebRtcSpl_MaxAbsIndexW16(const int16_t* vector, size_t length);
+//
+// This and the other index functions below are function pointers that start
+// out at the C versions, WebRtcSpl_Init() switches them to SIMD.
+typedef size_t (*MaxAbsIndexW16)(const int16_t* vector, size_t length);
+extern MaxAbsIndexW16 WebRtcSpl_MaxAbsIndexW16;
+size_t WebRtcSpl_MaxAbsIndexW16C(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+size_t WebRtcSpl_MaxAbsIndexW16SSE41(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+size_t WebRtcSpl_MaxAbsIndexW16AVX2(const int16_t* vector, size_t length);
+#endif
+#endif
 
 // Returns the vector index to the maximum sample value of a 16-bit vector.
 //
@@ -255,7 +315,17 @@ size_t WebRtcSpl_MaxAbsIndexW16(const int16_t* vector, size_t length);
 //
 // Return value  : Index to the maximum value in vector (if multiple
 //                 indexes have the maximum, return the first).
-size_t WebRtcSpl_MaxIndexW16(const int16_t* vector, size_t length);
+//
+// Dispatched like WebRtcSpl_MaxAbsIndexW16().
+typedef size_t (*MaxIndexW16)(const int16_t* vector, size_t length);
+extern MaxIndexW16 WebRtcSpl_MaxIndexW16;
+size_t WebRtcSpl_MaxIndexW16C(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+size_t WebRtcSpl_MaxIndexW16SSE41(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+size_t WebRtcSpl_MaxIndexW16AVX2(const int16_t* vector, size_t length);
+#endif
+#endif
 
 // Returns the vector index to the maximum sample value of a 32-bit vector.
 //
@@ -265,7 +335,17 @@ size_t WebRtcSpl_MaxIndexW16(const int16_t* vector, size_t length);
 //
 // Return value  : Index to the maximum value in vector (if multiple
 //                 indexes have the maximum, return the first).
-size_t WebRtcSpl_MaxIndexW32(const int32_t* vector, size_t length);
+//
+// Dispatched like WebRtcSpl_MaxAbsIndexW16().
+typedef size_t (*MaxIndexW32)(const int32_t* vector, size_t length);
+extern MaxIndexW32 WebRtcSpl_MaxIndexW32;
+size_t WebRtcSpl_MaxIndexW32C(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+size_t WebRtcSpl_MaxIndexW32SSE41(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+size_t WebRtcSpl_MaxIndexW32AVX2(const int32_t* vector, size_t length);
+#endif
+#endif
 
 // Returns the vector index to the minimum sample value of a 16-bit vector.
 //
@@ -275,7 +355,17 @@ size_t WebRtcSpl_MaxIndexW32(const int32_t* vector, size_t length);
 //
 // Return value  : Index to the mimimum value in vector  (if multiple
 //                 indexes have the minimum, return the first).
-size_t WebRtcSpl_MinIndexW16(const int16_t* vector, size_t length);
+//
+// Dispatched like WebRtcSpl_MaxAbsIndexW16().
+typedef size_t (*MinIndexW16)(const int16_t* vector, size_t length);
+extern MinIndexW16 WebRtcSpl_MinIndexW16;
+size_t WebRtcSpl_MinIndexW16C(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+size_t WebRtcSpl_MinIndexW16SSE41(const int16_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+size_t WebRtcSpl_MinIndexW16AVX2(const int16_t* vector, size_t length);
+#endif
+#endif
 
 // Returns the vector index to the minimum sample value of a 32-bit vector.
 //
@@ -285,7 +375,17 @@ size_t WebRtcSpl_MinIndexW16(const int16_t* vector, size_t length);
 //
 // Return value  : Index to the mimimum value in vector  (if multiple
 //                 indexes have the minimum, return the first).
-size_t WebRtcSpl_MinIndexW32(const int32_t* vector, size_t length);
+//
+// Dispatched like WebRtcSpl_MaxAbsIndexW16().
+typedef size_t (*MinIndexW32)(const int32_t* vector, size_t length);
+extern MinIndexW32 WebRtcSpl_MinIndexW32;
+size_t WebRtcSpl_MinIndexW32C(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+size_t WebRtcSpl_MinIndexW32SSE41(const int32_t* vector, size_t length);
+#if defined(WEBRTC_ENABLE_AVX2)
+size_t WebRtcSpl_MinIndexW32AVX2(const int32_t* vector, size_t length);
+#endif
+#endif
 
 // End: Minimum and maximum operations.
 
@@ -507,6 +607,9 @@ void WebRtcSpl_AutoCorrToReflCoef(const int32_t* auto_corr,
 //
 // Output:
 //      - cross_correlation : The cross-correlation in Q(-right_shifts)
+//
+// The pointer starts out at WebRtcSpl_CrossCorrelationC(), WebRtcSpl_Init()
+// switches it to SIMD.
 typedef void (*CrossCorrelation)(int32_t* cross_correlation,
                                  const int16_t* seq1,
                                  const int16_t* seq2,
@@ -522,6 +625,24 @@ void WebRtcSpl_CrossCorrelationC(int32_t* cross_correlation,
                                  size_t dim_cross_correlation,
                                  int right_shifts,
                                  int step_seq2);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2);
+#if defined(WEBRTC_ENABLE_AVX2)
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2);
+#endif
+#endif
 #if defined(WEBRTC_HAS_NEON)
 void WebRtcSpl_CrossCorrelationNeon(int32_t* cross_correlation,
                                     const int16_t* seq1,
@@ -586,9 +707,28 @@ int32_t WebRtcSpl_DivResultInQ31(int32_t num, int32_t den);
 int32_t WebRtcSpl_DivW32HiLow(int32_t num, int16_t den_hi, int16_t den_low);
 // End: Divisions.
 
-int32_t WebRtcSpl_Energy(int16_t* vector,
-                         size_t vector_length,
-                         int* scale_factor);
+// Energy of a vector, see the description at the bottom of the file. The
+// SIMD versions compute the scaling and the sum in one call, bit exact with
+// WebRtcSpl_GetScalingSquare() followed by the shifted sum of squares.
+// Implementations in energy.c, energy_sse2.c and energy_avx2.c. The pointer
+// starts out at WebRtcSpl_EnergyC(), WebRtcSpl_Init() switches it to SIMD.
+typedef int32_t (*Energy)(int16_t* vector,
+                          size_t vector_length,
+                          int* scale_factor);
+extern Energy WebRtcSpl_Energy;
+int32_t WebRtcSpl_EnergyC(int16_t* vector,
+                          size_t vector_length,
+                          int* scale_factor);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_EnergySSE2(int16_t* vector,
+                             size_t vector_length,
+                             int* scale_factor);
+#if defined(WEBRTC_ENABLE_AVX2)
+int32_t WebRtcSpl_EnergyAVX2(int16_t* vector,
+                             size_t vector_length,
+                             int* scale_factor);
+#endif
+#endif
 
 // Filter operations.
 size_t WebRtcSpl_FilterAR(const int16_t* ar_coef,
@@ -856,8 +996,83 @@ void WebRtcSpl_Resample48khzTo8khz(const int16_t* in,
                                    WebRtcSpl_State48khzTo8khz* state,
                                    int32_t* tmpmem);
 
+// Resamples |blocks| consecutive 10 ms blocks of 480 samples from |in| to
+// 80 samples each in |out|, running each filter stage once over all of them.
+// The output and the state are the same as after |blocks| calls of
+// WebRtcSpl_Resample48khzTo8khz(). |tmpmem| needs 16 + 480 * |blocks| words,
+// which need not be initialized.
+void WebRtcSpl_Resample48khzTo8khzBlocks(const int16_t* in,
+                                         size_t blocks,
+                                         int16_t* out,
+                                         WebRtcSpl_State48khzTo8khz* state,
+                                         int32_t* tmpmem);
+
 void WebRtcSpl_ResetResample48khzTo8khz(WebRtcSpl_State48khzTo8khz* state);
 
+/*******************************************************************
+ * resample_48khz_lanes.c
+ *
+ * 48 kHz -> 8 kHz for kResampleLanes independent streams at once.
+ *
+ ******************************************************************/
+
+// Number of streams one WebRtcSpl_Resample48khzTo8khzLanes() call handles.
+enum { kResampleLanes = 8 };
+
+// Length, in int32_t, of the |tmpmem| WebRtcSpl_Resample48khzTo8khzLanes()
+// needs: kResampleLanes times what WebRtcSpl_Resample48khzTo8khz() needs.
+enum { kResample48khzTo8khzLanesMem = (480 + 256) * kResampleLanes };
+
+// The states of kResampleLanes WebRtcSpl_State48khzTo8khz, lane interleaved:
+// word |k| of stream |lane| is at [k * kResampleLanes + lane].
+typedef struct {
+  int32_t S_48_24[8 * kResampleLanes];
+  int32_t S_24_24[16 * kResampleLanes];
+  int32_t S_24_16[8 * kResampleLanes];
+  int32_t S_16_8[8 * kResampleLanes];
+} WebRtcSpl_State48khzTo8khzLanes;
+
+// Resamples one 10 ms frame of each of kResampleLanes streams from 48 kHz to
+// 8 kHz. Stream |lane| reads 480 samples from |in[lane]| and writes 80 samples
+// to |out[lane]|. The output is bit exact with kResampleLanes separate
+// WebRtcSpl_Resample48khzTo8khz() calls. The filter states serialize along
+// time within a stream, so the SIMD versions put the streams in vector lanes.
+//
+// Input:
+//      - in             : kResampleLanes pointers to 480 samples each
+//      - state          : Lane interleaved filter states
+//      - tmpmem         : Scratch, kResample48khzTo8khzLanesMem long
+//
+// Output:
+//      - out            : kResampleLanes pointers to 80 samples each
+typedef void (*Resample48khzTo8khzLanes)(
+    const int16_t* const* in,
+    int16_t* const* out,
+    WebRtcSpl_State48khzTo8khzLanes* state,
+    int32_t* tmpmem);
+extern Resample48khzTo8khzLanes WebRtcSpl_Resample48khzTo8khzLanes;
+void WebRtcSpl_Resample48khzTo8khzLanesC(const int16_t* const* in,
+                                         int16_t* const* out,
+                                         WebRtcSpl_State48khzTo8khzLanes* state,
+                                         int32_t* tmpmem);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void WebRtcSpl_Resample48khzTo8khzLanesSSE41(
+    const int16_t* const* in,
+    int16_t* const* out,
+    WebRtcSpl_State48khzTo8khzLanes* state,
+    int32_t* tmpmem);
+#if defined(WEBRTC_ENABLE_AVX2)
+void WebRtcSpl_Resample48khzTo8khzLanesAVX2(
+    const int16_t* const* in,
+    int16_t* const* out,
+    WebRtcSpl_State48khzTo8khzLanes* state,
+    int32_t* tmpmem);
+#endif
+#endif
+
+void WebRtcSpl_ResetResample48khzTo8khzLanes(
+    WebRtcSpl_State48khzTo8khzLanes* state);
+
 typedef struct {
   int32_t S_8_16[8];
   int32_t S_16_12[8];
@@ -16,14 +16,15 @@
  * WebRtcSpl_MaxValueW32C()
  * WebRtcSpl_MinValueW16C()
  * WebRtcSpl_MinValueW32C()
- * WebRtcSpl_MaxAbsIndexW16()
- * WebRtcSpl_MaxIndexW16()
- * WebRtcSpl_MaxIndexW32()
- * WebRtcSpl_MinIndexW16()
- * WebRtcSpl_MinIndexW32()
+ * WebRtcSpl_MaxAbsIndexW16C()
+ * WebRtcSpl_MaxIndexW16C()
+ * WebRtcSpl_MaxIndexW32C()
+ * WebRtcSpl_MinIndexW16C()
+ * WebRtcSpl_MinIndexW32C()
  *
  */
 
+#include <limits.h>
 #include <stdlib.h>
 
 #include "webrtc/rtc_base/checks.h"
@@ -32,6 +33,8 @@
 // TODO(bjorn/kma): Consolidate function pairs (e.g. combine
 //   WebRtcSpl_MaxAbsValueW16C and WebRtcSpl_MaxAbsIndexW16 into a single one.)
 // TODO(kma): Move the next six functions into min_max_operations_c.c.
+// The x86 versions are in min_max_operations_sse41.c and
+// min_max_operations_avx2.c.
 
 // Maximum absolute value of word16 vector. C version for generic platforms.
 int16_t WebRtcSpl_MaxAbsValueW16C(const int16_t* vector, size_t length) {
@@ -67,7 +70,8 @@ int32_t WebRtcSpl_MaxAbsValueW32C(const int32_t* vector, size_t length) {
   RTC_DCHECK_GT(length, 0);
 
   for (i = 0; i < length; i++) {
-    absolute = abs((int)vector[i]);
+    absolute =
+        (vector[i] != INT_MIN) ? abs((int)vector[i]) : INT_MAX + (uint32_t)1;
     if (absolute > maximum) {
       maximum = absolute;
     }
@@ -135,7 +139,7 @@ int32_t WebRtcSpl_MinValueW32C(const int32_t* vector, size_t length) {
 }
 
 // Index of maximum absolute value in a word16 vector.
-size_t WebRtcSpl_MaxAbsIndexW16(const int16_t* vector, size_t length) {
+size_t WebRtcSpl_MaxAbsIndexW16C(const int16_t* vector, size_t length) {
   // Use type int for local variables, to accomodate the value of abs(-32768).
 
   size_t i = 0, index = 0;
@@ -156,7 +160,7 @@ size_t WebRtcSpl_MaxAbsIndexW16(const int16_t* vector, size_t length) {
 }
 
 // Index of maximum value in a word16 vector.
-size_t WebRtcSpl_MaxIndexW16(const int16_t* vector, size_t length) {
+size_t WebRtcSpl_MaxIndexW16C(const int16_t* vector, size_t length) {
   size_t i = 0, index = 0;
   int16_t maximum = WEBRTC_SPL_WORD16_MIN;
 
@@ -173,7 +177,7 @@ size_t WebRtcSpl_MaxIndexW16(const int16_t* vector, size_t length) {
 }
 
 // Index of maximum value in a word32 vector.
-size_t WebRtcSpl_MaxIndexW32(const int32_t* vector, size_t length) {
+size_t WebRtcSpl_MaxIndexW32C(const int32_t* vector, size_t length) {
   size_t i = 0, index = 0;
   int32_t maximum = WEBRTC_SPL_WORD32_MIN;
 
@@ -190,7 +194,7 @@ size_t WebRtcSpl_MaxIndexW32(const int32_t* vector, size_t length) {
 }
 
 // Index of minimum value in a word16 vector.
-size_t WebRtcSpl_MinIndexW16(const int16_t* vector, size_t length) {
+size_t WebRtcSpl_MinIndexW16C(const int16_t* vector, size_t length) {
   size_t i = 0, index = 0;
   int16_t minimum = WEBRTC_SPL_WORD16_MAX;
 
@@ -207,7 +211,7 @@ size_t WebRtcSpl_MinIndexW16(const int16_t* vector, size_t length) {
 }
 
 // Index of minimum value in a word32 vector.
-size_t WebRtcSpl_MinIndexW32(const int32_t* vector, size_t length) {
+size_t WebRtcSpl_MinIndexW32C(const int32_t* vector, size_t length) {
   size_t i = 0, index = 0;
   int32_t minimum = WEBRTC_SPL_WORD32_MAX;
 
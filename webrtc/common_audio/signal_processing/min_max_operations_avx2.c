@@ -0,0 +1,319 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the implementation of functions
+ * WebRtcSpl_MaxAbsValueW16AVX2()
+ * WebRtcSpl_MaxAbsValueW32AVX2()
+ * WebRtcSpl_MaxValueW16AVX2()
+ * WebRtcSpl_MaxValueW32AVX2()
+ * WebRtcSpl_MinValueW16AVX2()
+ * WebRtcSpl_MinValueW32AVX2()
+ * WebRtcSpl_MaxAbsIndexW16AVX2()
+ * WebRtcSpl_MaxIndexW16AVX2()
+ * WebRtcSpl_MaxIndexW32AVX2()
+ * WebRtcSpl_MinIndexW16AVX2()
+ * WebRtcSpl_MinIndexW32AVX2()
+ *
+ * It is built with -mavx2 and only called when WebRtc_GetCPUInfo(kAVX2) says
+ * so. The structure follows min_max_operations_sse41.c with 256 bit loads;
+ * the lanes are folded to 128 bits before the horizontal reduction.
+ */
+
+#include <limits.h>
+#include <stdlib.h>
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "webrtc/rtc_base/checks.h"
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+// Index of the lowest set bit of a non-zero |mask|.
+static int LowestBit(int mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, (unsigned long)mask);
+  return (int)index;
+#else
+  return __builtin_ctz((unsigned int)mask);
+#endif
+}
+
+// Largest lane of |v| as unsigned 16 bit. PHMINPOSUW on the complement.
+static uint16_t MaxLaneU16(__m128i v) {
+  const __m128i ones = _mm_set1_epi16(-1);
+  return (uint16_t)~_mm_extract_epi16(
+      _mm_minpos_epu16(_mm_xor_si128(v, ones)), 0);
+}
+
+// Largest absolute value of |vector| as unsigned, i.e. 32768 for -32768.
+static uint16_t MaxAbsW16(const int16_t* vector, size_t length) {
+  __m256i vmax = _mm256_setzero_si256();
+  uint16_t maximum;
+  uint16_t absolute;
+  size_t i = 0;
+
+  for (; i + 16 <= length; i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    vmax = _mm256_max_epu16(vmax, _mm256_abs_epi16(x));
+  }
+  maximum = MaxLaneU16(_mm_max_epu16(_mm256_castsi256_si128(vmax),
+                                     _mm256_extracti128_si256(vmax, 1)));
+  for (; i < length; i++) {
+    absolute = (uint16_t)abs((int)vector[i]);
+    if (absolute > maximum) {
+      maximum = absolute;
+    }
+  }
+  return maximum;
+}
+
+// Index of the first element of |vector| whose absolute value is |value|, or
+// 0 if there is none.
+static size_t FindAbsW16(const int16_t* vector, size_t length, uint16_t value) {
+  const __m256i target = _mm256_set1_epi16((int16_t)value);
+  size_t i = 0;
+  int mask;
+
+  for (; i + 16 <= length; i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    mask = _mm256_movemask_epi8(
+        _mm256_cmpeq_epi16(_mm256_abs_epi16(x), target));
+    if (mask != 0) {
+      return i + (LowestBit(mask) >> 1);
+    }
+  }
+  for (; i < length; i++) {
+    if ((uint16_t)abs((int)vector[i]) == value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+// Index of the first element of |vector| equal to |value|, or 0.
+static size_t FindW16(const int16_t* vector, size_t length, int16_t value) {
+  const __m256i target = _mm256_set1_epi16(value);
+  size_t i = 0;
+  int mask;
+
+  for (; i + 16 <= length; i += 16) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    mask = _mm256_movemask_epi8(_mm256_cmpeq_epi16(x, target));
+    if (mask != 0) {
+      return i + (LowestBit(mask) >> 1);
+    }
+  }
+  for (; i < length; i++) {
+    if (vector[i] == value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+// Index of the first element of |vector| equal to |value|, or 0.
+static size_t FindW32(const int32_t* vector, size_t length, int32_t value) {
+  const __m256i target = _mm256_set1_epi32(value);
+  size_t i = 0;
+  int mask;
+
+  for (; i + 8 <= length; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    mask = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_cmpeq_epi32(x, target)));
+    if (mask != 0) {
+      return i + LowestBit(mask);
+    }
+  }
+  for (; i < length; i++) {
+    if (vector[i] == value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+int16_t WebRtcSpl_MaxAbsValueW16AVX2(const int16_t* vector, size_t length) {
+  uint16_t maximum;
+
+  RTC_DCHECK_GT(length, 0);
+
+  maximum = MaxAbsW16(vector, length);
+
+  // Guard the case for abs(-32768).
+  if (maximum > WEBRTC_SPL_WORD16_MAX) {
+    maximum = WEBRTC_SPL_WORD16_MAX;
+  }
+
+  return (int16_t)maximum;
+}
+
+int32_t WebRtcSpl_MaxAbsValueW32AVX2(const int32_t* vector, size_t length) {
+  // The absolute values are compared as unsigned, to accommodate
+  // abs(0x80000000), which is 0x80000000.
+  __m256i wide = _mm256_setzero_si256();
+  __m128i vmax;
+  uint32_t absolute = 0, maximum = 0;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 8 <= length; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)&vector[i]);
+    wide = _mm256_max_epu32(wide, _mm256_abs_epi32(x));
+  }
+  vmax = _mm_max_epu32(_mm256_castsi256_si128(wide),
+                       _mm256_extracti128_si256(wide, 1));
+  vmax = _mm_max_epu32(vmax, _mm_shuffle_epi32(vmax, 0x4E));
+  vmax = _mm_max_epu32(vmax, _mm_shuffle_epi32(vmax, 0xB1));
+  maximum = (uint32_t)_mm_cvtsi128_si32(vmax);
+  for (; i < length; i++) {
+    absolute =
+        (vector[i] != INT_MIN) ? abs((int)vector[i]) : INT_MAX + (uint32_t)1;
+    if (absolute > maximum) {
+      maximum = absolute;
+    }
+  }
+
+  maximum = WEBRTC_SPL_MIN(maximum, WEBRTC_SPL_WORD32_MAX);
+
+  return (int32_t)maximum;
+}
+
+int16_t WebRtcSpl_MaxValueW16AVX2(const int16_t* vector, size_t length) {
+  // Offsetting by 0x8000 maps the signed order onto the unsigned one.
+  const __m128i offset = _mm_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  __m256i wide = _mm256_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  __m128i vmax;
+  int16_t maximum;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 16 <= length; i += 16) {
+    wide = _mm256_max_epi16(wide,
+                            _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  vmax = _mm_max_epi16(_mm256_castsi256_si128(wide),
+                       _mm256_extracti128_si256(wide, 1));
+  maximum = (int16_t)(MaxLaneU16(_mm_xor_si128(vmax, offset)) ^ 0x8000);
+  for (; i < length; i++) {
+    if (vector[i] > maximum)
+      maximum = vector[i];
+  }
+  return maximum;
+}
+
+int32_t WebRtcSpl_MaxValueW32AVX2(const int32_t* vector, size_t length) {
+  __m256i wide = _mm256_set1_epi32(WEBRTC_SPL_WORD32_MIN);
+  __m128i vmax;
+  int32_t maximum;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 8 <= length; i += 8) {
+    wide = _mm256_max_epi32(wide,
+                            _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  vmax = _mm_max_epi32(_mm256_castsi256_si128(wide),
+                       _mm256_extracti128_si256(wide, 1));
+  vmax = _mm_max_epi32(vmax, _mm_shuffle_epi32(vmax, 0x4E));
+  vmax = _mm_max_epi32(vmax, _mm_shuffle_epi32(vmax, 0xB1));
+  maximum = _mm_cvtsi128_si32(vmax);
+  for (; i < length; i++) {
+    if (vector[i] > maximum)
+      maximum = vector[i];
+  }
+  return maximum;
+}
+
+int16_t WebRtcSpl_MinValueW16AVX2(const int16_t* vector, size_t length) {
+  const __m128i offset = _mm_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  __m256i wide = _mm256_set1_epi16(WEBRTC_SPL_WORD16_MAX);
+  __m128i vmin;
+  int16_t minimum;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 16 <= length; i += 16) {
+    wide = _mm256_min_epi16(wide,
+                            _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  vmin = _mm_min_epi16(_mm256_castsi256_si128(wide),
+                       _mm256_extracti128_si256(wide, 1));
+  minimum = (int16_t)(_mm_extract_epi16(
+      _mm_minpos_epu16(_mm_xor_si128(vmin, offset)), 0) ^ 0x8000);
+  for (; i < length; i++) {
+    if (vector[i] < minimum)
+      minimum = vector[i];
+  }
+  return minimum;
+}
+
+int32_t WebRtcSpl_MinValueW32AVX2(const int32_t* vector, size_t length) {
+  __m256i wide = _mm256_set1_epi32(WEBRTC_SPL_WORD32_MAX);
+  __m128i vmin;
+  int32_t minimum;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 8 <= length; i += 8) {
+    wide = _mm256_min_epi32(wide,
+                            _mm256_loadu_si256((const __m256i*)&vector[i]));
+  }
+  vmin = _mm_min_epi32(_mm256_castsi256_si128(wide),
+                       _mm256_extracti128_si256(wide, 1));
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, 0x4E));
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, 0xB1));
+  minimum = _mm_cvtsi128_si32(vmin);
+  for (; i < length; i++) {
+    if (vector[i] < minimum)
+      minimum = vector[i];
+  }
+  return minimum;
+}
+
+size_t WebRtcSpl_MaxAbsIndexW16AVX2(const int16_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  // Unlike WebRtcSpl_MaxAbsValueW16, -32768 keeps its precedence here.
+  return FindAbsW16(vector, length, MaxAbsW16(vector, length));
+}
+
+size_t WebRtcSpl_MaxIndexW16AVX2(const int16_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  return FindW16(vector, length, WebRtcSpl_MaxValueW16AVX2(vector, length));
+}
+
+size_t WebRtcSpl_MaxIndexW32AVX2(const int32_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  return FindW32(vector, length, WebRtcSpl_MaxValueW32AVX2(vector, length));
+}
+
+size_t WebRtcSpl_MinIndexW16AVX2(const int16_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  return FindW16(vector, length, WebRtcSpl_MinValueW16AVX2(vector, length));
+}
+
+size_t WebRtcSpl_MinIndexW32AVX2(const int32_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  return FindW32(vector, length, WebRtcSpl_MinValueW32AVX2(vector, length));
+}
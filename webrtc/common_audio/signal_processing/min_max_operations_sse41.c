@@ -0,0 +1,299 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the implementation of functions
+ * WebRtcSpl_MaxAbsValueW16SSE41()
+ * WebRtcSpl_MaxAbsValueW32SSE41()
+ * WebRtcSpl_MaxValueW16SSE41()
+ * WebRtcSpl_MaxValueW32SSE41()
+ * WebRtcSpl_MinValueW16SSE41()
+ * WebRtcSpl_MinValueW32SSE41()
+ * WebRtcSpl_MaxAbsIndexW16SSE41()
+ * WebRtcSpl_MaxIndexW16SSE41()
+ * WebRtcSpl_MaxIndexW32SSE41()
+ * WebRtcSpl_MinIndexW16SSE41()
+ * WebRtcSpl_MinIndexW32SSE41()
+ *
+ * It is built with -msse4.1 and only called when WebRtc_GetCPUInfo(kSSE4_1)
+ * says so. The results are identical to the C versions in
+ * min_max_operations.c, including the first-occurrence rule of the index
+ * functions: those first find the extreme value and then scan for the first
+ * element that holds it.
+ */
+
+#include <limits.h>
+#include <stdlib.h>
+
+#include <smmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "webrtc/rtc_base/checks.h"
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+// Index of the lowest set bit of a non-zero |mask|.
+static int LowestBit(int mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, (unsigned long)mask);
+  return (int)index;
+#else
+  return __builtin_ctz((unsigned int)mask);
+#endif
+}
+
+// Largest lane of |v| as unsigned 16 bit. PHMINPOSUW on the complement.
+static uint16_t MaxLaneU16(__m128i v) {
+  const __m128i ones = _mm_set1_epi16(-1);
+  return (uint16_t)~_mm_extract_epi16(
+      _mm_minpos_epu16(_mm_xor_si128(v, ones)), 0);
+}
+
+// Largest absolute value of |vector| as unsigned, i.e. 32768 for -32768.
+static uint16_t MaxAbsW16(const int16_t* vector, size_t length) {
+  __m128i vmax = _mm_setzero_si128();
+  uint16_t maximum;
+  uint16_t absolute;
+  size_t i = 0;
+
+  for (; i + 8 <= length; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&vector[i]);
+    vmax = _mm_max_epu16(vmax, _mm_abs_epi16(x));
+  }
+  maximum = MaxLaneU16(vmax);
+  for (; i < length; i++) {
+    absolute = (uint16_t)abs((int)vector[i]);
+    if (absolute > maximum) {
+      maximum = absolute;
+    }
+  }
+  return maximum;
+}
+
+// Index of the first element of |vector| whose absolute value is |value|, or
+// 0 if there is none.
+static size_t FindAbsW16(const int16_t* vector, size_t length, uint16_t value) {
+  const __m128i target = _mm_set1_epi16((int16_t)value);
+  size_t i = 0;
+  int mask;
+
+  for (; i + 8 <= length; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&vector[i]);
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_abs_epi16(x), target));
+    if (mask != 0) {
+      return i + (LowestBit(mask) >> 1);
+    }
+  }
+  for (; i < length; i++) {
+    if ((uint16_t)abs((int)vector[i]) == value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+// Index of the first element of |vector| equal to |value|, or 0.
+static size_t FindW16(const int16_t* vector, size_t length, int16_t value) {
+  const __m128i target = _mm_set1_epi16(value);
+  size_t i = 0;
+  int mask;
+
+  for (; i + 8 <= length; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&vector[i]);
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi16(x, target));
+    if (mask != 0) {
+      return i + (LowestBit(mask) >> 1);
+    }
+  }
+  for (; i < length; i++) {
+    if (vector[i] == value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+// Index of the first element of |vector| equal to |value|, or 0.
+static size_t FindW32(const int32_t* vector, size_t length, int32_t value) {
+  const __m128i target = _mm_set1_epi32(value);
+  size_t i = 0;
+  int mask;
+
+  for (; i + 4 <= length; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&vector[i]);
+    mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(x, target)));
+    if (mask != 0) {
+      return i + LowestBit(mask);
+    }
+  }
+  for (; i < length; i++) {
+    if (vector[i] == value) {
+      return i;
+    }
+  }
+  return 0;
+}
+
+int16_t WebRtcSpl_MaxAbsValueW16SSE41(const int16_t* vector, size_t length) {
+  uint16_t maximum;
+
+  RTC_DCHECK_GT(length, 0);
+
+  maximum = MaxAbsW16(vector, length);
+
+  // Guard the case for abs(-32768).
+  if (maximum > WEBRTC_SPL_WORD16_MAX) {
+    maximum = WEBRTC_SPL_WORD16_MAX;
+  }
+
+  return (int16_t)maximum;
+}
+
+int32_t WebRtcSpl_MaxAbsValueW32SSE41(const int32_t* vector, size_t length) {
+  // The absolute values are compared as unsigned, to accommodate
+  // abs(0x80000000), which is 0x80000000.
+  __m128i vmax = _mm_setzero_si128();
+  uint32_t absolute = 0, maximum = 0;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 4 <= length; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*)&vector[i]);
+    vmax = _mm_max_epu32(vmax, _mm_abs_epi32(x));
+  }
+  vmax = _mm_max_epu32(vmax, _mm_shuffle_epi32(vmax, 0x4E));
+  vmax = _mm_max_epu32(vmax, _mm_shuffle_epi32(vmax, 0xB1));
+  maximum = (uint32_t)_mm_cvtsi128_si32(vmax);
+  for (; i < length; i++) {
+    absolute =
+        (vector[i] != INT_MIN) ? abs((int)vector[i]) : INT_MAX + (uint32_t)1;
+    if (absolute > maximum) {
+      maximum = absolute;
+    }
+  }
+
+  maximum = WEBRTC_SPL_MIN(maximum, WEBRTC_SPL_WORD32_MAX);
+
+  return (int32_t)maximum;
+}
+
+int16_t WebRtcSpl_MaxValueW16SSE41(const int16_t* vector, size_t length) {
+  // Offsetting by 0x8000 maps the signed order onto the unsigned one.
+  const __m128i offset = _mm_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  __m128i vmax = _mm_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  int16_t maximum;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 8 <= length; i += 8) {
+    vmax = _mm_max_epi16(vmax, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  maximum = (int16_t)(MaxLaneU16(_mm_xor_si128(vmax, offset)) ^ 0x8000);
+  for (; i < length; i++) {
+    if (vector[i] > maximum)
+      maximum = vector[i];
+  }
+  return maximum;
+}
+
+int32_t WebRtcSpl_MaxValueW32SSE41(const int32_t* vector, size_t length) {
+  __m128i vmax = _mm_set1_epi32(WEBRTC_SPL_WORD32_MIN);
+  int32_t maximum;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 4 <= length; i += 4) {
+    vmax = _mm_max_epi32(vmax, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  vmax = _mm_max_epi32(vmax, _mm_shuffle_epi32(vmax, 0x4E));
+  vmax = _mm_max_epi32(vmax, _mm_shuffle_epi32(vmax, 0xB1));
+  maximum = _mm_cvtsi128_si32(vmax);
+  for (; i < length; i++) {
+    if (vector[i] > maximum)
+      maximum = vector[i];
+  }
+  return maximum;
+}
+
+int16_t WebRtcSpl_MinValueW16SSE41(const int16_t* vector, size_t length) {
+  const __m128i offset = _mm_set1_epi16(WEBRTC_SPL_WORD16_MIN);
+  __m128i vmin = _mm_set1_epi16(WEBRTC_SPL_WORD16_MAX);
+  int16_t minimum;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 8 <= length; i += 8) {
+    vmin = _mm_min_epi16(vmin, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  minimum = (int16_t)(_mm_extract_epi16(
+      _mm_minpos_epu16(_mm_xor_si128(vmin, offset)), 0) ^ 0x8000);
+  for (; i < length; i++) {
+    if (vector[i] < minimum)
+      minimum = vector[i];
+  }
+  return minimum;
+}
+
+int32_t WebRtcSpl_MinValueW32SSE41(const int32_t* vector, size_t length) {
+  __m128i vmin = _mm_set1_epi32(WEBRTC_SPL_WORD32_MAX);
+  int32_t minimum;
+  size_t i = 0;
+
+  RTC_DCHECK_GT(length, 0);
+
+  for (; i + 4 <= length; i += 4) {
+    vmin = _mm_min_epi32(vmin, _mm_loadu_si128((const __m128i*)&vector[i]));
+  }
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, 0x4E));
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, 0xB1));
+  minimum = _mm_cvtsi128_si32(vmin);
+  for (; i < length; i++) {
+    if (vector[i] < minimum)
+      minimum = vector[i];
+  }
+  return minimum;
+}
+
+size_t WebRtcSpl_MaxAbsIndexW16SSE41(const int16_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  // Unlike WebRtcSpl_MaxAbsValueW16, -32768 keeps its precedence here.
+  return FindAbsW16(vector, length, MaxAbsW16(vector, length));
+}
+
+size_t WebRtcSpl_MaxIndexW16SSE41(const int16_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  return FindW16(vector, length, WebRtcSpl_MaxValueW16SSE41(vector, length));
+}
+
+size_t WebRtcSpl_MaxIndexW32SSE41(const int32_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  return FindW32(vector, length, WebRtcSpl_MaxValueW32SSE41(vector, length));
+}
+
+size_t WebRtcSpl_MinIndexW16SSE41(const int16_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  return FindW16(vector, length, WebRtcSpl_MinValueW16SSE41(vector, length));
+}
+
+size_t WebRtcSpl_MinIndexW32SSE41(const int32_t* vector, size_t length) {
+  RTC_DCHECK_GT(length, 0);
+
+  return FindW32(vector, length, WebRtcSpl_MinValueW32SSE41(vector, length));
+}
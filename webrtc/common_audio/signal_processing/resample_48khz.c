@@ -103,32 +103,42 @@ void WebRtcSpl_ResetResample16khzTo48khz(WebRtcSpl_State16khzTo48khz* state)
 void WebRtcSpl_Resample48khzTo8khz(const int16_t* in, int16_t* out,
                                    WebRtcSpl_State48khzTo8khz* state, int32_t* tmpmem)
 {
+    WebRtcSpl_Resample48khzTo8khzBlocks(in, 1, out, state, tmpmem);
+}
+
+// 48 -> 8 resampler, |blocks| consecutive 10 ms blocks per stage
+void WebRtcSpl_Resample48khzTo8khzBlocks(const int16_t* in, size_t blocks, int16_t* out,
+                                         WebRtcSpl_State48khzTo8khz* state, int32_t* tmpmem)
+{
+    // Samples per block at 24 kHz.
+    const int32_t len24 = (int32_t)(240 * blocks);
+
     ///// 48 --> 24 /////
-    // int16_t  in[480]
-    // int32_t out[240]
+    // int16_t  in[480 * blocks]
+    // int32_t out[240 * blocks]
     /////
-    WebRtcSpl_DownBy2ShortToInt(in, 480, tmpmem + 256, state->S_48_24);
+    WebRtcSpl_DownBy2ShortToInt(in, 2 * len24, tmpmem + 16 + len24, state->S_48_24);
 
     ///// 24 --> 24(LP) /////
-    // int32_t  in[240]
-    // int32_t out[240]
+    // int32_t  in[240 * blocks]
+    // int32_t out[240 * blocks]
     /////
-    WebRtcSpl_LPBy2IntToInt(tmpmem + 256, 240, tmpmem + 16, state->S_24_24);
+    WebRtcSpl_LPBy2IntToInt(tmpmem + 16 + len24, len24, tmpmem + 16, state->S_24_24);
 
     ///// 24 --> 16 /////
-    // int32_t  in[240]
-    // int32_t out[160]
+    // int32_t  in[240 * blocks]
+    // int32_t out[160 * blocks]
     /////
     // copy state to and from input array
     memcpy(tmpmem + 8, state->S_24_16, 8 * sizeof(int32_t));
-    memcpy(state->S_24_16, tmpmem + 248, 8 * sizeof(int32_t));
-    WebRtcSpl_Resample48khzTo32khz(tmpmem + 8, tmpmem, 80);
+    memcpy(state->S_24_16, tmpmem + 8 + len24, 8 * sizeof(int32_t));
+    WebRtcSpl_Resample48khzTo32khz(tmpmem + 8, tmpmem, 80 * blocks);
 
     ///// 16 --> 8 /////
-    // int32_t  in[160]
-    // int16_t out[80]
+    // int32_t  in[160 * blocks]
+    // int16_t out[80 * blocks]
     /////
-    WebRtcSpl_DownBy2IntToShort(tmpmem, 160, out, state->S_16_8);
+    WebRtcSpl_DownBy2IntToShort(tmpmem, (int32_t)(160 * blocks), out, state->S_16_8);
 }
 
 // initialize state of 48 -> 8 resampler
@@ -0,0 +1,66 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the generic C version of the multi-stream 48 kHz ->
+ * 8 kHz resampler, WebRtcSpl_Resample48khzTo8khzLanesC(), and its reset
+ * function. The C version runs the single-stream resampler once per lane; the
+ * SSE4.1 and AVX2 versions are in resample_48khz_lanes_sse41.c and
+ * resample_48khz_lanes_avx2.c.
+ */
+
+#include <string.h>
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+// Copies the words of stream |lane| out of the lane interleaved |lanes|.
+static void GetLane(const int32_t* lanes, int lane, int32_t* words,
+                    size_t num_words) {
+  size_t k;
+  for (k = 0; k < num_words; k++) {
+    words[k] = lanes[k * kResampleLanes + lane];
+  }
+}
+
+// Copies the words of stream |lane| into the lane interleaved |lanes|.
+static void SetLane(const int32_t* words, size_t num_words, int lane,
+                    int32_t* lanes) {
+  size_t k;
+  for (k = 0; k < num_words; k++) {
+    lanes[k * kResampleLanes + lane] = words[k];
+  }
+}
+
+void WebRtcSpl_Resample48khzTo8khzLanesC(const int16_t* const* in,
+                                         int16_t* const* out,
+                                         WebRtcSpl_State48khzTo8khzLanes* state,
+                                         int32_t* tmpmem) {
+  WebRtcSpl_State48khzTo8khz lane_state;
+  int lane;
+
+  for (lane = 0; lane < kResampleLanes; lane++) {
+    GetLane(state->S_48_24, lane, lane_state.S_48_24, 8);
+    GetLane(state->S_24_24, lane, lane_state.S_24_24, 16);
+    GetLane(state->S_24_16, lane, lane_state.S_24_16, 8);
+    GetLane(state->S_16_8, lane, lane_state.S_16_8, 8);
+
+    WebRtcSpl_Resample48khzTo8khz(in[lane], out[lane], &lane_state, tmpmem);
+
+    SetLane(lane_state.S_48_24, 8, lane, state->S_48_24);
+    SetLane(lane_state.S_24_24, 16, lane, state->S_24_24);
+    SetLane(lane_state.S_24_16, 8, lane, state->S_24_16);
+    SetLane(lane_state.S_16_8, 8, lane, state->S_16_8);
+  }
+}
+
+void WebRtcSpl_ResetResample48khzTo8khzLanes(
+    WebRtcSpl_State48khzTo8khzLanes* state) {
+  memset(state, 0, sizeof(*state));
+}
@@ -0,0 +1,263 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file contains the function WebRtcSpl_Resample48khzTo8khzLanesAVX2().
+ * The description header can be found in signal_processing_library.h
+ *
+ * It is built with -mavx2 and only called when WebRtc_GetCPUInfo(kAVX2) says
+ * so. It is resample_48khz_lanes_sse41.c with all kResampleLanes streams in
+ * one register, so each stage runs once instead of once per half.
+ */
+
+#include <immintrin.h>
+#include <string.h>
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+// Rows of 16 bit samples in |tmpmem|, after the 496 rows the filters use.
+// They hold the transposed input, and then the output.
+enum { kShortRows = 496 * kResampleLanes };
+
+static __m256i LoadRow(const int32_t* row) {
+  return _mm256_loadu_si256((const __m256i*)row);
+}
+
+static void StoreRow(int32_t* row, __m256i v) {
+  _mm256_storeu_si256((__m256i*)row, v);
+}
+
+// Transposes the 8x8 block of 16 bit words in |r|.
+static void Transpose8x8(__m128i* r) {
+  __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+  __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+  __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+  __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+  __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+  __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+  __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+  __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+  __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+  __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+  __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+  __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+  __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+  __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+  __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+  __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+  r[0] = _mm_unpacklo_epi64(b0, b4);
+  r[1] = _mm_unpackhi_epi64(b0, b4);
+  r[2] = _mm_unpacklo_epi64(b1, b5);
+  r[3] = _mm_unpackhi_epi64(b1, b5);
+  r[4] = _mm_unpacklo_epi64(b2, b6);
+  r[5] = _mm_unpackhi_epi64(b2, b6);
+  r[6] = _mm_unpacklo_epi64(b3, b7);
+  r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// Scales down by 14 bits, rounding towards zero the way the C code does:
+// (diff >> 14) + 1 for negative |diff|.
+static __m256i Truncate14(__m256i diff) {
+  return _mm256_add_epi32(_mm256_srai_epi32(diff, 14),
+                          _mm256_srli_epi32(diff, 31));
+}
+
+// One cascade of three allpass sections of resample_by_2_internal.c, fed with
+// |x|. |s| holds the four state words and |c| the coefficients.
+static __m256i Allpass(__m256i x, __m256i* s, const __m256i* c) {
+  const __m256i round = _mm256_set1_epi32(1 << 13);
+  __m256i diff;
+  __m256i tmp0;
+  __m256i tmp1;
+
+  diff = _mm256_srai_epi32(
+      _mm256_add_epi32(_mm256_sub_epi32(x, s[1]), round), 14);
+  tmp1 = _mm256_add_epi32(s[0], _mm256_mullo_epi32(diff, c[0]));
+  s[0] = x;
+  diff = Truncate14(_mm256_sub_epi32(tmp1, s[2]));
+  tmp0 = _mm256_add_epi32(s[1], _mm256_mullo_epi32(diff, c[1]));
+  s[1] = tmp1;
+  diff = Truncate14(_mm256_sub_epi32(tmp0, s[3]));
+  s[3] = _mm256_add_epi32(s[2], _mm256_mullo_epi32(diff, c[2]));
+  s[2] = tmp0;
+  return s[3];
+}
+
+static void LoadState(const int32_t* state, __m256i* s, int num_words) {
+  int k;
+  for (k = 0; k < num_words; k++) {
+    s[k] = LoadRow(&state[k * kResampleLanes]);
+  }
+}
+
+static void StoreState(const __m256i* s, int num_words, int32_t* state) {
+  int k;
+  for (k = 0; k < num_words; k++) {
+    StoreRow(&state[k * kResampleLanes], s[k]);
+  }
+}
+
+static void InitCoefficients(__m256i* lower, __m256i* upper) {
+  lower[0] = _mm256_set1_epi32(3050);
+  lower[1] = _mm256_set1_epi32(9368);
+  lower[2] = _mm256_set1_epi32(15063);
+  upper[0] = _mm256_set1_epi32(821);
+  upper[1] = _mm256_set1_epi32(6110);
+  upper[2] = _mm256_set1_epi32(12382);
+}
+
+// WebRtcSpl_DownBy2ShortToInt(), 480 rows to 240.
+static void DownBy2ShortToInt(const int16_t* in, int32_t* out,
+                              int32_t* state) {
+  const __m256i offset = _mm256_set1_epi32(1 << 14);
+  __m256i lower[3], upper[3];
+  __m256i s[8];
+  __m256i x0, x1;
+  int i;
+
+  InitCoefficients(lower, upper);
+  LoadState(state, s, 8);
+  for (i = 0; i < 240; i++) {
+    x0 = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*)&in[(2 * i) * kResampleLanes]));
+    x1 = _mm256_cvtepi16_epi32(
+        _mm_loadu_si128((const __m128i*)&in[(2 * i + 1) * kResampleLanes]));
+    x0 = _mm256_add_epi32(_mm256_slli_epi32(x0, 15), offset);
+    x1 = _mm256_add_epi32(_mm256_slli_epi32(x1, 15), offset);
+    x0 = Allpass(x0, &s[0], lower);
+    x1 = Allpass(x1, &s[4], upper);
+    x0 = _mm256_add_epi32(_mm256_srai_epi32(x0, 1), _mm256_srai_epi32(x1, 1));
+    StoreRow(&out[i * kResampleLanes], x0);
+  }
+  StoreState(s, 8, state);
+}
+
+// WebRtcSpl_LPBy2IntToInt(), 240 rows to 240. The lower filter of the even
+// outputs is fed with the previous odd input, which is what the upper filter
+// of the odd outputs holds in its first state word.
+static void LPBy2IntToInt(const int32_t* in, int32_t* out, int32_t* state) {
+  __m256i lower[3], upper[3];
+  __m256i s[16];
+  __m256i even, odd, y0, y1;
+  int i;
+
+  InitCoefficients(lower, upper);
+  LoadState(state, s, 16);
+  for (i = 0; i < 120; i++) {
+    even = LoadRow(&in[(2 * i) * kResampleLanes]);
+    odd = LoadRow(&in[(2 * i + 1) * kResampleLanes]);
+    y0 = _mm256_srai_epi32(Allpass(s[12], &s[0], lower), 1);
+    y1 = _mm256_srai_epi32(Allpass(even, &s[4], upper), 1);
+    StoreRow(&out[(2 * i) * kResampleLanes],
+             _mm256_srai_epi32(_mm256_add_epi32(y0, y1), 15));
+    y0 = _mm256_srai_epi32(Allpass(even, &s[8], lower), 1);
+    y1 = _mm256_srai_epi32(Allpass(odd, &s[12], upper), 1);
+    StoreRow(&out[(2 * i + 1) * kResampleLanes],
+             _mm256_srai_epi32(_mm256_add_epi32(y0, y1), 15));
+  }
+  StoreState(s, 16, state);
+}
+
+// WebRtcSpl_Resample48khzTo32khz() with K = 80, 248 rows to 160.
+static void Resample48khzTo32khz(const int32_t* in, int32_t* out) {
+  static const int16_t kCoefficients[2][8] = {
+      {778, -2050, 1087, 23285, 12903, -3783, 441, 222},
+      {222, 441, -3783, 12903, 23285, 1087, -2050, 778}};
+  const __m256i offset = _mm256_set1_epi32(1 << 14);
+  __m256i c0[8], c1[8];
+  __m256i x[9];
+  __m256i y0, y1;
+  int m, k;
+
+  for (k = 0; k < 8; k++) {
+    c0[k] = _mm256_set1_epi32(kCoefficients[0][k]);
+    c1[k] = _mm256_set1_epi32(kCoefficients[1][k]);
+  }
+  for (m = 0; m < 80; m++) {
+    for (k = 0; k < 9; k++) {
+      x[k] = LoadRow(&in[(3 * m + k) * kResampleLanes]);
+    }
+    y0 = offset;
+    y1 = offset;
+    for (k = 0; k < 8; k++) {
+      y0 = _mm256_add_epi32(y0, _mm256_mullo_epi32(c0[k], x[k]));
+      y1 = _mm256_add_epi32(y1, _mm256_mullo_epi32(c1[k], x[k + 1]));
+    }
+    StoreRow(&out[(2 * m) * kResampleLanes], y0);
+    StoreRow(&out[(2 * m + 1) * kResampleLanes], y1);
+  }
+}
+
+// WebRtcSpl_DownBy2IntToShort(), 160 rows to 80, saturated to 16 bits.
+static void DownBy2IntToShort(const int32_t* in, int16_t* out,
+                              int32_t* state) {
+  __m256i lower[3], upper[3];
+  __m256i s[8];
+  __m256i y0, y1;
+  int i;
+
+  InitCoefficients(lower, upper);
+  LoadState(state, s, 8);
+  for (i = 0; i < 80; i++) {
+    y0 = Allpass(LoadRow(&in[(2 * i) * kResampleLanes]), &s[0], lower);
+    y1 = Allpass(LoadRow(&in[(2 * i + 1) * kResampleLanes]), &s[4], upper);
+    y0 = _mm256_add_epi32(_mm256_srai_epi32(y0, 1), _mm256_srai_epi32(y1, 1));
+    y0 = _mm256_srai_epi32(y0, 15);
+    _mm_storeu_si128((__m128i*)&out[i * kResampleLanes],
+                     _mm_packs_epi32(_mm256_castsi256_si128(y0),
+                                     _mm256_extracti128_si256(y0, 1)));
+  }
+  StoreState(s, 8, state);
+}
+
+void WebRtcSpl_Resample48khzTo8khzLanesAVX2(
+    const int16_t* const* in,
+    int16_t* const* out,
+    WebRtcSpl_State48khzTo8khzLanes* state,
+    int32_t* tmpmem) {
+  int16_t* rows = (int16_t*)&tmpmem[kShortRows];
+  __m128i r[8];
+  int block, lane;
+
+  // Transpose the input to one row of kResampleLanes samples per instant.
+  for (block = 0; block < 480; block += 8) {
+    for (lane = 0; lane < kResampleLanes; lane++) {
+      r[lane] = _mm_loadu_si128((const __m128i*)&in[lane][block]);
+    }
+    Transpose8x8(r);
+    for (lane = 0; lane < 8; lane++) {
+      _mm_storeu_si128((__m128i*)&rows[(block + lane) * kResampleLanes],
+                       r[lane]);
+    }
+  }
+
+  // The output overwrites the first 80 input rows, which are consumed.
+  DownBy2ShortToInt(rows, tmpmem + 256 * kResampleLanes, state->S_48_24);
+  LPBy2IntToInt(tmpmem + 256 * kResampleLanes, tmpmem + 16 * kResampleLanes,
+                state->S_24_24);
+  // Copy state to and from the input rows, as the C version does.
+  memcpy(tmpmem + 8 * kResampleLanes, state->S_24_16, sizeof(state->S_24_16));
+  memcpy(state->S_24_16, tmpmem + 248 * kResampleLanes,
+         sizeof(state->S_24_16));
+  Resample48khzTo32khz(tmpmem + 8 * kResampleLanes, tmpmem);
+  DownBy2IntToShort(tmpmem, rows, state->S_16_8);
+
+  // Transpose the output back to the streams.
+  for (block = 0; block < 80; block += 8) {
+    for (lane = 0; lane < 8; lane++) {
+      r[lane] = _mm_loadu_si128(
+          (const __m128i*)&rows[(block + lane) * kResampleLanes]);
+    }
+    Transpose8x8(r);
+    for (lane = 0; lane < kResampleLanes; lane++) {
+      _mm_storeu_si128((__m128i*)&out[lane][block], r[lane]);
+    }
+  }
+}
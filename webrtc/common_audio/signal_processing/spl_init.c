@@ -9,26 +9,36 @@
  */
 
 /* The global function contained in this file initializes SPL function
- * pointers, currently only for ARM platforms.
+ * pointers for ARM, MIPS and x86 platforms.
  *
  * Some code came from common/rtcd.c in the WebM project.
  */
 
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#include "webrtc/common_audio/signal_processing/dot_product_with_scale.h"
 #include "webrtc/system_wrappers/include/cpu_features_wrapper.h"
 
-/* Declare function pointers. */
+/* Declare function pointers. Those that used to be plain functions, and
+ * those WebRtcVad_Periodicity() uses, start out at their C versions, so they
+ * work before WebRtcSpl_Init(). */
 MaxAbsValueW16 WebRtcSpl_MaxAbsValueW16;
 MaxAbsValueW32 WebRtcSpl_MaxAbsValueW32;
 MaxValueW16 WebRtcSpl_MaxValueW16;
 MaxValueW32 WebRtcSpl_MaxValueW32;
 MinValueW16 WebRtcSpl_MinValueW16;
 MinValueW32 WebRtcSpl_MinValueW32;
-CrossCorrelation WebRtcSpl_CrossCorrelation;
+CrossCorrelation WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationC;
 DownsampleFast WebRtcSpl_DownsampleFast;
 ScaleAndAddVectorsWithRound WebRtcSpl_ScaleAndAddVectorsWithRound;
+Energy WebRtcSpl_Energy = WebRtcSpl_EnergyC;
+MaxAbsIndexW16 WebRtcSpl_MaxAbsIndexW16 = WebRtcSpl_MaxAbsIndexW16C;
+MaxIndexW16 WebRtcSpl_MaxIndexW16 = WebRtcSpl_MaxIndexW16C;
+MaxIndexW32 WebRtcSpl_MaxIndexW32 = WebRtcSpl_MaxIndexW32C;
+MinIndexW16 WebRtcSpl_MinIndexW16 = WebRtcSpl_MinIndexW16C;
+MinIndexW32 WebRtcSpl_MinIndexW32 = WebRtcSpl_MinIndexW32C;
+DotProductWithScale WebRtcSpl_DotProductWithScale = WebRtcSpl_DotProductWithScaleC;
+Resample48khzTo8khzLanes WebRtcSpl_Resample48khzTo8khzLanes;
 
-#if (!defined(WEBRTC_HAS_NEON)) && !defined(MIPS32_LE)
 /* Initialize function pointers to the generic C version. */
 static void InitPointersToC(void) {
   WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16C;
@@ -41,6 +51,61 @@ static void InitPointersToC(void) {
   WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastC;
   WebRtcSpl_ScaleAndAddVectorsWithRound =
       WebRtcSpl_ScaleAndAddVectorsWithRoundC;
+  WebRtcSpl_Energy = WebRtcSpl_EnergyC;
+  WebRtcSpl_MaxAbsIndexW16 = WebRtcSpl_MaxAbsIndexW16C;
+  WebRtcSpl_MaxIndexW16 = WebRtcSpl_MaxIndexW16C;
+  WebRtcSpl_MaxIndexW32 = WebRtcSpl_MaxIndexW32C;
+  WebRtcSpl_MinIndexW16 = WebRtcSpl_MinIndexW16C;
+  WebRtcSpl_MinIndexW32 = WebRtcSpl_MinIndexW32C;
+  WebRtcSpl_DotProductWithScale = WebRtcSpl_DotProductWithScaleC;
+  WebRtcSpl_Resample48khzTo8khzLanes = WebRtcSpl_Resample48khzTo8khzLanesC;
+}
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+/* Initialize function pointers to the SSE2, SSE4.1 and AVX2 versions the
+ * CPU supports, the generic C versions otherwise. */
+static void InitPointersToX86(void) {
+  InitPointersToC();
+  if (WebRtc_GetCPUInfo(kSSE2)) {
+    WebRtcSpl_Energy = WebRtcSpl_EnergySSE2;
+    WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationSSE2;
+    WebRtcSpl_DotProductWithScale = WebRtcSpl_DotProductWithScaleSSE2;
+  }
+  if (WebRtc_GetCPUInfo(kSSE4_1)) {
+    WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16SSE41;
+    WebRtcSpl_MaxAbsValueW32 = WebRtcSpl_MaxAbsValueW32SSE41;
+    WebRtcSpl_MaxValueW16 = WebRtcSpl_MaxValueW16SSE41;
+    WebRtcSpl_MaxValueW32 = WebRtcSpl_MaxValueW32SSE41;
+    WebRtcSpl_MinValueW16 = WebRtcSpl_MinValueW16SSE41;
+    WebRtcSpl_MinValueW32 = WebRtcSpl_MinValueW32SSE41;
+    WebRtcSpl_MaxAbsIndexW16 = WebRtcSpl_MaxAbsIndexW16SSE41;
+    WebRtcSpl_MaxIndexW16 = WebRtcSpl_MaxIndexW16SSE41;
+    WebRtcSpl_MaxIndexW32 = WebRtcSpl_MaxIndexW32SSE41;
+    WebRtcSpl_MinIndexW16 = WebRtcSpl_MinIndexW16SSE41;
+    WebRtcSpl_MinIndexW32 = WebRtcSpl_MinIndexW32SSE41;
+    WebRtcSpl_Resample48khzTo8khzLanes =
+        WebRtcSpl_Resample48khzTo8khzLanesSSE41;
+  }
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2)) {
+    WebRtcSpl_Energy = WebRtcSpl_EnergyAVX2;
+    WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationAVX2;
+    WebRtcSpl_DotProductWithScale = WebRtcSpl_DotProductWithScaleAVX2;
+    WebRtcSpl_MaxAbsValueW16 = WebRtcSpl_MaxAbsValueW16AVX2;
+    WebRtcSpl_MaxAbsValueW32 = WebRtcSpl_MaxAbsValueW32AVX2;
+    WebRtcSpl_MaxValueW16 = WebRtcSpl_MaxValueW16AVX2;
+    WebRtcSpl_MaxValueW32 = WebRtcSpl_MaxValueW32AVX2;
+    WebRtcSpl_MinValueW16 = WebRtcSpl_MinValueW16AVX2;
+    WebRtcSpl_MinValueW32 = WebRtcSpl_MinValueW32AVX2;
+    WebRtcSpl_MaxAbsIndexW16 = WebRtcSpl_MaxAbsIndexW16AVX2;
+    WebRtcSpl_MaxIndexW16 = WebRtcSpl_MaxIndexW16AVX2;
+    WebRtcSpl_MaxIndexW32 = WebRtcSpl_MaxIndexW32AVX2;
+    WebRtcSpl_MinIndexW16 = WebRtcSpl_MinIndexW16AVX2;
+    WebRtcSpl_MinIndexW32 = WebRtcSpl_MinIndexW32AVX2;
+    WebRtcSpl_Resample48khzTo8khzLanes =
+        WebRtcSpl_Resample48khzTo8khzLanesAVX2;
+  }
+#endif
 }
 #endif
 
@@ -57,6 +122,14 @@ static void InitPointersToNeon(void) {
   WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastNeon;
   WebRtcSpl_ScaleAndAddVectorsWithRound =
       WebRtcSpl_ScaleAndAddVectorsWithRoundC;
+  WebRtcSpl_Energy = WebRtcSpl_EnergyC;
+  WebRtcSpl_MaxAbsIndexW16 = WebRtcSpl_MaxAbsIndexW16C;
+  WebRtcSpl_MaxIndexW16 = WebRtcSpl_MaxIndexW16C;
+  WebRtcSpl_MaxIndexW32 = WebRtcSpl_MaxIndexW32C;
+  WebRtcSpl_MinIndexW16 = WebRtcSpl_MinIndexW16C;
+  WebRtcSpl_MinIndexW32 = WebRtcSpl_MinIndexW32C;
+  WebRtcSpl_DotProductWithScale = WebRtcSpl_DotProductWithScaleC;
+  WebRtcSpl_Resample48khzTo8khzLanes = WebRtcSpl_Resample48khzTo8khzLanesC;
 }
 #endif
 
@@ -70,6 +143,14 @@ static void InitPointersToMIPS(void) {
   WebRtcSpl_MinValueW32 = WebRtcSpl_MinValueW32_mips;
   WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelation_mips;
   WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFast_mips;
+  WebRtcSpl_Energy = WebRtcSpl_EnergyC;
+  WebRtcSpl_MaxAbsIndexW16 = WebRtcSpl_MaxAbsIndexW16C;
+  WebRtcSpl_MaxIndexW16 = WebRtcSpl_MaxIndexW16C;
+  WebRtcSpl_MaxIndexW32 = WebRtcSpl_MaxIndexW32C;
+  WebRtcSpl_MinIndexW16 = WebRtcSpl_MinIndexW16C;
+  WebRtcSpl_MinIndexW32 = WebRtcSpl_MinIndexW32C;
+  WebRtcSpl_DotProductWithScale = WebRtcSpl_DotProductWithScaleC;
+  WebRtcSpl_Resample48khzTo8khzLanes = WebRtcSpl_Resample48khzTo8khzLanesC;
 #if defined(MIPS_DSP_R1_LE)
   WebRtcSpl_MaxAbsValueW32 = WebRtcSpl_MaxAbsValueW32_mips;
   WebRtcSpl_ScaleAndAddVectorsWithRound =
@@ -87,6 +168,8 @@ static void InitFunctionPointers(void) {
   InitPointersToNeon();
 #elif defined(MIPS32_LE)
   InitPointersToMIPS();
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+  InitPointersToX86();
 #else
   InitPointersToC();
 #endif  /* WEBRTC_HAS_NEON */
@@ -131,3 +214,12 @@ static void once(void (*func)(void)) {
 void WebRtcSpl_Init(void) {
   once(InitFunctionPointers);
 }
+
+void WebRtcSpl_SetDispatch(int dispatch) {
+  WebRtcSpl_Init();
+  if (dispatch == kSplDispatchGeneric) {
+    InitPointersToC();
+  } else {
+    InitFunctionPointers();
+  }
+}
@@ -20,6 +20,62 @@
 #include <stdint.h>
 
 typedef struct WebRtcVadInst VadInst;
+typedef struct WebRtcVadPool VadPool;
+
+// Adapted models of a VAD instance, see WebRtcVad_GetNoiseProfile().
+enum { kVadNoiseProfileVersion = 1 };
+enum { kVadNoiseProfileChannels = 6 };
+enum { kVadNoiseProfileGaussians = 2 * kVadNoiseProfileChannels };
+
+typedef struct {
+  int16_t version;  // kVadNoiseProfileVersion.
+  // Noise and speech GMMs, first Gaussian of each channel followed by the
+  // second (Q7). The speech model adapts along with the noise model, and a
+  // noise model is only meaningful together with it.
+  int16_t noise_means[kVadNoiseProfileGaussians];
+  int16_t noise_stds[kVadNoiseProfileGaussians];
+  int16_t speech_means[kVadNoiseProfileGaussians];
+  int16_t speech_stds[kVadNoiseProfileGaussians];
+  // Smoothed noise floor of each channel (Q4).
+  int16_t noise_floor[kVadNoiseProfileChannels];
+  // Number of frames the profile was adapted over.
+  int32_t frame_count;
+} WebRtcVadNoiseProfile;
+
+// Spectral features of the last frame, see WebRtcVad_EnableSpectralFeatures().
+typedef struct {
+  // 10 * log10 of the energy in the bands of the GMM features, 80 - 250,
+  // 250 - 500, 500 - 1000, 1000 - 2000, 2000 - 3000 and 3000 - 4000 Hz (Q4).
+  int16_t band_energy[kVadNoiseProfileChannels];
+  // Spectral flatness from 80 to 4000 Hz, geometric over arithmetic mean of
+  // the power spectrum (Q14). Close to 0 for tones, about 0.56 for white
+  // noise.
+  int16_t flatness;
+} WebRtcVadSpectralFeatures;
+
+// Implementations of the filterbank and the GMM, see WebRtcVad_SetEngine().
+enum {
+  kVadEngineFixed = 0,  // Fixed point, the reference (default).
+  kVadEngineFloat = 1   // Single precision float.
+};
+
+// Stages measured when built with WEBRTC_VAD_PROFILING.
+enum {
+  kVadStageProcess = 0,  // WebRtcVad_Process().
+  kVadStageFeatures,     // WebRtcVad_CalculateFeatures().
+  kVadStageGmm,          // WebRtcVad_GmmProbability().
+  kVadStageSpectral,     // WebRtcVad_SpectralFeatures(), if enabled.
+  kVadStageRead,         // Reading the wav file in vadSplit(), global only.
+  kVadStageWrite,        // Writing the chunks in vadSplit(), global only.
+  kVadNumStages
+};
+
+// Snapshot of the stage counters. |ticks| are in units of the time stamp
+// counter on x86, the virtual counter on ARM64 and nanoseconds elsewhere.
+typedef struct {
+  uint64_t calls[kVadNumStages];
+  uint64_t ticks[kVadNumStages];
+} WebRtcVadProfile;
 
 #ifdef __cplusplus
 extern "C" {
@@ -41,6 +97,79 @@ void WebRtcVad_Free(VadInst* handle);
 //                 -1 - (null pointer or Default mode could not be set).
 int WebRtcVad_Init(VadInst* handle);
 
+// Resets the adapted state of a VAD instance (noise and speech models,
+// minimum tracking and filter states) to its initial values, keeping the
+// aggressiveness mode. Much cheaper than WebRtcVad_Init().
+//
+// - handle [i/o] : VAD instance. Needs to be initialized by WebRtcVad_Init()
+//                  before call.
+//
+// returns        : 0 - (OK),
+//                 -1 - (null pointer or the VAD instance has not been
+//                       initialized).
+int WebRtcVad_Reset(VadInst* handle);
+
+// Copies the models a VAD instance has adapted so far, e.g. at the end
+// of a call, to seed later instances on the same site or channel with
+// WebRtcVad_SetNoiseProfile().
+//
+// - handle  [i] : VAD instance. Needs to be initialized by WebRtcVad_Init()
+//                 before call.
+// - profile [o] : Noise profile.
+//
+// returns       : 0 - (OK),
+//                -1 - (null pointer, the VAD instance has not been
+//                      initialized or uses the float engine).
+int WebRtcVad_GetNoiseProfile(const VadInst* handle,
+                              WebRtcVadNoiseProfile* profile);
+
+// Starts a VAD instance from a stored noise profile instead of the built-in
+// models, which cuts the adaptation transient at the start of a stream.
+// Call it after WebRtcVad_Init() and before the first frame.
+//
+// - handle  [i/o] : VAD instance. Needs to be initialized by WebRtcVad_Init()
+//                   before call.
+// - profile [i]   : Noise profile from WebRtcVad_GetNoiseProfile().
+//
+// returns         : 0 - (OK),
+//                  -1 - (null pointer, the VAD instance has not been
+//                        initialized or uses the float engine, unknown
+//                        version or invalid values).
+int WebRtcVad_SetNoiseProfile(VadInst* handle,
+                              const WebRtcVadNoiseProfile* profile);
+
+// Returns the size in bytes of a snapshot of a VAD instance.
+size_t WebRtcVad_SnapshotSize(void);
+
+// Serializes the complete state of a VAD instance, including its mode, into a
+// versioned, little endian binary snapshot, which WebRtcVad_Restore() can
+// load into another instance, also in another process or on another machine.
+//
+// - handle [i] : VAD instance. Needs to be initialized by WebRtcVad_Init()
+//                before call.
+// - buffer [o] : Snapshot.
+// - size   [i] : Size of |buffer| in bytes, at least WebRtcVad_SnapshotSize().
+//
+// returns      : Number of bytes written,
+//               -1 - (null pointer, the VAD instance has not been initialized
+//                     or uses the float engine, or |buffer| is too small).
+int WebRtcVad_Snapshot(const VadInst* handle, uint8_t* buffer, size_t size);
+
+// Loads a snapshot taken by WebRtcVad_Snapshot() into a VAD instance. The
+// instance needs no WebRtcVad_Init() before call; everything the snapshot
+// does not hold is then set as by WebRtcVad_Init(). It uses the fixed point
+// engine after. A snapshot with values WebRtcVad_SetNoiseProfile() would
+// refuse, or with the thresholds of no mode, leaves the instance unchanged.
+//
+// - handle [o] : VAD instance.
+// - buffer [i] : Snapshot.
+// - size   [i] : Size of |buffer| in bytes.
+//
+// returns      : 0 - (OK),
+//               -1 - (null pointer, truncated snapshot, unknown format or
+//                     invalid values).
+int WebRtcVad_Restore(VadInst* handle, const uint8_t* buffer, size_t size);
+
 // Sets the VAD operating mode. A more aggressive (higher mode) VAD is more
 // restrictive in reporting speech. Put in other words the probability of being
 // speech when the VAD returns 1 is increased with increasing mode. As a
@@ -54,6 +183,117 @@ int WebRtcVad_Init(VadInst* handle);
 //                       has not been initialized).
 int WebRtcVad_set_mode(VadInst* handle, int mode);
 
+// Enables a gate in WebRtcVad_Process() for silent frames, those with no
+// sample above |threshold| in absolute value. A silent frame is processed as
+// digital silence. Once the filters have come to rest on it, further silent
+// frames skip the filterbank and reuse the features of the last frame, so
+// only the hangover logic runs. With |threshold| 0 only exact zeros are taken
+// and the decisions are bit exact with the gate disabled. Reset by
+// WebRtcVad_Init(), kept by WebRtcVad_Reset().
+//
+// - handle    [i/o] : VAD instance. Needs to be initialized by
+//                     WebRtcVad_Init() before call.
+// - threshold [i]   : Largest absolute sample value of a silent frame
+//                     (0 - 32767), or -1 to disable the gate (default).
+//
+// returns           : 0 - (OK),
+//                    -1 - (null pointer, |threshold| out of range or the VAD
+//                          instance has not been initialized).
+int WebRtcVad_SetSilenceThreshold(VadInst* handle, int threshold);
+
+// Makes WebRtcVad_Process() compute spectral features of every frame along
+// with the filterbank features of the GMM, from the same frame resampled to
+// 8 kHz, with a 256 point fixed point FFT. They do not change the decisions.
+// Reset by WebRtcVad_Init(), kept by WebRtcVad_Reset().
+//
+// - handle [i/o] : VAD instance. Needs to be initialized by WebRtcVad_Init()
+//                  before call.
+// - enable [i]   : 1 to compute the spectral features, 0 not to (default).
+//
+// returns        : 0 - (OK),
+//                 -1 - (null pointer or the VAD instance has not been
+//                       initialized).
+int WebRtcVad_EnableSpectralFeatures(VadInst* handle, int enable);
+
+// Sets whether WebRtcVad_Process() reports the hangover as active voice. After
+// speech the VAD keeps returning 1 for up to 140 ms (10 ms frames in mode 0)
+// to bridge short pauses. A caller with a hangover of its own, such as an
+// endpointer, can disable it to learn about the end of speech sooner. The
+// adaptive state is the same either way. Reset by WebRtcVad_Init(), kept by
+// WebRtcVad_Reset().
+//
+// - handle [i/o] : VAD instance. Needs to be initialized by WebRtcVad_Init()
+//                  before call.
+// - enable [i]   : 1 to report the hangover (default), 0 not to.
+//
+// returns        : 0 - (OK),
+//                 -1 - (null pointer or the VAD instance has not been
+//                       initialized).
+int WebRtcVad_EnableHangover(VadInst* handle, int enable);
+
+// Copies the spectral features of the last frame processed. All zero before
+// the first frame and after WebRtcVad_Reset(). Frames skipped by the silence
+// gate keep the features of the frame before.
+//
+// - handle   [i] : VAD instance with spectral features enabled.
+// - features [o] : Spectral features.
+//
+// returns        : 0 - (OK),
+//                 -1 - (null pointer, the VAD instance has not been
+//                       initialized or has no spectral features enabled).
+int WebRtcVad_GetSpectralFeatures(const VadInst* handle,
+                                  WebRtcVadSpectralFeatures* features);
+
+// Selects the implementation of the filterbank and the GMM. The float engine
+// runs the same filters and models as the fixed point one, in single
+// precision float with exact logarithms and exponentials instead of their Q
+// format approximations. Its decisions are not bit exact with the fixed point
+// engine; they agree on about 94% of the frames of the test corpus, see the
+// README. The resamplers in front of them are the same. Both engines have
+// their own adaptive state, so changing the engine resets it as
+// WebRtcVad_Reset() does. An instance with the float engine has no snapshot
+// and no noise profile. Reset by WebRtcVad_Init(), kept by WebRtcVad_Reset().
+//
+// - handle [i/o] : VAD instance. Needs to be initialized by WebRtcVad_Init()
+//                  before call.
+// - engine [i]   : kVadEngineFixed (default) or kVadEngineFloat.
+//
+// returns        : 0 - (OK),
+//                 -1 - (null pointer, unknown engine or the VAD instance has
+//                       not been initialized).
+int WebRtcVad_SetEngine(VadInst* handle, int engine);
+
+// Returns the size in bytes of the scratch memory WebRtcVad_Process() needs,
+// for use with WebRtcVad_SetWorkspace().
+size_t WebRtcVad_WorkspaceSize(void);
+
+// Lets WebRtcVad_Process() use |workspace| for its scratch memory (the
+// resampled frame, the filterbank outputs and the resampler work area), about
+// 6 kB. Without a workspace the scratch memory is on the stack, only as much
+// as the rate and the engine need: under 1 kB at 8 kHz, about 1.5 kB at 16
+// and 32 kHz and 3 kB at 48 kHz or with the float engine, where 48 kHz frames
+// are resampled 10 ms at a time. Nothing is kept in the workspace between
+// calls, so instances processed on the same thread can share one. The
+// workspace has to outlive its use by the instance. Reset by WebRtcVad_Init(),
+// kept by WebRtcVad_Reset().
+//
+// - handle    [i/o] : VAD instance. Needs to be initialized by
+//                     WebRtcVad_Init() before call.
+// - workspace [i]   : Scratch memory, 4 byte aligned, or NULL to go back to
+//                     the stack (default).
+// - size      [i]   : Size of |workspace| in bytes, at least
+//                     WebRtcVad_WorkspaceSize().
+//
+// returns           : 0 - (OK),
+//                    -1 - (null pointer, |workspace| too small or misaligned
+//                          or the VAD instance has not been initialized).
+int WebRtcVad_SetWorkspace(VadInst* handle, void* workspace, size_t size);
+
+// Returns the number of frames the silence gate has skipped since the last
+// WebRtcVad_Init() or WebRtcVad_Reset(), -1 on a null pointer or an
+// uninitialized VAD instance.
+int64_t WebRtcVad_SilentFrames(const VadInst* handle);
+
 // Calculates a VAD decision for the |audio_frame|. For valid sampling rates
 // frame lengths, see the description of WebRtcVad_ValidRatesAndFrameLengths().
 //
@@ -71,6 +311,67 @@ int WebRtcVad_Process(VadInst* handle,
                       const int16_t* audio_frame,
                       size_t frame_length);
 
+// Processes one frame of the format checked by WebRtcVad_Configure(), see
+// there. Returns the same as WebRtcVad_Process().
+typedef int (*WebRtcVadProcessFn)(VadInst* handle, const int16_t* audio_frame);
+
+// Checks the VAD instance, the sampling frequency and the frame length of a
+// stream once, instead of with every frame as WebRtcVad_Process() does, and
+// returns a function that processes a frame of |handle| in that format
+// without any checks. The results are the same as with WebRtcVad_Process().
+// The function is valid for |handle| until the next WebRtcVad_Configure() or
+// WebRtcVad_Init(); after WebRtcVad_Init() or a return to the pool it returns
+// -1. |audio_frame| must not be NULL and must hold |frame_length| samples.
+// WebRtcVad_Process() can still be used on |handle| with any format.
+//
+// - handle       [i/o] : VAD Instance. Needs to be initialized by
+//                        WebRtcVad_Init() before call.
+// - fs           [i]   : Sampling frequency (Hz): 8000, 16000, 32000 or 48000.
+// - frame_length [i]   : Length of the audio frames in number of samples.
+//
+// returns              : The function to process the frames with, NULL on a
+//                        null pointer, an uninitialized VAD instance or an
+//                        invalid combination of |fs| and |frame_length|.
+WebRtcVadProcessFn WebRtcVad_Configure(VadInst* handle,
+                                       int fs,
+                                       size_t frame_length);
+
+// Returns the size in bytes of the scratch memory
+// WebRtcVad_ProcessLanes48khz() needs, about 27 kB.
+size_t WebRtcVad_LanesWorkspaceSize(void);
+
+// Calculates a VAD decision for one 48 kHz frame of each of |count| streams.
+// The streams are resampled to 8 kHz eight at a time, in the vector lanes of
+// WebRtcSpl_Resample48khzTo8khzLanes(), which costs less per stream than
+// resampling them one by one. The decisions and the adaptive states are the
+// same as with WebRtcVad_Process() on every instance, with all their
+// settings; frames taken by the silence gate skip the resampler as they do
+// there. The instances must be distinct. Their own workspaces are not used.
+//
+// - handles      [i/o] : |count| VAD instances. Need to be initialized by
+//                        WebRtcVad_Init() before call.
+// - count        [i]   : Number of streams.
+// - audio_frames [i]   : |count| audio frame buffers, one per instance.
+// - frame_length [i]   : Length of each audio frame buffer in number of
+//                        samples: 480, 960 or 1440.
+// - workspace    [-]   : Scratch memory, 4 byte aligned.
+// - size         [i]   : Size of |workspace| in bytes, at least
+//                        WebRtcVad_LanesWorkspaceSize().
+// - decisions    [o]   : |count| decisions, 1 - (Active Voice) or
+//                        0 - (Non-active Voice).
+//
+// returns              : 0 - (OK),
+//                       -1 - (null pointer, uninitialized VAD instance,
+//                             invalid frame length or |workspace| too small
+//                             or misaligned). No stream is processed then.
+int WebRtcVad_ProcessLanes48khz(VadInst* const* handles,
+                                size_t count,
+                                const int16_t* const* audio_frames,
+                                size_t frame_length,
+                                void* workspace,
+                                size_t size,
+                                int* decisions);
+
 // Checks for valid combinations of |rate| and |frame_length|. We support 10,
 // 20 and 30 ms frames and the rates 8000, 16000 and 32000 Hz.
 //
@@ -80,6 +381,59 @@ int WebRtcVad_Process(VadInst* handle,
 // returns            : 0 - (valid combination), -1 - (invalid combination)
 int WebRtcVad_ValidRateAndFrameLength(int rate, size_t frame_length);
 
+// Creates a pool of |capacity| VAD instances in one allocation. The instances
+// are contiguous and each starts on a cache line, so many concurrent streams
+// don't scatter their state across the heap.
+//
+// - capacity [i] : Maximum number of instances taken at the same time.
+//
+// returns        : Pool, or NULL if out of memory or |capacity| is 0 or too
+//                  large.
+VadPool* WebRtcVad_CreatePool(size_t capacity);
+
+// Frees a pool and all its instances.
+//
+// - pool [i] : Pool to free.
+void WebRtcVad_FreePool(VadPool* pool);
+
+// Takes an instance from a pool in O(1) without allocating. The instance must
+// be initialized by WebRtcVad_Init() before use, and given back with
+// WebRtcVad_PoolRelease() instead of WebRtcVad_Free(). A pool must not be
+// used from several threads at the same time.
+//
+// - pool [i/o] : Pool.
+//
+// returns      : Instance, or NULL if all instances are taken.
+VadInst* WebRtcVad_PoolAcquire(VadPool* pool);
+
+// Gives an instance back to its pool in O(1).
+//
+// - pool   [i/o] : Pool the instance was taken from.
+// - handle [i]   : Instance.
+//
+// returns        : 0 - (OK),
+//                 -1 - (null pointer, |handle| not taken from |pool| or
+//                       already given back).
+int WebRtcVad_PoolRelease(VadPool* pool, VadInst* handle);
+
+// Returns the number of instances left in a pool.
+size_t WebRtcVad_PoolAvailable(const VadPool* pool);
+
+// Takes a snapshot of the stage counters of a VAD instance, or of the global
+// counters of all instances if |handle| is NULL. The global counters may be
+// read while other threads are processing.
+//
+// - handle  [i] : VAD instance, or NULL.
+// - profile [o] : Counters.
+//
+// returns       : 0 - (OK),
+//                -1 - (null pointer or built without WEBRTC_VAD_PROFILING).
+int WebRtcVad_GetProfile(const VadInst* handle, WebRtcVadProfile* profile);
+
+// Clears the stage counters of a VAD instance, or the global counters if
+// |handle| is NULL.
+void WebRtcVad_ResetProfile(VadInst* handle);
+
 #ifdef __cplusplus
 }
 #endif
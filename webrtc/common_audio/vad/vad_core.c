@@ -10,11 +10,15 @@
 
 #include "webrtc/common_audio/vad/vad_core.h"
 
+#include <math.h>
+
 #include "webrtc/rtc_base/sanitizer.h"
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 #include "webrtc/common_audio/vad/vad_filterbank.h"
 #include "webrtc/common_audio/vad/vad_gmm.h"
 #include "webrtc/common_audio/vad/vad_sp.h"
+#include "webrtc/common_audio/vad/vad_spectral.h"
+#include "webrtc/rtc_base/checks.h"
 
 // Spectrum Weighting
 static const int16_t kSpectrumWeight[kNumChannels] = { 6, 8, 10, 12, 14, 16 };
@@ -53,10 +57,8 @@ static const int16_t kNoiseDataStds[kTableSize] = {
 static const int16_t kSpeechDataStds[kTableSize] = {
     555, 505, 567, 524, 585, 1231, 509, 828, 492, 1540, 1079, 850 };
 
-// Constants used in GmmProbability().
+// Constants used in WebRtcVad_GmmProbability().
 //
-// Maximum number of counted speech (VAD = 1) frames in a row.
-static const int16_t kMaxSpeechFrames = 6;
 // Minimum standard deviation for both speech and noise.
 static const int16_t kMinStd = 384;
 
@@ -119,19 +121,8 @@ static inline int32_t RTC_NO_SANITIZE("signed-integer-overflow")
   return a * b;
 }
 
-// Calculates the probabilities for both speech and background noise using
-// Gaussian Mixture Models (GMM). A hypothesis-test is performed to decide which
-// type of signal is most probable.
-//
-// - self           [i/o] : Pointer to VAD instance
-// - features       [i]   : Feature vector of length |kNumChannels|
-//                          = log10(energy in frequency band)
-// - total_power    [i]   : Total power in audio frame.
-// - frame_length   [i]   : Number of input samples
-//
-// - returns              : the VAD decision (0 - noise, 1 - speech).
-static int16_t GmmProbability(VadInstT* self, int16_t* features,
-                              int16_t total_power, size_t frame_length) {
+int16_t WebRtcVad_GmmProbability(VadInstT* self, int16_t* features,
+                                 int16_t total_power, size_t frame_length) {
   int channel, k;
   int16_t feature_minimum;
   int16_t h0, h1;
@@ -487,14 +478,254 @@ static int16_t GmmProbability(VadInstT* self, int16_t* features,
   return vadflag;
 }
 
-// Initialize the VAD. Set aggressiveness mode to default value.
-int WebRtcVad_InitCore(VadInstT* self) {
-  int i;
+// Float version of WeightedAverage(), with |weights| in Q7.
+static float WeightedAverageFloat(float* data, float offset,
+                                  const int16_t* weights) {
+  int k;
+  float weighted_average = 0.f;
 
-  if (self == NULL) {
-    return -1;
+  for (k = 0; k < kNumGaussians; k++) {
+    data[k * kNumChannels] += offset;
+    weighted_average +=
+        data[k * kNumChannels] * (weights[k * kNumChannels] / 128.f);
+  }
+  return weighted_average;
+}
+
+int16_t WebRtcVad_GmmProbabilityFloat(VadInstT* self, size_t frame_length) {
+  // Smallest value of a likelihood, as the bit position of 1 in Q27 taken
+  // by WebRtcSpl_NormW32() of a zero likelihood in the fixed point GMM.
+  const float kMinLikelihood = 1.f / (1 << 28);
+  // Smallest likelihood for which the conditional probabilities of the
+  // Gaussians are computed, 1 in Q15.
+  const float kMinConditional = 1.f / (1 << 15);
+  VadFloatStateT* state = &self->float_state;
+  const float* features = state->feature_vector;
+  int channel, k;
+  int gaussian;
+  int16_t vadflag = 0;
+  float feature_minimum;
+  float h0_test, h1_test;
+  float log_likelihood_ratio;
+  float sum_log_likelihood_ratios = 0.f;
+  float noise_global_mean, speech_global_mean;
+  float nmk, nmk2, nmk3, smk, smk2, nsk, ssk;
+  float diff, maxspe, maxmu, limit;
+  float deltaN[kTableSize], deltaS[kTableSize];
+  float ngprvec[kTableSize] = { 0.f };  // Conditional probability = 0.
+  float sgprvec[kTableSize] = { 0.f };  // Conditional probability = 0.
+  float noise_probability[kNumGaussians], speech_probability[kNumGaussians];
+  int16_t overhead1, overhead2, individualTest, totalTest;
+
+  // Set various thresholds based on frame lengths (80, 160 or 240 samples).
+  if (frame_length == 80) {
+    overhead1 = self->over_hang_max_1[0];
+    overhead2 = self->over_hang_max_2[0];
+    individualTest = self->individual[0];
+    totalTest = self->total[0];
+  } else if (frame_length == 160) {
+    overhead1 = self->over_hang_max_1[1];
+    overhead2 = self->over_hang_max_2[1];
+    individualTest = self->individual[1];
+    totalTest = self->total[1];
+  } else {
+    overhead1 = self->over_hang_max_1[2];
+    overhead2 = self->over_hang_max_2[2];
+    individualTest = self->individual[2];
+    totalTest = self->total[2];
   }
 
+  if (state->total_power > kMinEnergy) {
+    // The LRT of WebRtcVad_GmmProbability(), with the exact log likelihood
+    // ratio instead of the difference of the bit positions.
+    for (channel = 0; channel < kNumChannels; channel++) {
+      h0_test = 0.f;
+      h1_test = 0.f;
+      for (k = 0; k < kNumGaussians; k++) {
+        gaussian = channel + k * kNumChannels;
+        noise_probability[k] =
+            (kNoiseDataWeights[gaussian] / 128.f) *
+            WebRtcVad_GaussianProbabilityFloat(features[channel],
+                                               state->noise_means[gaussian],
+                                               state->noise_stds[gaussian],
+                                               &deltaN[gaussian]);
+        h0_test += noise_probability[k];
+
+        speech_probability[k] =
+            (kSpeechDataWeights[gaussian] / 128.f) *
+            WebRtcVad_GaussianProbabilityFloat(features[channel],
+                                               state->speech_means[gaussian],
+                                               state->speech_stds[gaussian],
+                                               &deltaS[gaussian]);
+        h1_test += speech_probability[k];
+      }
+
+      log_likelihood_ratio =
+          log2f((h1_test > kMinLikelihood ? h1_test : kMinLikelihood) /
+                (h0_test > kMinLikelihood ? h0_test : kMinLikelihood));
+      sum_log_likelihood_ratios +=
+          log_likelihood_ratio * kSpectrumWeight[channel];
+
+      // Local VAD decision.
+      if ((log_likelihood_ratio * 4) > individualTest) {
+        vadflag = 1;
+      }
+
+      // Conditional probabilities of the Gaussians.
+      if (h0_test >= kMinConditional) {
+        ngprvec[channel] = noise_probability[0] / h0_test;
+        ngprvec[channel + kNumChannels] = 1.f - ngprvec[channel];
+      } else {
+        ngprvec[channel] = 1.f;
+      }
+      if (h1_test >= kMinConditional) {
+        sgprvec[channel] = speech_probability[0] / h1_test;
+        sgprvec[channel + kNumChannels] = 1.f - sgprvec[channel];
+      }
+    }
+
+    // Make a global VAD decision.
+    vadflag |= (sum_log_likelihood_ratios >= totalTest);
+
+    // Update the model parameters, with the update constants of
+    // WebRtcVad_GmmProbability() as real numbers.
+    maxspe = 100.f;
+    for (channel = 0; channel < kNumChannels; channel++) {
+      feature_minimum =
+          WebRtcVad_FindMinimumFloat(self, features[channel], channel);
+      noise_global_mean = WeightedAverageFloat(&state->noise_means[channel],
+                                               0.f,
+                                               &kNoiseDataWeights[channel]);
+
+      for (k = 0; k < kNumGaussians; k++) {
+        gaussian = channel + k * kNumChannels;
+
+        nmk = state->noise_means[gaussian];
+        smk = state->speech_means[gaussian];
+        nsk = state->noise_stds[gaussian];
+        ssk = state->speech_stds[gaussian];
+
+        // Update noise mean vector if the frame consists of noise only.
+        nmk2 = nmk;
+        if (!vadflag) {
+          nmk2 = nmk + ngprvec[gaussian] * deltaN[gaussian] *
+                           (kNoiseUpdateConst / 32768.f);
+        }
+
+        // Long term correction of the noise mean.
+        nmk3 = nmk2 +
+               (feature_minimum - noise_global_mean) * (kBackEta / 256.f);
+
+        // Control that the noise mean does not drift to much.
+        limit = (float) (k + 5);
+        if (nmk3 < limit) {
+          nmk3 = limit;
+        }
+        limit = (float) (72 + k - channel);
+        if (nmk3 > limit) {
+          nmk3 = limit;
+        }
+        state->noise_means[gaussian] = nmk3;
+
+        if (vadflag) {
+          // Update speech mean vector.
+          smk2 = smk + sgprvec[gaussian] * deltaS[gaussian] *
+                           (kSpeechUpdateConst / 32768.f);
+
+          // Control that the speech mean does not drift to much.
+          maxmu = maxspe + 5.f;
+          if (smk2 < kMinimumMean[k] / 128.f) {
+            smk2 = kMinimumMean[k] / 128.f;
+          }
+          if (smk2 > maxmu) {
+            smk2 = maxmu;
+          }
+          state->speech_means[gaussian] = smk2;
+
+          // Update speech std with an update factor of 0.025.
+          ssk += 0.025f * sgprvec[gaussian] *
+                 (deltaS[gaussian] * (features[channel] - smk) - 1.f) / ssk;
+          if (ssk < kMinStd / 128.f) {
+            ssk = kMinStd / 128.f;
+          }
+          state->speech_stds[gaussian] = ssk;
+        } else {
+          // Update noise std with an update factor of 2^-10.
+          nsk += (1.f / 1024) * ngprvec[gaussian] *
+                 (deltaN[gaussian] * (features[channel] - nmk) - 1.f) / nsk;
+          if (nsk < kMinStd / 128.f) {
+            nsk = kMinStd / 128.f;
+          }
+          state->noise_stds[gaussian] = nsk;
+        }
+      }
+
+      // Separate models if they are too close.
+      noise_global_mean = WeightedAverageFloat(&state->noise_means[channel],
+                                               0.f,
+                                               &kNoiseDataWeights[channel]);
+      speech_global_mean = WeightedAverageFloat(&state->speech_means[channel],
+                                                0.f,
+                                                &kSpeechDataWeights[channel]);
+      diff = speech_global_mean - noise_global_mean;
+      if (diff < kMinimumDifference[channel] / 32.f) {
+        diff = kMinimumDifference[channel] / 32.f - diff;
+
+        // Move the speech means by ~0.8 and the noise means by ~-0.2 of the
+        // difference.
+        speech_global_mean = WeightedAverageFloat(
+            &state->speech_means[channel], (13.f / 16) * diff,
+            &kSpeechDataWeights[channel]);
+        noise_global_mean = WeightedAverageFloat(
+            &state->noise_means[channel], -(3.f / 16) * diff,
+            &kNoiseDataWeights[channel]);
+      }
+
+      // Control that the speech & noise means do not drift to much.
+      maxspe = kMaximumSpeech[channel] / 128.f;
+      if (speech_global_mean > maxspe) {
+        for (k = 0; k < kNumGaussians; k++) {
+          state->speech_means[channel + k * kNumChannels] -=
+              speech_global_mean - maxspe;
+        }
+      }
+      if (noise_global_mean > kMaximumNoise[channel] / 128.f) {
+        for (k = 0; k < kNumGaussians; k++) {
+          state->noise_means[channel + k * kNumChannels] -=
+              noise_global_mean - kMaximumNoise[channel] / 128.f;
+        }
+      }
+    }
+    self->frame_counter++;
+  }
+
+  // Smooth with respect to transition hysteresis.
+  if (!vadflag) {
+    if (self->over_hang > 0) {
+      vadflag = 2 + self->over_hang;
+      self->over_hang--;
+    }
+    self->num_of_speech = 0;
+  } else {
+    self->num_of_speech++;
+    if (self->num_of_speech > kMaxSpeechFrames) {
+      self->num_of_speech = kMaxSpeechFrames;
+      self->over_hang = overhead2;
+    } else {
+      self->over_hang = overhead1;
+    }
+  }
+  return vadflag;
+}
+
+// Freshly initialized adaptive state, i.e., the part of VadInstT in front of
+// the mode settings. Built once, copied by WebRtcVad_ResetCore().
+static VadInstT reset_template;
+
+static void InitResetTemplate(void) {
+  VadInstT* self = &reset_template;
+  int i;
+
   // Initialization of general struct variables.
   self->vad = 1;  // Speech active (=1).
   self->frame_counter = 0;
@@ -529,21 +760,88 @@ int WebRtcVad_InitCore(VadInstT* self) {
   // Initialize high pass filter states.
   memset(self->hp_filter_state, 0, sizeof(self->hp_filter_state));
 
+  memset(self->feature_vector, 0, sizeof(self->feature_vector));
+  self->total_power = 0;
+
   // Initialize mean value memory, for WebRtcVad_FindMinimum().
   for (i = 0; i < kNumChannels; i++) {
     self->mean_value[i] = 1600;
   }
 
+  // The same for the float engine, in dB.
+  memset(&self->float_state, 0, sizeof(self->float_state));
+  for (i = 0; i < kTableSize; i++) {
+    self->float_state.noise_means[i] = kNoiseDataMeans[i] / 128.f;
+    self->float_state.speech_means[i] = kSpeechDataMeans[i] / 128.f;
+    self->float_state.noise_stds[i] = kNoiseDataStds[i] / 128.f;
+    self->float_state.speech_stds[i] = kSpeechDataStds[i] / 128.f;
+  }
+  for (i = 0; i < 16 * kNumChannels; i++) {
+    self->float_state.low_value_vector[i] = 625.f;
+  }
+  for (i = 0; i < kNumChannels; i++) {
+    self->float_state.mean_value[i] = 100.f;
+  }
+}
+
+#if defined(WEBRTC_POSIX)
+#include <pthread.h>
+
+static void once(void (*func)(void)) {
+  static pthread_once_t lock = PTHREAD_ONCE_INIT;
+  pthread_once(&lock, func);
+}
+
+#elif defined(_WIN32)
+#include <windows.h>
+
+static void once(void (*func)(void)) {
+  // Same as in spl_init.c.
+  static CRITICAL_SECTION lock = {(void *)((size_t)-1), -1, 0, 0, 0, 0};
+  static int done = 0;
+
+  EnterCriticalSection(&lock);
+  if (!done) {
+    func();
+    done = 1;
+  }
+  LeaveCriticalSection(&lock);
+}
+#endif  // WEBRTC_POSIX
+
+// Initialize the VAD. Set aggressiveness mode to default value.
+int WebRtcVad_InitCore(VadInstT* self) {
+  if (WebRtcVad_ResetCore(self) != 0) {
+    return -1;
+  }
+
   // Set aggressiveness mode to default (=|kDefaultMode|).
   if (WebRtcVad_set_mode_core(self, kDefaultMode) != 0) {
     return -1;
   }
+  self->silence_threshold = -1;
+  self->workspace = NULL;
+  self->spectral_features = 0;
+  self->hangover = 1;
+  self->configured_calc = NULL;
+  self->engine = kVadEngineFixed;
 
   self->init_flag = kInitCheck;
 
   return 0;
 }
 
+int WebRtcVad_ResetCore(VadInstT* self) {
+  if (self == NULL) {
+    return -1;
+  }
+
+  once(InitResetTemplate);
+  memcpy(self, &reset_template, kVadAdaptiveStateSize);
+
+  return 0;
+}
+
 // Set aggressiveness mode
 int WebRtcVad_set_mode_core(VadInstT* self, int mode) {
   int return_value = 0;
@@ -601,41 +899,111 @@ int WebRtcVad_set_mode_core(VadInstT* self, int mode) {
   return return_value;
 }
 
+// Sizes in bytes of the parts of VadWorkspaceT.
+enum {
+  kSpeechNbBytes = 240 * sizeof(int16_t),
+  kSpeechWbBytes = 480 * sizeof(int16_t),
+  kBandsBytes = (120 + 120 + 60 + 60) * sizeof(int16_t),
+  kBandsFloatBytes = (240 + 120 + 120 + 60 + 60) * sizeof(float),
+  kFftBytes = (2 << kSpectralFftOrder) * sizeof(int16_t)
+};
+
+// Size in bytes of the 48 kHz -> 8 kHz resampler memory for |blocks| 10 ms
+// blocks, see WebRtcSpl_Resample48khzTo8khzBlocks().
+static size_t ResampleBytes(size_t blocks) {
+  return (16 + 480 * blocks) * sizeof(int32_t);
+}
+
+size_t WebRtcVad_WorkspaceBytes(int fs,
+                                int engine,
+                                int spectral_features,
+                                size_t resample_blocks) {
+  size_t shared =
+      engine == kVadEngineFloat ? (size_t)kBandsFloatBytes : kBandsBytes;
+
+  if (spectral_features) {
+    shared = WEBRTC_SPL_MAX(shared, (size_t)kFftBytes);
+  }
+  if (fs == 32000) {
+    shared = WEBRTC_SPL_MAX(shared, (size_t)kSpeechWbBytes);
+  } else if (fs == 48000) {
+    shared = WEBRTC_SPL_MAX(shared, ResampleBytes(resample_blocks));
+  }
+  return (fs == 8000 ? 0 : kSpeechNbBytes) + shared;
+}
+
+void WebRtcVad_InitWorkspace(void* memory,
+                             size_t size,
+                             int fs,
+                             VadWorkspaceT* work) {
+  char* shared = (char*)memory;
+
+  RTC_DCHECK_EQ((uintptr_t)memory % sizeof(int32_t), 0);
+  // Frames at 8 kHz go to the filterbank as they are.
+  work->speech_nb = NULL;
+  if (fs != 8000) {
+    RTC_DCHECK_GE(size, kSpeechNbBytes);
+    work->speech_nb = (int16_t*)shared;
+    shared += kSpeechNbBytes;
+    size -= kSpeechNbBytes;
+  }
+
+  work->resample_mem = (int32_t*)shared;
+  work->resample_blocks = 0;
+  while (work->resample_blocks < 3 &&
+         ResampleBytes(work->resample_blocks + 1) <= size) {
+    work->resample_blocks++;
+  }
+  work->speech_wb = (int16_t*)shared;
+  work->hp_120 = (int16_t*)shared;
+  work->lp_120 = work->hp_120 + 120;
+  work->hp_60 = work->lp_120 + 120;
+  work->lp_60 = work->hp_60 + 60;
+  work->speech_nb_float = (float*)shared;
+  work->hp_120_float = work->speech_nb_float + 240;
+  work->lp_120_float = work->hp_120_float + 120;
+  work->hp_60_float = work->lp_120_float + 120;
+  work->lp_60_float = work->hp_60_float + 60;
+  work->fft = (int16_t*)shared;
+}
+
 // Calculate VAD decision by first extracting feature values and then calculate
 // probability for both speech and background noise.
 
 int WebRtcVad_CalcVad48khz(VadInstT* inst, const int16_t* speech_frame,
-                           size_t frame_length) {
+                           size_t frame_length, VadWorkspaceT* work) {
   int vad;
-  size_t i;
-  int16_t speech_nb[240];  // 30 ms in 8 kHz.
-  // |tmp_mem| is a temporary memory used by resample function, length is
-  // frame length in 10 ms (480 samples) + 256 extra.
-  int32_t tmp_mem[480 + 256] = { 0 };
   const size_t kFrameLen10ms48khz = 480;
-  const size_t kFrameLen10ms8khz = 80;
-  size_t num_10ms_frames = frame_length / kFrameLen10ms48khz;
-
-  for (i = 0; i < num_10ms_frames; i++) {
-    WebRtcSpl_Resample48khzTo8khz(speech_frame,
-                                  &speech_nb[i * kFrameLen10ms8khz],
-                                  &inst->state_48_to_8,
-                                  tmp_mem);
+  const size_t blocks = frame_length / kFrameLen10ms48khz;
+  size_t block = 0;
+  size_t pass = 0;
+
+  // The 10 ms blocks of the frame in as few passes through the resampler as
+  // the workspace allows, one with a workspace of WebRtcVad_WorkspaceSize().
+  // The output is the same either way. Every word of |work->resample_mem| is
+  // written before it is read.
+  RTC_DCHECK_GT(work->resample_blocks, 0);
+  for (block = 0; block < blocks; block += pass) {
+    pass = WEBRTC_SPL_MIN(work->resample_blocks, blocks - block);
+    WebRtcSpl_Resample48khzTo8khzBlocks(
+        speech_frame + block * kFrameLen10ms48khz, pass,
+        work->speech_nb + block * 80, &inst->state_48_to_8,
+        work->resample_mem);
   }
 
   // Do VAD on an 8 kHz signal
-  vad = WebRtcVad_CalcVad8khz(inst, speech_nb, frame_length / 6);
+  vad = WebRtcVad_CalcVad8khz(inst, work->speech_nb, frame_length / 6, work);
 
   return vad;
 }
 
 int WebRtcVad_CalcVad32khz(VadInstT* inst, const int16_t* speech_frame,
-                           size_t frame_length)
+                           size_t frame_length, VadWorkspaceT* work)
 {
     size_t len;
     int vad;
-    int16_t speechWB[480]; // Downsampled speech frame: 960 samples (30ms in SWB)
-    int16_t speechNB[240]; // Downsampled speech frame: 480 samples (30ms in WB)
+    int16_t* speechWB = work->speech_wb; // Downsampled speech frame: 960 samples (30ms in SWB)
+    int16_t* speechNB = work->speech_nb; // Downsampled speech frame: 480 samples (30ms in WB)
 
 
     // Downsample signal 32->16->8 before doing VAD
@@ -647,39 +1015,68 @@ int WebRtcVad_CalcVad32khz(VadInstT* inst, const int16_t* speech_frame,
     len /= 2;
 
     // Do VAD on an 8 kHz signal
-    vad = WebRtcVad_CalcVad8khz(inst, speechNB, len);
+    vad = WebRtcVad_CalcVad8khz(inst, speechNB, len, work);
 
     return vad;
 }
 
 int WebRtcVad_CalcVad16khz(VadInstT* inst, const int16_t* speech_frame,
-                           size_t frame_length)
+                           size_t frame_length, VadWorkspaceT* work)
 {
     size_t len;
     int vad;
-    int16_t speechNB[240]; // Downsampled speech frame: 480 samples (30ms in WB)
+    int16_t* speechNB = work->speech_nb; // Downsampled speech frame: 480 samples (30ms in WB)
 
     // Wideband: Downsample signal before doing VAD
     WebRtcVad_Downsampling(speech_frame, speechNB, inst->downsampling_filter_states,
                            frame_length);
 
     len = frame_length / 2;
-    vad = WebRtcVad_CalcVad8khz(inst, speechNB, len);
+    vad = WebRtcVad_CalcVad8khz(inst, speechNB, len, work);
 
     return vad;
 }
 
 int WebRtcVad_CalcVad8khz(VadInstT* inst, const int16_t* speech_frame,
-                          size_t frame_length)
+                          size_t frame_length, VadWorkspaceT* work)
 {
-    int16_t feature_vector[kNumChannels], total_power;
-
     // Get power in the bands
-    total_power = WebRtcVad_CalculateFeatures(inst, speech_frame, frame_length,
-                                              feature_vector);
+    VAD_PROFILE_BEGIN(features_start);
+    if (inst->engine == kVadEngineFloat)
+    {
+        WebRtcVad_CalculateFeaturesFloat(inst, speech_frame, frame_length,
+                                         work);
+    }
+    else
+    {
+        inst->total_power = WebRtcVad_CalculateFeatures(inst, speech_frame,
+                                                        frame_length, work,
+                                                        inst->feature_vector);
+    }
+    VAD_PROFILE_END(&inst->profile, kVadStageFeatures, features_start);
+
+    // Spectral features of the same frame, if enabled
+    if (inst->spectral_features)
+    {
+        VAD_PROFILE_BEGIN(spectral_start);
+        WebRtcVad_SpectralFeatures(speech_frame, frame_length, work,
+                                   inst->spectral_energy,
+                                   &inst->spectral_flatness);
+        VAD_PROFILE_END(&inst->profile, kVadStageSpectral, spectral_start);
+    }
 
     // Make a VAD
-    inst->vad = GmmProbability(inst, feature_vector, total_power, frame_length);
+    VAD_PROFILE_BEGIN(gmm_start);
+    if (inst->engine == kVadEngineFloat)
+    {
+        inst->vad = WebRtcVad_GmmProbabilityFloat(inst, frame_length);
+    }
+    else
+    {
+        inst->vad = WebRtcVad_GmmProbability(inst, inst->feature_vector,
+                                             inst->total_power, frame_length);
+    }
+    VAD_PROFILE_END(&inst->profile, kVadStageGmm, gmm_start);
 
     return inst->vad;
 }
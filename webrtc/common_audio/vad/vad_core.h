@@ -15,12 +15,72 @@
 #ifndef COMMON_AUDIO_VAD_VAD_CORE_H_
 #define COMMON_AUDIO_VAD_VAD_CORE_H_
 
+#include <stddef.h>
+
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#include "webrtc/common_audio/vad/vad_profile.h"
 
 enum { kNumChannels = 6 };   // Number of frequency bands (named channels).
 enum { kNumGaussians = 2 };  // Number of Gaussians per channel in the GMM.
 enum { kTableSize = kNumChannels * kNumGaussians };
 enum { kMinEnergy = 10 };  // Minimum energy required to trigger audio signal.
+enum { kSpectralFftOrder = 8 };  // 256 point FFT of the 8 kHz frame.
+// Maximum number of counted speech (VAD = 1) frames in a row.
+enum { kMaxSpeechFrames = 6 };
+
+// Scratch memory of one frame, at most 30 ms at 48 kHz, as pointers into
+// memory laid out by WebRtcVad_InitWorkspace(). The frame at 8 kHz has a
+// place of its own. The stages before the filterbank (resampling), the
+// filterbank and the spectral features run one after the other, so they all
+// use the same memory after it. Nothing in it lives longer than a call, see
+// WebRtcVad_SetWorkspace().
+typedef struct {
+  int16_t* speech_nb;  // 30 ms at 8 kHz, NULL for frames at 8 kHz.
+  // 48 kHz -> 8 kHz resampler, for |resample_blocks| 10 ms blocks per pass.
+  int32_t* resample_mem;
+  size_t resample_blocks;
+  int16_t* speech_wb;  // 30 ms at 16 kHz.
+  // Band split outputs of WebRtcVad_CalculateFeatures().
+  int16_t* hp_120;
+  int16_t* lp_120;
+  int16_t* hp_60;
+  int16_t* lp_60;
+  // Frame and band split outputs of WebRtcVad_CalculateFeaturesFloat().
+  float* speech_nb_float;
+  float* hp_120_float;
+  float* lp_120_float;
+  float* hp_60_float;
+  float* lp_60_float;
+  // Complex spectrum of WebRtcVad_SpectralFeatures().
+  int16_t* fft;
+} VadWorkspaceT;
+
+// Adaptive state of the float engine, see WebRtcVad_SetEngine(). Features,
+// means and standard deviations are in dB, i.e. the Q4 features and the Q7
+// models of the fixed point engine as real numbers. The frame counter, the
+// hangover and the ages of the minimum tracking are shared with the fixed
+// point engine, as only one of them runs on an instance.
+typedef struct {
+  float upper_state[5];
+  float lower_state[5];
+  float hp_filter_state[4];
+  float noise_means[kTableSize];
+  float speech_means[kTableSize];
+  float noise_stds[kTableSize];
+  float speech_stds[kTableSize];
+  float low_value_vector[16 * kNumChannels];
+  float mean_value[kNumChannels];
+  float feature_vector[kNumChannels];
+  float total_power;
+} VadFloatStateT;
+
+struct VadInstT_;
+
+// One of the WebRtcVad_CalcVad*khz() functions with the frame length fixed,
+// see VadCalcVad() in vad_specialized.h.
+typedef int (*VadCalcFn)(struct VadInstT_* inst,
+                         const int16_t* speech_frame,
+                         VadWorkspaceT* work);
 
 typedef struct VadInstT_ {
   int vad;
@@ -42,14 +102,60 @@ typedef struct VadInstT_ {
   int16_t upper_state[5];
   int16_t lower_state[5];
   int16_t hp_filter_state[4];
+  // Features and total power of the last frame, see
+  // WebRtcVad_CalculateFeatures().
+  int16_t feature_vector[kNumChannels];
+  int16_t total_power;
+  // Spectral features of the last frame, see WebRtcVad_SpectralFeatures().
+  // Only computed if |spectral_features| is set.
+  int16_t spectral_energy[kNumChannels];
+  int16_t spectral_flatness;
+  // State of the float engine, unused by the fixed point engine.
+  VadFloatStateT float_state;
+  // Rate and frame length for which the filter states are at rest, i.e.
+  // processing a silent frame leaves them and the features unchanged. A
+  // frame length of 0 means not at rest. See WebRtcVad_SetSilenceThreshold().
+  int rest_fs;
+  size_t rest_frame_length;
+  // Number of frames taken by the silence gate since the last reset.
+  uint32_t silent_frames;
+  // Mode settings. Everything above is adaptive state, reset as one block by
+  // WebRtcVad_ResetCore().
   int16_t over_hang_max_1[3];
   int16_t over_hang_max_2[3];
   int16_t individual[3];
   int16_t total[3];
+  // Largest absolute sample value of a silent frame, -1 if disabled.
+  int16_t silence_threshold;
+  // Caller provided scratch memory of WebRtcVad_WorkspaceSize() bytes, NULL
+  // to use the stack.
+  void* workspace;
+  // Nonzero to compute the spectral features along with the filterbank.
+  int spectral_features;
+  // Nonzero to report the frames of the hangover as active voice.
+  int hangover;
+  // Format of the frames given to the function returned by
+  // WebRtcVad_Configure(), and its VAD core. |configured_calc| is NULL if
+  // not configured.
+  int configured_fs;
+  size_t configured_frame_length;
+  VadCalcFn configured_calc;
+  // kVadEngineFixed or kVadEngineFloat, see WebRtcVad_SetEngine().
+  int engine;
 
   int init_flag;
+#if defined(WEBRTC_VAD_PROFILING)
+  VadProfileT profile;
+#endif
 } VadInstT;
 
+// Size of the adaptive state at the start of VadInstT.
+#define kVadAdaptiveStateSize offsetof(VadInstT, over_hang_max_1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Initializes the core VAD component. The default aggressiveness mode is
 // controlled by |kDefaultMode| in vad_core.c.
 //
@@ -59,6 +165,15 @@ typedef struct VadInstT_ {
 //                set)
 int WebRtcVad_InitCore(VadInstT* self);
 
+// Resets the adaptive state (models, minimum tracking and filter states) of
+// the core VAD component to its initial values with one memcpy(), keeping the
+// aggressiveness mode.
+//
+// - self [i/o] : Instance that should be reset
+//
+// returns      : 0 (OK), -1 (null pointer in)
+int WebRtcVad_ResetCore(VadInstT* self);
+
 /****************************************************************************
  * WebRtcVad_set_mode_core(...)
  *
@@ -90,6 +205,7 @@ int WebRtcVad_set_mode_core(VadInstT* self, int mode);
  *      - inst          : Instance that should be initialized
  *      - speech_frame  : Input speech frame
  *      - frame_length  : Number of input samples
+ *      - work          : Scratch memory
  *
  * Output:
  *      - inst          : Updated filter states etc.
@@ -100,15 +216,78 @@ int WebRtcVad_set_mode_core(VadInstT* self, int mode);
  */
 int WebRtcVad_CalcVad48khz(VadInstT* inst,
                            const int16_t* speech_frame,
-                           size_t frame_length);
+                           size_t frame_length,
+                           VadWorkspaceT* work);
 int WebRtcVad_CalcVad32khz(VadInstT* inst,
                            const int16_t* speech_frame,
-                           size_t frame_length);
+                           size_t frame_length,
+                           VadWorkspaceT* work);
 int WebRtcVad_CalcVad16khz(VadInstT* inst,
                            const int16_t* speech_frame,
-                           size_t frame_length);
+                           size_t frame_length,
+                           VadWorkspaceT* work);
 int WebRtcVad_CalcVad8khz(VadInstT* inst,
                           const int16_t* speech_frame,
-                          size_t frame_length);
+                          size_t frame_length,
+                          VadWorkspaceT* work);
+
+// Returns the size in bytes of the scratch memory for frames at |fs| with
+// |engine|, with the spectral features if |spectral_features| is set, and
+// resampling 48 kHz frames |resample_blocks| 10 ms blocks at a time.
+size_t WebRtcVad_WorkspaceBytes(int fs,
+                                int engine,
+                                int spectral_features,
+                                size_t resample_blocks);
+
+// Points |work| into |memory| of |size| bytes, 4 byte aligned, for frames at
+// |fs|. 48 kHz frames are resampled in as many 10 ms blocks at a time as
+// |size| allows, up to all 3 of a 30 ms frame. |size| has to be at least
+// WebRtcVad_WorkspaceBytes() of the instance with one block.
+//
+// - memory [i] : Scratch memory.
+// - size   [i] : Size of |memory| in bytes.
+// - fs     [i] : Sampling frequency (Hz) of the frames.
+// - work   [o] : Pointers into |memory|.
+void WebRtcVad_InitWorkspace(void* memory,
+                             size_t size,
+                             int fs,
+                             VadWorkspaceT* work);
+
+// Returns the VAD core specialized on |fs| and |frame_length|, or NULL if the
+// VAD does not support the pair. One table look up, which replaces checking
+// the pair and branching on the rate for every frame.
+//
+// - fs           [i] : Sampling frequency (Hz).
+// - frame_length [i] : Number of samples per frame.
+VadCalcFn WebRtcVad_SelectCalcVad(int fs, size_t frame_length);
+
+// Calculates the probabilities for both speech and background noise using
+// Gaussian Mixture Models (GMM). A hypothesis-test is performed to decide which
+// type of signal is most probable.
+//
+// - self           [i/o] : Pointer to VAD instance
+// - features       [i]   : Feature vector of length |kNumChannels|
+//                          = log10(energy in frequency band)
+// - total_power    [i]   : Total power in audio frame.
+// - frame_length   [i]   : Number of input samples
+//
+// - returns              : the VAD decision (0 - noise, 1 - speech).
+int16_t WebRtcVad_GmmProbability(VadInstT* self,
+                                 int16_t* features,
+                                 int16_t total_power,
+                                 size_t frame_length);
+
+// Same as WebRtcVad_GmmProbability() in single precision float, on the
+// features in |self->float_state| and with the models there.
+//
+// - self           [i/o] : Pointer to VAD instance
+// - frame_length   [i]   : Number of input samples
+//
+// - returns              : the VAD decision (0 - noise, 1 - speech).
+int16_t WebRtcVad_GmmProbabilityFloat(VadInstT* self, size_t frame_length);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
 
 #endif  // COMMON_AUDIO_VAD_VAD_CORE_H_
@@ -10,6 +10,8 @@
 
 #include "webrtc/common_audio/vad/vad_filterbank.h"
 
+#include <math.h>
+
 #include "webrtc/rtc_base/checks.h"
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 
@@ -241,14 +243,17 @@ static void LogOfEnergy(const int16_t* data_in, size_t data_length,
 }
 
 int16_t WebRtcVad_CalculateFeatures(VadInstT* self, const int16_t* data_in,
-                                    size_t data_length, int16_t* features) {
+                                    size_t data_length, VadWorkspaceT* work,
+                                    int16_t* features) {
   int16_t total_energy = 0;
   // We expect |data_length| to be 80, 160 or 240 samples, which corresponds to
   // 10, 20 or 30 ms in 8 kHz. Therefore, the intermediate downsampled data will
   // have at most 120 samples after the first split and at most 60 samples after
   // the second split.
-  int16_t hp_120[120], lp_120[120];
-  int16_t hp_60[60], lp_60[60];
+  int16_t* hp_120 = work->hp_120;
+  int16_t* lp_120 = work->lp_120;
+  int16_t* hp_60 = work->hp_60;
+  int16_t* lp_60 = work->lp_60;
   const size_t half_data_length = data_length >> 1;
   size_t length = half_data_length;  // |data_length| / 2, corresponds to
                                      // bandwidth = 2000 Hz after downsampling.
@@ -327,3 +332,152 @@ int16_t WebRtcVad_CalculateFeatures(VadInstT* self, const int16_t* data_in,
 
   return total_energy;
 }
+
+// Float versions of the filters above, with the same coefficients. States and
+// outputs are real numbers, without the Q(-1) scaling of the fixed point
+// filters; SplitFilterFloat() halves its outputs instead, so that the band
+// energies and thus |kOffsetVector| are the same.
+
+static void HighPassFilterFloat(const float* data_in, size_t data_length,
+                                float* filter_state, float* data_out) {
+  const float b0 = kHpZeroCoefs[0] / 16384.f;
+  const float b1 = kHpZeroCoefs[1] / 16384.f;
+  const float b2 = kHpZeroCoefs[2] / 16384.f;
+  const float a1 = kHpPoleCoefs[1] / 16384.f;
+  const float a2 = kHpPoleCoefs[2] / 16384.f;
+  size_t i;
+
+  for (i = 0; i < data_length; i++) {
+    const float out = b0 * data_in[i] + b1 * filter_state[0] +
+                      b2 * filter_state[1] - a1 * filter_state[2] -
+                      a2 * filter_state[3];
+    filter_state[1] = filter_state[0];
+    filter_state[0] = data_in[i];
+    filter_state[3] = filter_state[2];
+    filter_state[2] = out;
+    data_out[i] = out;
+  }
+}
+
+// Splits |data_in| as SplitFilter() does. The two all pass branches run in
+// one loop, so their recurrences overlap. Each is written as
+//   state[n + 1] = (1 - c^2) * in[n] - c * state[n],
+//   out[n] = state[n] + c * in[n],
+// which is the same filter with only one multiply-add in the recurrence.
+static void SplitFilterFloat(const float* data_in, size_t data_length,
+                             float* upper_state, float* lower_state,
+                             float* hp_data_out, float* lp_data_out) {
+  const float upper_coefficient = kAllPassCoefsQ15[0] / 32768.f;
+  const float lower_coefficient = kAllPassCoefsQ15[1] / 32768.f;
+  const float upper_gain = 1.f - upper_coefficient * upper_coefficient;
+  const float lower_gain = 1.f - lower_coefficient * lower_coefficient;
+  size_t half_length = data_length >> 1;  // Downsampling by 2.
+  float upper = *upper_state;
+  float lower = *lower_state;
+  size_t i;
+
+  for (i = 0; i < half_length; i++) {
+    const float upper_in = data_in[2 * i];
+    const float lower_in = data_in[2 * i + 1];
+    const float upper_out = upper + upper_coefficient * upper_in;
+    const float lower_out = lower + lower_coefficient * lower_in;
+    upper = upper_gain * upper_in - upper_coefficient * upper;
+    lower = lower_gain * lower_in - lower_coefficient * lower;
+    hp_data_out[i] = 0.5f * (upper_out - lower_out);
+    lp_data_out[i] = 0.5f * (upper_out + lower_out);
+  }
+  *upper_state = upper;
+  *lower_state = lower;
+}
+
+// Calculates 10 * log10 of the energy of |data_in| plus |offset| (Q4) in dB,
+// and adds the energy to |total_energy|.
+static float LogOfEnergyFloat(const float* data_in, size_t data_length,
+                              int16_t offset, float* total_energy) {
+  // Four partial sums, which the compiler may not introduce on its own.
+  float partial[4] = { 0.f, 0.f, 0.f, 0.f };
+  float energy = 0.f;
+  float log_energy = 0.f;
+  size_t i;
+
+  for (i = 0; i + 4 <= data_length; i += 4) {
+    partial[0] += data_in[i] * data_in[i];
+    partial[1] += data_in[i + 1] * data_in[i + 1];
+    partial[2] += data_in[i + 2] * data_in[i + 2];
+    partial[3] += data_in[i + 3] * data_in[i + 3];
+  }
+  for (; i < data_length; i++) {
+    partial[0] += data_in[i] * data_in[i];
+  }
+  energy = (partial[0] + partial[1]) + (partial[2] + partial[3]);
+  *total_energy += energy;
+  if (energy > 0.f) {
+    log_energy = 10.f * log10f(energy);
+    if (log_energy < 0.f) {
+      log_energy = 0.f;
+    }
+  }
+  return log_energy + offset / 16.f;
+}
+
+void WebRtcVad_CalculateFeaturesFloat(VadInstT* self, const int16_t* data_in,
+                                      size_t data_length,
+                                      VadWorkspaceT* work) {
+  VadFloatStateT* state = &self->float_state;
+  float* features = state->feature_vector;
+  float* speech = work->speech_nb_float;
+  float* hp_120 = work->hp_120_float;
+  float* lp_120 = work->lp_120_float;
+  float* hp_60 = work->hp_60_float;
+  float* lp_60 = work->lp_60_float;
+  const size_t half_data_length = data_length >> 1;
+  size_t length = half_data_length;
+  size_t i;
+
+  RTC_DCHECK_LE(data_length, 240);
+
+  for (i = 0; i < data_length; i++) {
+    speech[i] = data_in[i];
+  }
+  state->total_power = 0.f;
+
+  // The same splits as WebRtcVad_CalculateFeatures().
+  SplitFilterFloat(speech, data_length, &state->upper_state[0],
+                   &state->lower_state[0], hp_120, lp_120);
+
+  // [2000 - 4000] Hz into [3000 - 4000] and [2000 - 3000] Hz.
+  SplitFilterFloat(hp_120, length, &state->upper_state[1],
+                   &state->lower_state[1], hp_60, lp_60);
+  length >>= 1;
+  features[5] = LogOfEnergyFloat(hp_60, length, kOffsetVector[5],
+                                 &state->total_power);
+  features[4] = LogOfEnergyFloat(lp_60, length, kOffsetVector[4],
+                                 &state->total_power);
+
+  // [0 - 2000] Hz into [1000 - 2000] and [0 - 1000] Hz.
+  length = half_data_length;
+  SplitFilterFloat(lp_120, length, &state->upper_state[2],
+                   &state->lower_state[2], hp_60, lp_60);
+  length >>= 1;
+  features[3] = LogOfEnergyFloat(hp_60, length, kOffsetVector[3],
+                                 &state->total_power);
+
+  // [0 - 1000] Hz into [500 - 1000] and [0 - 500] Hz.
+  SplitFilterFloat(lp_60, length, &state->upper_state[3],
+                   &state->lower_state[3], hp_120, lp_120);
+  length >>= 1;
+  features[2] = LogOfEnergyFloat(hp_120, length, kOffsetVector[2],
+                                 &state->total_power);
+
+  // [0 - 500] Hz into [250 - 500] and [0 - 250] Hz.
+  SplitFilterFloat(lp_120, length, &state->upper_state[4],
+                   &state->lower_state[4], hp_60, lp_60);
+  length >>= 1;
+  features[1] = LogOfEnergyFloat(hp_60, length, kOffsetVector[1],
+                                 &state->total_power);
+
+  // Remove 0 Hz - 80 Hz, [80 - 250] Hz.
+  HighPassFilterFloat(lp_60, length, state->hp_filter_state, hp_120);
+  features[0] = LogOfEnergyFloat(hp_120, length, kOffsetVector[0],
+                                 &state->total_power);
+}
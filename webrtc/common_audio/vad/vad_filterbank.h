@@ -17,6 +17,10 @@
 
 #include "webrtc/common_audio/vad/vad_core.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Takes |data_length| samples of |data_in| and calculates the logarithm of the
 // energy of each of the |kNumChannels| = 6 frequency bands used by the VAD:
 //        80 Hz - 250 Hz
@@ -34,12 +38,33 @@
 // - self         [i/o] : State information of the VAD.
 // - data_in      [i]   : Input audio data, for feature extraction.
 // - data_length  [i]   : Audio data size, in number of samples.
+// - work         [-]   : Scratch memory for the band split outputs.
 // - features     [o]   : 10 * log10(energy in each frequency band), Q4.
 // - returns            : Total energy of the signal (NOTE! This value is not
 //                        exact. It is only used in a comparison.)
 int16_t WebRtcVad_CalculateFeatures(VadInstT* self,
                                     const int16_t* data_in,
                                     size_t data_length,
+                                    VadWorkspaceT* work,
                                     int16_t* features);
 
+// Same as WebRtcVad_CalculateFeatures() in single precision float, with the
+// filter states of |self->float_state| and an exact logarithm. The features
+// are in dB and written to |self->float_state.feature_vector|, the total
+// energy, without any saturation, to |self->float_state.total_power|.
+//
+// - self         [i/o] : State information of the VAD.
+// - data_in      [i]   : Input audio data, for feature extraction.
+// - data_length  [i]   : Audio data size, in number of samples.
+// - work         [-]   : Scratch memory for the frame and the band split
+//                        outputs.
+void WebRtcVad_CalculateFeaturesFloat(VadInstT* self,
+                                      const int16_t* data_in,
+                                      size_t data_length,
+                                      VadWorkspaceT* work);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
 #endif  // COMMON_AUDIO_VAD_VAD_FILTERBANK_H_
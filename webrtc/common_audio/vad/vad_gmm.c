@@ -10,6 +10,8 @@
 
 #include "webrtc/common_audio/vad/vad_gmm.h"
 
+#include <math.h>
+
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 
 static const int32_t kCompVar = 22005;
@@ -80,3 +82,23 @@ int32_t WebRtcVad_GaussianProbability(int16_t input,
   // Q-domain: Q10 * Q10 = Q20.
   return inv_std * exp_value;
 }
+
+float WebRtcVad_GaussianProbabilityFloat(float input,
+                                         float mean,
+                                         float std,
+                                         float* delta) {
+  // |kCompVar| as a real number.
+  const float kMaxExponent = kCompVar / 1024.f;
+  const float inv_std = 1.f / std;
+  const float diff = input - mean;
+  float exponent = 0.f;
+
+  // |delta| = (x - m) / s^2.
+  *delta = diff * inv_std * inv_std;
+  // (x - m)^2 / (2 * s^2).
+  exponent = 0.5f * *delta * diff;
+  if (exponent >= kMaxExponent) {
+    return 0.f;
+  }
+  return inv_std * expf(-exponent);
+}
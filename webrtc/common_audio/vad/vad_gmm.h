@@ -15,6 +15,10 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Calculates the probability for |input|, given that |input| comes from a
 // normal distribution with mean and standard deviation (|mean|, |std|).
 //
@@ -36,4 +40,16 @@ int32_t WebRtcVad_GaussianProbability(int16_t input,
                                       int16_t std,
                                       int16_t* delta);
 
+// Same as WebRtcVad_GaussianProbability() in single precision float, with
+// |input|, |mean| and |std| in the same unit. Returns 0 where the fixed point
+// version does, for an exponent of 21.5 and more.
+float WebRtcVad_GaussianProbabilityFloat(float input,
+                                         float mean,
+                                         float std,
+                                         float* delta);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
 #endif  // COMMON_AUDIO_VAD_VAD_GMM_H_
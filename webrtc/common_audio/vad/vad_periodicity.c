@@ -0,0 +1,111 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/vad/vad_periodicity.h"
+
+#include <math.h>
+
+#include "webrtc/common_audio/signal_processing/dot_product_with_scale.h"
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+
+enum { kNumLags = kPeriodicityMaxLag - kPeriodicityMinLag + 1 };
+
+// Score, relative to the best, from which a shorter lag is preferred: a
+// normalized correlation within about 8% of the best.
+static const double kMultipleScore = 0.85;
+
+int16_t WebRtcVad_Periodicity(const int16_t* frame,
+                              size_t frame_length,
+                              size_t history,
+                              int fs,
+                              size_t* lag) {
+  int32_t corr[kNumLags];
+  int32_t energies[kNumLags];
+  double scores[kNumLags];
+  const int16_t* seq1 = NULL;
+  const int16_t* lagged = NULL;
+  size_t step = 0, min_lag = 0, max_lag = 0, skip = 0, dim = 0, k = 0;
+  size_t best = 0;
+  int scaling = 0;
+  int32_t energy = 0, lagged_energy = 0;
+  double best_score = 0.0, strength = 0.0;
+
+  if (lag != NULL) {
+    *lag = 0;
+  }
+  if (fs < 8000 || fs % 8000 != 0) {
+    return -1;
+  }
+  step = (size_t)fs / 8000;
+  min_lag = kPeriodicityMinLag * step;
+  max_lag = kPeriodicityMaxLag * step;
+
+  // Without enough history the start of the frame is left out, but at least
+  // half of it has to remain.
+  skip = history < max_lag ? max_lag - history : 0;
+  if (2 * skip >= frame_length) {
+    return 0;
+  }
+  seq1 = frame + skip;
+  dim = frame_length - skip;
+
+  // Headroom for |dim| squares of the largest sample read, so that every
+  // correlation and window energy below fits in 32 bits.
+  scaling = WebRtcSpl_GetScalingSquare((int16_t*)(seq1 - max_lag),
+                                       dim + max_lag, dim);
+  energy = WebRtcSpl_DotProductWithScale(seq1, seq1, dim, scaling);
+  if (energy <= 0) {
+    return 0;
+  }
+
+  // |corr[k]| is the correlation at lag |min_lag| + |k| * |step|.
+  WebRtcSpl_CrossCorrelation(corr, seq1, seq1 - min_lag, dim, kNumLags,
+                             scaling, -(int)step);
+
+  // Score the lags with a positive correlation by corr^2 / lagged_energy,
+  // which orders them like the normalized correlation. The energy of the
+  // lagged window is updated as it slides.
+  lagged = seq1 - min_lag;
+  lagged_energy = WebRtcSpl_DotProductWithScale(lagged, lagged, dim, scaling);
+  for (k = 0; k < kNumLags; k++) {
+    if (k > 0) {
+      lagged -= step;
+      lagged_energy +=
+          WebRtcSpl_DotProductWithScale(lagged, lagged, step, scaling) -
+          WebRtcSpl_DotProductWithScale(lagged + dim, lagged + dim, step,
+                                        scaling);
+    }
+    energies[k] = lagged_energy;
+    scores[k] = 0.0;
+    if (corr[k] > 0 && lagged_energy > 0) {
+      scores[k] = (double)corr[k] * corr[k] / lagged_energy;
+      best_score = scores[k] > best_score ? scores[k] : best_score;
+    }
+  }
+  if (best_score <= 0.0) {
+    return 0;
+  }
+
+  // Multiples of the period score almost as high as the period itself. Take
+  // the peak of the shortest lag close to the best, so that the lag does not
+  // jump between them from frame to frame.
+  while (scores[best] < kMultipleScore * best_score) {
+    best++;
+  }
+  while (best + 1 < kNumLags && scores[best + 1] > scores[best]) {
+    best++;
+  }
+
+  if (lag != NULL) {
+    *lag = min_lag + best * step;
+  }
+  strength = corr[best] / sqrt((double)energy * energies[best]);
+  return (int16_t)(strength >= 1.0 ? 16384 : strength * 16384.0);
+}
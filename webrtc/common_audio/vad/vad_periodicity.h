@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// This file includes a periodicity (pitch strength) feature. It is not part
+// of the GMM decision; callers use it to tell voiced speech from stationary
+// tonal noise, which the GMM takes for speech.
+
+#ifndef COMMON_AUDIO_VAD_VAD_PERIODICITY_H_
+#define COMMON_AUDIO_VAD_VAD_PERIODICITY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Pitch lags searched, in samples at 8 kHz: 2.5 to 16 ms, i.e. 400 to
+// 62.5 Hz. At higher rates the lags are searched in steps of |fs| / 8000
+// samples, so the cost does not grow with the square of the rate.
+enum { kPeriodicityMinLag = 20 };
+enum { kPeriodicityMaxLag = 128 };
+
+// Returns the periodicity of a frame: the normalized autocorrelation at the
+// pitch lag, in Q14. The pitch lag is the shortest one with a correlation
+// close to the largest, so that multiples of the period do not win.
+// Correlations and energies are computed with WebRtcSpl_CrossCorrelation()
+// and WebRtcSpl_DotProductWithScale(), which work before WebRtcSpl_Init(), so
+// no VAD instance has to exist.
+//
+// Inputs:
+//      - frame         : Frame to analyze.
+//      - frame_length  : Number of samples in |frame|.
+//      - history       : Number of valid samples before |frame|, read for
+//                        the longer lags. With less than the longest lag the
+//                        start of the frame is left out of the correlation.
+//      - fs            : Sampling rate in Hz, a multiple of 8000.
+//
+// Output:
+//      - lag           : The pitch lag in samples, 0 if no correlation is
+//                        positive. May be NULL.
+//
+// Returns:
+//                      : Periodicity in Q14, 0 (none or too little audio) to
+//                        16384 (periodic). -1 for an unsupported |fs|.
+int16_t WebRtcVad_Periodicity(const int16_t* frame,
+                              size_t frame_length,
+                              size_t history,
+                              int fs,
+                              size_t* lag);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // COMMON_AUDIO_VAD_VAD_PERIODICITY_H_
@@ -0,0 +1,127 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/vad/vad_profile.h"
+
+#include <string.h>
+
+#include "webrtc/common_audio/vad/vad_core.h"
+
+#if defined(WEBRTC_VAD_PROFILING)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <windows.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+// Counters of all instances, and of the stages outside of an instance.
+static VadProfileT g_profile;
+
+uint64_t WebRtcVad_ReadTicks(void) {
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || \
+    defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#elif defined(_MSC_VER)
+  LARGE_INTEGER ticks;
+  QueryPerformanceCounter(&ticks);
+  return (uint64_t)ticks.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static void AtomicAdd(uint64_t* counter, uint64_t value) {
+#if defined(_MSC_VER)
+  InterlockedExchangeAdd64((volatile LONG64*)counter, (LONG64)value);
+#else
+  __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+#endif
+}
+
+static uint64_t AtomicLoad(const uint64_t* counter) {
+#if defined(_MSC_VER)
+  return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)counter, 0,
+                                                0);
+#else
+  return __atomic_load_n(counter, __ATOMIC_RELAXED);
+#endif
+}
+
+void WebRtcVad_RecordStage(VadProfileT* profile, int stage, uint64_t ticks) {
+  // An instance is used by one thread at a time, only the global counters
+  // are shared.
+  if (profile != NULL) {
+    profile->calls[stage]++;
+    profile->ticks[stage] += ticks;
+  }
+  AtomicAdd(&g_profile.calls[stage], 1);
+  AtomicAdd(&g_profile.ticks[stage], ticks);
+}
+
+int WebRtcVad_GetProfile(const VadInst* handle, WebRtcVadProfile* profile) {
+  int i;
+
+  if (profile == NULL) {
+    return -1;
+  }
+  if (handle != NULL) {
+    const VadInstT* self = (const VadInstT*)handle;
+    memcpy(profile->calls, self->profile.calls, sizeof(profile->calls));
+    memcpy(profile->ticks, self->profile.ticks, sizeof(profile->ticks));
+    return 0;
+  }
+  for (i = 0; i < kVadNumStages; i++) {
+    profile->calls[i] = AtomicLoad(&g_profile.calls[i]);
+    profile->ticks[i] = AtomicLoad(&g_profile.ticks[i]);
+  }
+  return 0;
+}
+
+void WebRtcVad_ResetProfile(VadInst* handle) {
+  int i;
+
+  if (handle != NULL) {
+    memset(&((VadInstT*)handle)->profile, 0, sizeof(VadProfileT));
+    return;
+  }
+  for (i = 0; i < kVadNumStages; i++) {
+#if defined(_MSC_VER)
+    InterlockedExchange64((volatile LONG64*)&g_profile.calls[i], 0);
+    InterlockedExchange64((volatile LONG64*)&g_profile.ticks[i], 0);
+#else
+    __atomic_store_n(&g_profile.calls[i], 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_profile.ticks[i], 0, __ATOMIC_RELAXED);
+#endif
+  }
+}
+
+#else
+
+int WebRtcVad_GetProfile(const VadInst* handle, WebRtcVadProfile* profile) {
+  (void)handle;
+  (void)profile;
+  return -1;
+}
+
+void WebRtcVad_ResetProfile(VadInst* handle) {
+  (void)handle;
+}
+
+#endif  // WEBRTC_VAD_PROFILING
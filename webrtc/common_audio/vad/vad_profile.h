@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This header file includes the hot path instrumentation of the VAD. The
+ * counters are compiled in with WEBRTC_VAD_PROFILING only, otherwise the
+ * macros expand to nothing.
+ */
+
+#ifndef COMMON_AUDIO_VAD_VAD_PROFILE_H_
+#define COMMON_AUDIO_VAD_VAD_PROFILE_H_
+
+#include <stdint.h>
+
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(WEBRTC_VAD_PROFILING)
+
+// Calls and ticks of every stage, see WebRtcVadProfile.
+typedef struct VadProfileT_ {
+  uint64_t calls[kVadNumStages];
+  uint64_t ticks[kVadNumStages];
+} VadProfileT;
+
+// Returns the value of the cheapest monotonic tick counter of the platform,
+// the time stamp counter on x86.
+uint64_t WebRtcVad_ReadTicks(void);
+
+// Adds one call of |stage| taking |ticks| to the global counters and, if not
+// NULL, to |profile|.
+//
+// - profile [i/o] : Counters of a VAD instance, or NULL.
+// - stage   [i]   : One of kVadStage*.
+// - ticks   [i]   : Duration of the call.
+void WebRtcVad_RecordStage(VadProfileT* profile, int stage, uint64_t ticks);
+
+#define VAD_PROFILE_BEGIN(name) const uint64_t name = WebRtcVad_ReadTicks()
+#define VAD_PROFILE_END(profile, stage, name) \
+  WebRtcVad_RecordStage(profile, stage, WebRtcVad_ReadTicks() - (name))
+
+#else
+
+#define VAD_PROFILE_BEGIN(name)
+#define VAD_PROFILE_END(profile, stage, name)
+
+#endif  // WEBRTC_VAD_PROFILING
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // COMMON_AUDIO_VAD_VAD_PROFILE_H_
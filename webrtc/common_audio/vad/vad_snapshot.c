@@ -0,0 +1,331 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * This file includes the serialization of the VAD state, see
+ * WebRtcVad_Snapshot() and WebRtcVad_Restore(), and the noise profiles for a
+ * warm start, see WebRtcVad_SetNoiseProfile().
+ */
+
+#include "webrtc/common_audio/vad/include/webrtc_vad.h"
+
+#include <string.h>
+
+#include "webrtc/common_audio/vad/vad_core.h"
+#include "webrtc/rtc_base/compile_assert_c.h"
+
+static const int kInitCheck = 42;
+
+// Snapshot layout: "WVAD", format version (16 bits), then every field of the
+// state in the order of VadInstT, all little endian.
+static const uint8_t kMagic[4] = { 'W', 'V', 'A', 'D' };
+enum { kSnapshotVersion = 1 };
+enum { kHeaderSize = 6 };
+
+// Number of 16 and 32 bit values in a snapshot.
+enum {
+  kNumWords16 = 4 * kTableSize + 2 + 2 * 16 * kNumChannels + kNumChannels +
+                5 + 5 + 4 + kNumChannels + 1 + 4 * 3,
+  kNumWords32 = 1 + 4 + 8 + 16 + 8 + 8 + 1
+};
+
+typedef struct {
+  uint8_t* data;
+  const uint8_t* in;
+} Cursor;
+
+static void Put16(Cursor* c, const int16_t* values, size_t count) {
+  size_t i;
+  for (i = 0; i < count; i++) {
+    uint16_t value = (uint16_t)values[i];
+    c->data[0] = (uint8_t)value;
+    c->data[1] = (uint8_t)(value >> 8);
+    c->data += 2;
+  }
+}
+
+static void Put32(Cursor* c, const int32_t* values, size_t count) {
+  size_t i;
+  for (i = 0; i < count; i++) {
+    uint32_t value = (uint32_t)values[i];
+    c->data[0] = (uint8_t)value;
+    c->data[1] = (uint8_t)(value >> 8);
+    c->data[2] = (uint8_t)(value >> 16);
+    c->data[3] = (uint8_t)(value >> 24);
+    c->data += 4;
+  }
+}
+
+static void Get16(Cursor* c, int16_t* values, size_t count) {
+  size_t i;
+  for (i = 0; i < count; i++) {
+    values[i] = (int16_t)(uint16_t)(c->in[0] | (c->in[1] << 8));
+    c->in += 2;
+  }
+}
+
+static void Get32(Cursor* c, int32_t* values, size_t count) {
+  size_t i;
+  for (i = 0; i < count; i++) {
+    values[i] = (int32_t)((uint32_t)c->in[0] | ((uint32_t)c->in[1] << 8) |
+                          ((uint32_t)c->in[2] << 16) |
+                          ((uint32_t)c->in[3] << 24));
+    c->in += 4;
+  }
+}
+
+size_t WebRtcVad_SnapshotSize(void) {
+  return kHeaderSize + 2 * kNumWords16 + 4 * kNumWords32;
+}
+
+int WebRtcVad_Snapshot(const VadInst* handle, uint8_t* buffer, size_t size) {
+  const VadInstT* self = (const VadInstT*)handle;
+  int32_t vad;
+  int16_t version = kSnapshotVersion;
+  Cursor c;
+
+  if (handle == NULL || buffer == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck || self->engine != kVadEngineFixed) {
+    return -1;
+  }
+  if (size < WebRtcVad_SnapshotSize()) {
+    return -1;
+  }
+
+  memcpy(buffer, kMagic, sizeof(kMagic));
+  c.data = buffer + sizeof(kMagic);
+  Put16(&c, &version, 1);
+
+  vad = self->vad;
+  Put32(&c, &vad, 1);
+  Put32(&c, self->downsampling_filter_states, 4);
+  Put32(&c, self->state_48_to_8.S_48_24, 8);
+  Put32(&c, self->state_48_to_8.S_24_24, 16);
+  Put32(&c, self->state_48_to_8.S_24_16, 8);
+  Put32(&c, self->state_48_to_8.S_16_8, 8);
+  Put16(&c, self->noise_means, kTableSize);
+  Put16(&c, self->speech_means, kTableSize);
+  Put16(&c, self->noise_stds, kTableSize);
+  Put16(&c, self->speech_stds, kTableSize);
+  Put32(&c, &self->frame_counter, 1);
+  Put16(&c, &self->over_hang, 1);
+  Put16(&c, &self->num_of_speech, 1);
+  Put16(&c, self->index_vector, 16 * kNumChannels);
+  Put16(&c, self->low_value_vector, 16 * kNumChannels);
+  Put16(&c, self->mean_value, kNumChannels);
+  Put16(&c, self->upper_state, 5);
+  Put16(&c, self->lower_state, 5);
+  Put16(&c, self->hp_filter_state, 4);
+  Put16(&c, self->feature_vector, kNumChannels);
+  Put16(&c, &self->total_power, 1);
+  Put16(&c, self->over_hang_max_1, 3);
+  Put16(&c, self->over_hang_max_2, 3);
+  Put16(&c, self->individual, 3);
+  Put16(&c, self->total, 3);
+
+  return (int)(c.data - buffer);
+}
+
+// Returns 1 if the mode settings of |restored| are those of one of the
+// aggressiveness modes, 0 otherwise.
+static int ValidMode(const VadInstT* restored) {
+  VadInstT mode_settings;
+  int mode;
+
+  for (mode = 0; mode < 4; mode++) {
+    WebRtcVad_set_mode_core(&mode_settings, mode);
+    if (memcmp(restored->over_hang_max_1, mode_settings.over_hang_max_1,
+               sizeof(restored->over_hang_max_1)) == 0 &&
+        memcmp(restored->over_hang_max_2, mode_settings.over_hang_max_2,
+               sizeof(restored->over_hang_max_2)) == 0 &&
+        memcmp(restored->individual, mode_settings.individual,
+               sizeof(restored->individual)) == 0 &&
+        memcmp(restored->total, mode_settings.total,
+               sizeof(restored->total)) == 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// Returns 0 if the adaptive state of |restored| can be run by the VAD core,
+// with the same checks as WebRtcVad_SetNoiseProfile() for the models and the
+// noise floor, -1 otherwise.
+static int ValidState(const VadInstT* restored) {
+  int16_t max_over_hang = 0;
+  int i;
+
+  if (!ValidMode(restored)) {
+    return -1;
+  }
+  for (i = 0; i < 3; i++) {
+    max_over_hang = WEBRTC_SPL_MAX(max_over_hang, restored->over_hang_max_1[i]);
+    max_over_hang = WEBRTC_SPL_MAX(max_over_hang, restored->over_hang_max_2[i]);
+  }
+  if (restored->frame_counter < 0 || restored->over_hang < 0 ||
+      restored->over_hang > max_over_hang || restored->num_of_speech < 0 ||
+      restored->num_of_speech > kMaxSpeechFrames) {
+    return -1;
+  }
+  for (i = 0; i < kTableSize; i++) {
+    // The GMM divides by the standard deviations.
+    if (restored->noise_stds[i] <= 0 || restored->speech_stds[i] <= 0) {
+      return -1;
+    }
+  }
+  for (i = 0; i < kNumChannels; i++) {
+    if (restored->mean_value[i] < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+int WebRtcVad_Restore(VadInst* handle, const uint8_t* buffer, size_t size) {
+  VadInstT* self = (VadInstT*)handle;
+  // The state is restored into a copy, and kept only if it is valid.
+  VadInstT restored;
+  int32_t vad;
+  int16_t version;
+  Cursor c;
+
+  if (handle == NULL || buffer == NULL) {
+    return -1;
+  }
+  if (size < WebRtcVad_SnapshotSize() ||
+      memcmp(buffer, kMagic, sizeof(kMagic)) != 0) {
+    return -1;
+  }
+  c.in = buffer + sizeof(kMagic);
+  Get16(&c, &version, 1);
+  if (version != kSnapshotVersion) {
+    return -1;
+  }
+
+  // An instance that was never initialized gets the state and settings of a
+  // new one for everything the snapshot does not hold.
+  if (self->init_flag == kInitCheck) {
+    memcpy(&restored, self, sizeof(restored));
+  } else {
+    WebRtcVad_InitCore(&restored);
+#if defined(WEBRTC_VAD_PROFILING)
+    memcpy(&restored.profile, &self->profile, sizeof(restored.profile));
+#endif
+  }
+
+  Get32(&c, &vad, 1);
+  restored.vad = vad;
+  Get32(&c, restored.downsampling_filter_states, 4);
+  Get32(&c, restored.state_48_to_8.S_48_24, 8);
+  Get32(&c, restored.state_48_to_8.S_24_24, 16);
+  Get32(&c, restored.state_48_to_8.S_24_16, 8);
+  Get32(&c, restored.state_48_to_8.S_16_8, 8);
+  Get16(&c, restored.noise_means, kTableSize);
+  Get16(&c, restored.speech_means, kTableSize);
+  Get16(&c, restored.noise_stds, kTableSize);
+  Get16(&c, restored.speech_stds, kTableSize);
+  Get32(&c, &restored.frame_counter, 1);
+  Get16(&c, &restored.over_hang, 1);
+  Get16(&c, &restored.num_of_speech, 1);
+  Get16(&c, restored.index_vector, 16 * kNumChannels);
+  Get16(&c, restored.low_value_vector, 16 * kNumChannels);
+  Get16(&c, restored.mean_value, kNumChannels);
+  Get16(&c, restored.upper_state, 5);
+  Get16(&c, restored.lower_state, 5);
+  Get16(&c, restored.hp_filter_state, 4);
+  Get16(&c, restored.feature_vector, kNumChannels);
+  Get16(&c, &restored.total_power, 1);
+  Get16(&c, restored.over_hang_max_1, 3);
+  Get16(&c, restored.over_hang_max_2, 3);
+  Get16(&c, restored.individual, 3);
+  Get16(&c, restored.total, 3);
+  if (ValidState(&restored) != 0) {
+    return -1;
+  }
+  // The silence gate has to see the restored filters come to rest again.
+  restored.rest_frame_length = 0;
+  // The snapshot holds the state of the fixed point engine.
+  restored.engine = kVadEngineFixed;
+
+  memcpy(self, &restored, sizeof(restored));
+  return 0;
+}
+
+int WebRtcVad_GetNoiseProfile(const VadInst* handle,
+                              WebRtcVadNoiseProfile* profile) {
+  const VadInstT* self = (const VadInstT*)handle;
+
+  RTC_COMPILE_ASSERT((int)kVadNoiseProfileGaussians == (int)kTableSize);
+  RTC_COMPILE_ASSERT((int)kVadNoiseProfileChannels == (int)kNumChannels);
+
+  if (handle == NULL || profile == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck || self->engine != kVadEngineFixed) {
+    return -1;
+  }
+
+  profile->version = kVadNoiseProfileVersion;
+  memcpy(profile->noise_means, self->noise_means, sizeof(self->noise_means));
+  memcpy(profile->noise_stds, self->noise_stds, sizeof(self->noise_stds));
+  memcpy(profile->speech_means, self->speech_means,
+         sizeof(self->speech_means));
+  memcpy(profile->speech_stds, self->speech_stds, sizeof(self->speech_stds));
+  memcpy(profile->noise_floor, self->mean_value, sizeof(self->mean_value));
+  profile->frame_count = self->frame_counter;
+
+  return 0;
+}
+
+int WebRtcVad_SetNoiseProfile(VadInst* handle,
+                              const WebRtcVadNoiseProfile* profile) {
+  VadInstT* self = (VadInstT*)handle;
+  int i;
+
+  if (handle == NULL || profile == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck || self->engine != kVadEngineFixed) {
+    return -1;
+  }
+  if (profile->version != kVadNoiseProfileVersion ||
+      profile->frame_count < 0) {
+    return -1;
+  }
+  for (i = 0; i < kTableSize; i++) {
+    // The GMM divides by the standard deviations.
+    if (profile->noise_stds[i] <= 0 || profile->speech_stds[i] <= 0) {
+      return -1;
+    }
+  }
+  for (i = 0; i < kNumChannels; i++) {
+    if (profile->noise_floor[i] < 0) {
+      return -1;
+    }
+  }
+
+  memcpy(self->noise_means, profile->noise_means, sizeof(self->noise_means));
+  memcpy(self->noise_stds, profile->noise_stds, sizeof(self->noise_stds));
+  memcpy(self->speech_means, profile->speech_means,
+         sizeof(self->speech_means));
+  memcpy(self->speech_stds, profile->speech_stds, sizeof(self->speech_stds));
+
+  // Continue the smoothed noise floor. The smallest values of the last frames
+  // are left empty, seeding them with the floor makes the minimum tracking
+  // stick to it until they age out, which costs more than it saves.
+  memcpy(self->mean_value, profile->noise_floor, sizeof(self->mean_value));
+  if (profile->frame_count > 0) {
+    self->frame_counter = profile->frame_count;
+  }
+
+  return 0;
+}
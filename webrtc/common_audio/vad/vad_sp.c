@@ -174,3 +174,75 @@ int16_t WebRtcVad_FindMinimum(VadInstT* self,
 
   return self->mean_value[channel];
 }
+
+float WebRtcVad_FindMinimumFloat(VadInstT* self,
+                                 float feature_value,
+                                 int channel) {
+  int i = 0, j = 0;
+  int position = -1;
+  // Offset to beginning of the 16 minimum values in memory.
+  const int offset = (channel << 4);
+  float current_median = 100.f;
+  float alpha = 0.f;
+  // The ages are shared with the fixed point engine.
+  int16_t* age = &self->index_vector[offset];
+  float* smallest_values = &self->float_state.low_value_vector[offset];
+  float* mean_value = &self->float_state.mean_value[channel];
+
+  RTC_DCHECK_LT(channel, kNumChannels);
+
+  // Each value in |smallest_values| is getting 1 loop older. Update |age|, and
+  // remove old values.
+  for (i = 0; i < 16; i++) {
+    if (age[i] != 100) {
+      age[i]++;
+    } else {
+      // Too old value. Remove from memory and shift larger values downwards.
+      for (j = i; j < 15; j++) {
+        smallest_values[j] = smallest_values[j + 1];
+        age[j] = age[j + 1];
+      }
+      age[15] = 101;
+      smallest_values[15] = 625.f;
+    }
+  }
+
+  // Find the |position| of the first value larger than |feature_value|, the
+  // same as the binary search of WebRtcVad_FindMinimum().
+  for (i = 0; i < 16; i++) {
+    if (feature_value < smallest_values[i]) {
+      position = i;
+      break;
+    }
+  }
+
+  // If we have detected a new small value, insert it at the correct position
+  // and shift larger values up.
+  if (position > -1) {
+    for (i = 15; i > position; i--) {
+      smallest_values[i] = smallest_values[i - 1];
+      age[i] = age[i - 1];
+    }
+    smallest_values[position] = feature_value;
+    age[position] = 1;
+  }
+
+  // Get |current_median|.
+  if (self->frame_counter > 2) {
+    current_median = smallest_values[2];
+  } else if (self->frame_counter > 0) {
+    current_median = smallest_values[0];
+  }
+
+  // Smooth the median value.
+  if (self->frame_counter > 0) {
+    if (current_median < *mean_value) {
+      alpha = kSmoothingDown / 32768.f;
+    } else {
+      alpha = kSmoothingUp / 32768.f;
+    }
+  }
+  *mean_value = alpha * *mean_value + (1.f - alpha) * current_median;
+
+  return *mean_value;
+}
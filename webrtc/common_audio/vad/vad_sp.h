@@ -15,6 +15,10 @@
 
 #include "webrtc/common_audio/vad/vad_core.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // Downsamples the signal by a factor 2, eg. 32->16 or 16->8.
 //
 // Inputs:
@@ -51,4 +55,14 @@ int16_t WebRtcVad_FindMinimum(VadInstT* handle,
                               int16_t feature_value,
                               int channel);
 
+// Same as WebRtcVad_FindMinimum() in single precision float, on the values
+// of |handle->float_state| in dB. The default value is 100 dB.
+float WebRtcVad_FindMinimumFloat(VadInstT* handle,
+                                 float feature_value,
+                                 int channel);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
 #endif  // COMMON_AUDIO_VAD_VAD_SP_H_
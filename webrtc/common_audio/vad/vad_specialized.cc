@@ -0,0 +1,57 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/vad/vad_specialized.h"
+
+namespace {
+
+// Specializations by rate (8, 16, 32 and 48 kHz) and frame length (10, 20 and
+// 30 ms).
+const VadCalcFn kCalcVad[4][3] = {
+    {webrtc::VadCalcVad<8000, 10>, webrtc::VadCalcVad<8000, 20>,
+     webrtc::VadCalcVad<8000, 30>},
+    {webrtc::VadCalcVad<16000, 10>, webrtc::VadCalcVad<16000, 20>,
+     webrtc::VadCalcVad<16000, 30>},
+    {webrtc::VadCalcVad<32000, 10>, webrtc::VadCalcVad<32000, 20>,
+     webrtc::VadCalcVad<32000, 30>},
+    {webrtc::VadCalcVad<48000, 10>, webrtc::VadCalcVad<48000, 20>,
+     webrtc::VadCalcVad<48000, 30>},
+};
+
+}  // namespace
+
+VadCalcFn WebRtcVad_SelectCalcVad(int fs, size_t frame_length) {
+  int rate_index = 0;
+  size_t length_10ms = 0;
+
+  switch (fs) {
+    case 8000:
+      rate_index = 0;
+      break;
+    case 16000:
+      rate_index = 1;
+      break;
+    case 32000:
+      rate_index = 2;
+      break;
+    case 48000:
+      rate_index = 3;
+      break;
+    default:
+      return nullptr;
+  }
+
+  length_10ms = static_cast<size_t>(fs / 100);
+  if (frame_length == 0 || frame_length % length_10ms != 0 ||
+      frame_length > 3 * length_10ms) {
+    return nullptr;
+  }
+  return kCalcVad[rate_index][frame_length / length_10ms - 1];
+}
@@ -0,0 +1,68 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// This file includes the VAD core specialized on sample rate and frame length
+// at compile time, for C++ callers that know the format of their frames. The
+// C API picks the same specializations with WebRtcVad_SelectCalcVad().
+
+#ifndef COMMON_AUDIO_VAD_VAD_SPECIALIZED_H_
+#define COMMON_AUDIO_VAD_VAD_SPECIALIZED_H_
+
+#include <stddef.h>
+
+#include "webrtc/common_audio/vad/vad_core.h"
+
+namespace webrtc {
+
+// A supported pair of sample rate and frame length. Any other pair does not
+// compile.
+template <int kRate, int kFrameMs>
+struct VadFrameFormat {
+  static_assert(kRate == 8000 || kRate == 16000 || kRate == 32000 ||
+                    kRate == 48000,
+                "The VAD supports 8, 16, 32 and 48 kHz");
+  static_assert(kFrameMs == 10 || kFrameMs == 20 || kFrameMs == 30,
+                "The VAD supports 10, 20 and 30 ms frames");
+
+  // Samples per frame.
+  static constexpr size_t kLength = kRate / 1000 * kFrameMs;
+  // Samples per frame after resampling to 8 kHz, as seen by the filterbank.
+  static constexpr size_t kLength8khz = 8 * kFrameMs;
+};
+
+// Runs the VAD core on one frame of |kFrameMs| ms at |kRate| Hz, without any
+// check of the arguments. Same as WebRtcVad_CalcVad*khz() with the frame
+// length fixed. The filterbank and the GMM are left out of line: their loops
+// are serial recurrences, and a compile time frame length makes no
+// measurable difference to them.
+//
+// - inst         [i/o] : Initialized VAD instance.
+// - speech_frame [i]   : |VadFrameFormat<kRate, kFrameMs>::kLength| samples.
+// - work         [-]   : Scratch memory.
+//
+// - returns            : VAD decision, see WebRtcVad_CalcVad8khz().
+template <int kRate, int kFrameMs>
+int VadCalcVad(VadInstT* inst, const int16_t* speech_frame,
+               VadWorkspaceT* work) {
+  const size_t kLength = VadFrameFormat<kRate, kFrameMs>::kLength;
+  // |kRate| is a constant, only one of the calls is compiled.
+  if (kRate == 48000) {
+    return WebRtcVad_CalcVad48khz(inst, speech_frame, kLength, work);
+  } else if (kRate == 32000) {
+    return WebRtcVad_CalcVad32khz(inst, speech_frame, kLength, work);
+  } else if (kRate == 16000) {
+    return WebRtcVad_CalcVad16khz(inst, speech_frame, kLength, work);
+  }
+  return WebRtcVad_CalcVad8khz(inst, speech_frame, kLength, work);
+}
+
+}  // namespace webrtc
+
+#endif  // COMMON_AUDIO_VAD_VAD_SPECIALIZED_H_
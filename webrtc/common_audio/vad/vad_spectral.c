@@ -0,0 +1,139 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_audio/vad/vad_spectral.h"
+
+#include <string.h>
+
+#include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
+#include "webrtc/rtc_base/checks.h"
+
+enum { kFftLength = 1 << kSpectralFftOrder };
+
+// First FFT bin of every band, 31.25 Hz per bin, followed by one past the
+// foldover frequency. The bins below 80 Hz are left out, as the filterbank
+// does with its high pass filter.
+static const int kBandStart[kNumChannels + 1] = { 3, 8, 16, 32, 64, 96, 129 };
+
+static const int16_t kLogConst = 24660;  // 160*log10(2) in Q9.
+
+// Returns log2(|value|) in Q10, for |value| > 0. As in LogOfEnergy() of
+// vad_filterbank.c, |value| is normalized to 15 bits and log2(1 + x) is
+// approximated by x.
+static int32_t Log2Q10(uint64_t value) {
+  const uint32_t high = (uint32_t) (value >> 32);
+  int msb = 0;
+  uint32_t mantissa = 0;
+
+  if (high != 0) {
+    msb = 63 - WebRtcSpl_NormU32(high);
+  } else {
+    msb = 31 - WebRtcSpl_NormU32((uint32_t) value);
+  }
+  if (msb >= 14) {
+    mantissa = (uint32_t) (value >> (msb - 14));
+  } else {
+    mantissa = (uint32_t) value << (14 - msb);
+  }
+
+  return (msb << 10) + (int32_t) ((mantissa & 0x00003FFF) >> 4);
+}
+
+// Returns 2^(|log2_value| / 2^10) in Q14, for |log2_value| <= 0. The inverse
+// of the approximation in Log2Q10().
+static int16_t Exp2Q14(int32_t log2_value) {
+  // |log2_value| = -|int_part| + |frac|, with |frac| in [0, 1) in Q10.
+  const int32_t int_part = (1023 - log2_value) >> 10;
+  const int32_t frac = log2_value + (int_part << 10);
+
+  if (int_part > 14) {
+    return 0;
+  }
+  return (int16_t) ((16384 + (frac << 4)) >> int_part);
+}
+
+// Returns 10 * log10 of the energy of a band in Q4, from the sum |energy| of
+// its bins in a spectrum of a frame scaled up by 2^|shift|.
+static int16_t LogEnergyQ4(uint64_t energy, int shift) {
+  int32_t log2_energy = 0;
+  int32_t log_energy = 0;
+
+  if (energy == 0) {
+    return 0;
+  }
+  // The FFT output is scaled down by 2^-|kSpectralFftOrder|, so by Parseval
+  // the time domain energy of the band is 2^|kSpectralFftOrder| times the sum
+  // of its bins, and twice that counting the negative frequencies.
+  log2_energy = Log2Q10(energy) + ((kSpectralFftOrder + 1 - 2 * shift) << 10);
+  log_energy = (kLogConst * log2_energy) >> 19;
+
+  return (int16_t) (log_energy < 0 ? 0 : log_energy);
+}
+
+void WebRtcVad_SpectralFeatures(const int16_t* data_in,
+                                size_t data_length,
+                                VadWorkspaceT* work,
+                                int16_t* band_energies,
+                                int16_t* flatness) {
+  int16_t* fft = work->fft;
+  const int num_bins = kBandStart[kNumChannels] - kBandStart[0];
+  int16_t max_value = 0;
+  int shift = 0;
+  size_t i = 0;
+  int band = 0;
+  int k = 0;
+  uint64_t total_power = 0;
+  int64_t sum_log2_power = 0;
+  int32_t mean_log2_power = 0;
+  int32_t log2_mean_power = 0;
+
+  RTC_DCHECK(data_in);
+  RTC_DCHECK_LE(data_length, kFftLength);
+
+  max_value = WebRtcSpl_MaxAbsValueW16(data_in, data_length);
+  if (max_value == 0) {
+    memset(band_energies, 0, sizeof(*band_energies) * kNumChannels);
+    *flatness = 0;
+    return;
+  }
+
+  // Scale the frame up to the full 16 bit range, since the FFT scales its
+  // output down by one bit per stage, and zero pad it to the FFT length.
+  shift = WebRtcSpl_NormW16(max_value);
+  for (i = 0; i < data_length; i++) {
+    fft[2 * i] = (int16_t) (data_in[i] * (1 << shift));
+    fft[2 * i + 1] = 0;
+  }
+  memset(&fft[2 * data_length], 0,
+         sizeof(*fft) * 2 * (kFftLength - data_length));
+
+  WebRtcSpl_ComplexBitReverse(fft, kSpectralFftOrder);
+  WebRtcSpl_ComplexFFT(fft, kSpectralFftOrder, 1);
+
+  for (band = 0; band < kNumChannels; band++) {
+    uint64_t energy = 0;
+    for (k = kBandStart[band]; k < kBandStart[band + 1]; k++) {
+      // Each square is at most 2^30, so the sum fits in 32 bits.
+      const uint32_t power = (uint32_t) (fft[2 * k] * fft[2 * k]) +
+                             (uint32_t) (fft[2 * k + 1] * fft[2 * k + 1]);
+      energy += power;
+      // Offset by one to keep empty bins finite.
+      sum_log2_power += Log2Q10((uint64_t) power + 1);
+    }
+    band_energies[band] = LogEnergyQ4(energy, shift);
+    total_power += energy;
+  }
+
+  // Flatness: 2^(mean(log2(power)) - log2(mean(power))).
+  mean_log2_power = (int32_t) (sum_log2_power / num_bins);
+  log2_mean_power = Log2Q10(total_power + (uint64_t) num_bins) -
+                    Log2Q10((uint64_t) num_bins);
+  *flatness = Exp2Q14(WEBRTC_SPL_MIN(mean_log2_power - log2_mean_power, 0));
+}
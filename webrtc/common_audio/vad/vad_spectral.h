@@ -0,0 +1,49 @@
+/*
+ *  Copyright (c) 2022 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// This file includes spectral features computed with the fixed point FFT of
+// the signal processing library. They are not part of the GMM decision; they
+// are computed from the same 8 kHz frame as the filterbank features, see
+// WebRtcVad_EnableSpectralFeatures().
+
+#ifndef COMMON_AUDIO_VAD_VAD_SPECTRAL_H_
+#define COMMON_AUDIO_VAD_VAD_SPECTRAL_H_
+
+#include "webrtc/common_audio/vad/vad_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Computes the spectrum of a frame at 8 kHz with a 2^|kSpectralFftOrder|
+// point FFT, zero padded, and from it the energy in each of the filterbank
+// bands and the spectral flatness from 80 Hz to 4000 Hz.
+//
+// - data_in       [i] : Frame at 8 kHz, 80, 160 or 240 samples.
+// - data_length   [i] : Number of samples in |data_in|.
+// - work          [i] : Scratch memory, |work->fft| is used.
+// - band_energies [o] : 10 * log10 of the energy in the bands 80 - 250,
+//                       250 - 500, 500 - 1000, 1000 - 2000, 2000 - 3000 and
+//                       3000 - 4000 Hz, in Q4 like the filterbank features,
+//                       but without their offsets. |kNumChannels| values.
+// - flatness      [o] : Geometric over arithmetic mean of the power spectrum
+//                       in Q14, close to 0 for tones, about 9200 (0.56) for
+//                       white noise. 0 for an all zero frame.
+void WebRtcVad_SpectralFeatures(const int16_t* data_in,
+                                size_t data_length,
+                                VadWorkspaceT* work,
+                                int16_t* band_energies,
+                                int16_t* flatness);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // COMMON_AUDIO_VAD_VAD_SPECTRAL_H_
@@ -15,17 +15,34 @@
 
 #include "webrtc/common_audio/signal_processing/include/signal_processing_library.h"
 #include "webrtc/common_audio/vad/vad_core.h"
+#include "webrtc/rtc_base/checks.h"
+#include "webrtc/rtc_base/system/inline.h"
 
 static const int kInitCheck = 42;
-static const int kValidRates[] = { 8000, 16000, 32000, 48000 };
-static const size_t kRatesSize = sizeof(kValidRates) / sizeof(*kValidRates);
-static const int kMaxFrameLengthMs = 30;
+enum { kCacheLineSize = 64 };
+// |next| of an instance that has been taken from its pool.
+static const uint32_t kPoolTaken = UINT32_MAX;
+
+struct WebRtcVadPool {
+  void* memory;        // Allocation holding the instances.
+  char* instances;     // First instance, aligned to a cache line.
+  size_t stride;       // Size of an instance rounded up to a cache line.
+  size_t capacity;
+  uint32_t* next;      // Free list, |next[i]| follows instance |i|, or
+                       // |kPoolTaken|.
+  uint32_t free_head;  // First free instance, |capacity| if none.
+  size_t available;
+};
 
 VadInst* WebRtcVad_Create() {
   VadInstT* self = (VadInstT*)malloc(sizeof(VadInstT));
 
   WebRtcSpl_Init();
   self->init_flag = 0;
+  self->configured_calc = NULL;
+#if defined(WEBRTC_VAD_PROFILING)
+  memset(&self->profile, 0, sizeof(self->profile));
+#endif
 
   return (VadInst*)self;
 }
@@ -34,12 +51,125 @@ void WebRtcVad_Free(VadInst* handle) {
   free(handle);
 }
 
+VadPool* WebRtcVad_CreatePool(size_t capacity) {
+  VadPool* pool;
+  size_t i;
+
+  if (capacity == 0 || capacity >= UINT32_MAX) {
+    return NULL;
+  }
+  pool = (VadPool*)malloc(sizeof(VadPool));
+  if (pool == NULL) {
+    return NULL;
+  }
+  pool->stride =
+      (sizeof(VadInstT) + kCacheLineSize - 1) & ~(size_t)(kCacheLineSize - 1);
+  if (capacity > (SIZE_MAX - (kCacheLineSize - 1)) / pool->stride ||
+      capacity > SIZE_MAX / sizeof(uint32_t)) {
+    free(pool);
+    return NULL;
+  }
+  pool->capacity = capacity;
+  pool->memory = malloc(capacity * pool->stride + kCacheLineSize - 1);
+  pool->next = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+  if (pool->memory == NULL || pool->next == NULL) {
+    free(pool->memory);
+    free(pool->next);
+    free(pool);
+    return NULL;
+  }
+  pool->instances = (char*)(((uintptr_t)pool->memory + kCacheLineSize - 1) &
+                            ~(uintptr_t)(kCacheLineSize - 1));
+
+  WebRtcSpl_Init();
+  for (i = 0; i < capacity; i++) {
+    pool->next[i] = (uint32_t)(i + 1);
+  }
+  pool->free_head = 0;
+  pool->available = capacity;
+
+  return pool;
+}
+
+void WebRtcVad_FreePool(VadPool* pool) {
+  if (pool == NULL) {
+    return;
+  }
+  free(pool->memory);
+  free(pool->next);
+  free(pool);
+}
+
+VadInst* WebRtcVad_PoolAcquire(VadPool* pool) {
+  VadInstT* self;
+  uint32_t index;
+
+  if (pool == NULL || pool->free_head == pool->capacity) {
+    return NULL;
+  }
+  index = pool->free_head;
+  pool->free_head = pool->next[index];
+  pool->next[index] = kPoolTaken;
+  pool->available--;
+
+  self = (VadInstT*)(pool->instances + index * pool->stride);
+  self->init_flag = 0;
+  self->configured_calc = NULL;
+#if defined(WEBRTC_VAD_PROFILING)
+  memset(&self->profile, 0, sizeof(self->profile));
+#endif
+
+  return (VadInst*)self;
+}
+
+int WebRtcVad_PoolRelease(VadPool* pool, VadInst* handle) {
+  uintptr_t offset;
+  uint32_t index;
+
+  if (pool == NULL || handle == NULL) {
+    return -1;
+  }
+  // Only instances of this pool, and only once.
+  offset = (uintptr_t)handle - (uintptr_t)pool->instances;
+  if ((uintptr_t)handle < (uintptr_t)pool->instances ||
+      offset >= pool->capacity * pool->stride || offset % pool->stride != 0) {
+    return -1;
+  }
+  index = (uint32_t)(offset / pool->stride);
+  if (pool->next[index] != kPoolTaken) {
+    return -1;
+  }
+  ((VadInstT*)handle)->init_flag = 0;
+  ((VadInstT*)handle)->configured_calc = NULL;
+  pool->next[index] = pool->free_head;
+  pool->free_head = index;
+  pool->available++;
+  return 0;
+}
+
+size_t WebRtcVad_PoolAvailable(const VadPool* pool) {
+  return pool == NULL ? 0 : pool->available;
+}
+
 // TODO(bjornv): Move WebRtcVad_InitCore() code here.
 int WebRtcVad_Init(VadInst* handle) {
   // Initialize the core VAD component.
   return WebRtcVad_InitCore((VadInstT*) handle);
 }
 
+int WebRtcVad_Reset(VadInst* handle) {
+  VadInstT* self = (VadInstT*) handle;
+
+  if (handle == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck) {
+    return -1;
+  }
+
+  return WebRtcVad_ResetCore(self);
+}
+
 // TODO(bjornv): Move WebRtcVad_set_mode_core() code here.
 int WebRtcVad_set_mode(VadInst* handle, int mode) {
   VadInstT* self = (VadInstT*) handle;
@@ -54,10 +184,278 @@ int WebRtcVad_set_mode(VadInst* handle, int mode) {
   return WebRtcVad_set_mode_core(self, mode);
 }
 
+// Runs |calc| with |size| bytes of scratch memory at |memory|.
+static int CalcVadInMemory(VadInstT* self, int fs, VadCalcFn calc,
+                           const int16_t* audio_frame, int32_t* memory,
+                           size_t size) {
+  VadWorkspaceT work;
+
+  WebRtcVad_InitWorkspace(memory, size, fs, &work);
+  return calc(self, audio_frame, &work);
+}
+
+// Defines CalcVadOnStack<bytes>(), which runs |calc| with |bytes| of scratch
+// memory on the stack, for instances without a workspace. Each size is a
+// function of its own, not inlined, so that neither WebRtcVad_Process() nor
+// the smaller sizes reserve the larger ones.
+#define DEFINE_CALC_VAD_ON_STACK(bytes)                                     \
+  static RTC_NO_INLINE int CalcVadOnStack##bytes(                           \
+      VadInstT* self, int fs, VadCalcFn calc, const int16_t* audio_frame) { \
+    int32_t memory[(bytes) / sizeof(int32_t)];                              \
+    return CalcVadInMemory(self, fs, calc, audio_frame, memory,             \
+                           sizeof(memory));                                 \
+  }
+
+// 8 kHz, 16 kHz and 32 kHz with the fixed point engine, then the spectral
+// features up to 32 kHz, and 48 kHz, which on the stack resamples one 10 ms
+// block at a time, or the float engine.
+DEFINE_CALC_VAD_ON_STACK(768)
+DEFINE_CALC_VAD_ON_STACK(1280)
+DEFINE_CALC_VAD_ON_STACK(1536)
+DEFINE_CALC_VAD_ON_STACK(3072)
+
+#undef DEFINE_CALC_VAD_ON_STACK
+
+static int CalcVadWithWorkspace(VadInstT* self, int fs, VadCalcFn calc,
+                                const int16_t* audio_frame) {
+  size_t size = 0;
+
+  if (self->workspace != NULL) {
+    return CalcVadInMemory(self, fs, calc, audio_frame,
+                           (int32_t*) self->workspace,
+                           WebRtcVad_WorkspaceSize());
+  }
+  size = WebRtcVad_WorkspaceBytes(fs, self->engine, self->spectral_features,
+                                  1);
+  if (size <= 768) {
+    return CalcVadOnStack768(self, fs, calc, audio_frame);
+  }
+  if (size <= 1280) {
+    return CalcVadOnStack1280(self, fs, calc, audio_frame);
+  }
+  if (size <= 1536) {
+    return CalcVadOnStack1536(self, fs, calc, audio_frame);
+  }
+  RTC_DCHECK_LE(size, 3072);
+  return CalcVadOnStack3072(self, fs, calc, audio_frame);
+}
+
+// Processes a frame taken by the silence gate as digital silence. Until the
+// filter states come to rest a zero frame goes through the whole chain. At
+// rest another zero frame would leave the states and the features as they
+// are, so only the GMM, which for zero energy is just the hangover logic,
+// runs on the features of the last frame.
+static int ProcessSilence(VadInstT* self, int fs, size_t frame_length,
+                          VadCalcFn calc) {
+  static const int16_t kZeroFrame[1440] = {0};  // 30 ms at 48 kHz.
+  int32_t downsampling_filter_states[4];
+  WebRtcSpl_State48khzTo8khz state_48_to_8;
+  int16_t split_filter_states[5 + 5 + 4];
+  float float_filter_states[5 + 5 + 4];
+  int vad;
+
+  if (self->rest_fs == fs && self->rest_frame_length == frame_length) {
+    self->silent_frames++;
+    if (self->engine == kVadEngineFloat) {
+      self->vad =
+          WebRtcVad_GmmProbabilityFloat(self, frame_length * 8000 / fs);
+    } else {
+      self->vad = WebRtcVad_GmmProbability(self, self->feature_vector,
+                                           self->total_power,
+                                           frame_length * 8000 / fs);
+    }
+    return self->vad;
+  }
+
+  memcpy(downsampling_filter_states, self->downsampling_filter_states,
+         sizeof(downsampling_filter_states));
+  memcpy(&state_48_to_8, &self->state_48_to_8, sizeof(state_48_to_8));
+  memcpy(&split_filter_states[0], self->upper_state, 5 * sizeof(int16_t));
+  memcpy(&split_filter_states[5], self->lower_state, 5 * sizeof(int16_t));
+  memcpy(&split_filter_states[10], self->hp_filter_state, 4 * sizeof(int16_t));
+  memcpy(&float_filter_states[0], self->float_state.upper_state,
+         5 * sizeof(float));
+  memcpy(&float_filter_states[5], self->float_state.lower_state,
+         5 * sizeof(float));
+  memcpy(&float_filter_states[10], self->float_state.hp_filter_state,
+         4 * sizeof(float));
+
+  vad = CalcVadWithWorkspace(self, fs, calc, kZeroFrame);
+
+  if (memcmp(downsampling_filter_states, self->downsampling_filter_states,
+             sizeof(downsampling_filter_states)) == 0 &&
+      memcmp(&state_48_to_8, &self->state_48_to_8,
+             sizeof(state_48_to_8)) == 0 &&
+      memcmp(&split_filter_states[0], self->upper_state,
+             5 * sizeof(int16_t)) == 0 &&
+      memcmp(&split_filter_states[5], self->lower_state,
+             5 * sizeof(int16_t)) == 0 &&
+      memcmp(&split_filter_states[10], self->hp_filter_state,
+             4 * sizeof(int16_t)) == 0 &&
+      memcmp(&float_filter_states[0], self->float_state.upper_state,
+             5 * sizeof(float)) == 0 &&
+      memcmp(&float_filter_states[5], self->float_state.lower_state,
+             5 * sizeof(float)) == 0 &&
+      memcmp(&float_filter_states[10], self->float_state.hp_filter_state,
+             4 * sizeof(float)) == 0) {
+    self->rest_fs = fs;
+    self->rest_frame_length = frame_length;
+  }
+  return vad;
+}
+
+int WebRtcVad_SetSilenceThreshold(VadInst* handle, int threshold) {
+  VadInstT* self = (VadInstT*) handle;
+
+  if (handle == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck) {
+    return -1;
+  }
+  if (threshold < -1 || threshold > 32767) {
+    return -1;
+  }
+
+  self->silence_threshold = (int16_t) threshold;
+  self->rest_frame_length = 0;
+  return 0;
+}
+
+int WebRtcVad_EnableSpectralFeatures(VadInst* handle, int enable) {
+  VadInstT* self = (VadInstT*) handle;
+
+  if (handle == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck) {
+    return -1;
+  }
+
+  self->spectral_features = enable != 0;
+  return 0;
+}
+
+int WebRtcVad_EnableHangover(VadInst* handle, int enable) {
+  VadInstT* self = (VadInstT*) handle;
+
+  if (handle == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck) {
+    return -1;
+  }
+
+  self->hangover = enable != 0;
+  return 0;
+}
+
+int WebRtcVad_GetSpectralFeatures(const VadInst* handle,
+                                  WebRtcVadSpectralFeatures* features) {
+  const VadInstT* self = (const VadInstT*) handle;
+
+  if (handle == NULL || features == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck || !self->spectral_features) {
+    return -1;
+  }
+
+  memcpy(features->band_energy, self->spectral_energy,
+         sizeof(features->band_energy));
+  features->flatness = self->spectral_flatness;
+  return 0;
+}
+
+int WebRtcVad_SetEngine(VadInst* handle, int engine) {
+  VadInstT* self = (VadInstT*) handle;
+
+  if (handle == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck) {
+    return -1;
+  }
+  if (engine != kVadEngineFixed && engine != kVadEngineFloat) {
+    return -1;
+  }
+
+  // The adaptive state of the other engine has not followed the stream.
+  self->engine = engine;
+  return WebRtcVad_ResetCore(self);
+}
+
+size_t WebRtcVad_WorkspaceSize(void) {
+  // 30 ms at 48 kHz in one pass through the resampler, with either engine.
+  return WEBRTC_SPL_MAX(WebRtcVad_WorkspaceBytes(48000, kVadEngineFixed, 1, 3),
+                        WebRtcVad_WorkspaceBytes(48000, kVadEngineFloat, 1, 3));
+}
+
+int WebRtcVad_SetWorkspace(VadInst* handle, void* workspace, size_t size) {
+  VadInstT* self = (VadInstT*) handle;
+
+  if (handle == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck) {
+    return -1;
+  }
+  if (workspace != NULL &&
+      (size < WebRtcVad_WorkspaceSize() ||
+       (uintptr_t)workspace % sizeof(int32_t) != 0)) {
+    return -1;
+  }
+
+  self->workspace = workspace;
+  return 0;
+}
+
+int64_t WebRtcVad_SilentFrames(const VadInst* handle) {
+  const VadInstT* self = (const VadInstT*) handle;
+
+  if (handle == NULL) {
+    return -1;
+  }
+  if (self->init_flag != kInitCheck) {
+    return -1;
+  }
+
+  return self->silent_frames;
+}
+
+// Processes a frame of a checked format with |calc|, the VAD core for it.
+// Turns the return value |vad| of the VAD core into the decision of
+// WebRtcVad_Process(). The core returns 1 for active voice and more for the
+// frames of its hangover.
+static int Decision(const VadInstT* self, int vad) {
+  if (vad > 1 && !self->hangover) {
+    return 0;
+  }
+  return vad > 0 ? 1 : vad;
+}
+
+static int ProcessFrame(VadInstT* self, int fs, const int16_t* audio_frame,
+                        size_t frame_length, VadCalcFn calc) {
+  int vad = -1;
+
+  VAD_PROFILE_BEGIN(process_start);
+  if (self->silence_threshold >= 0 &&
+      WebRtcSpl_MaxAbsValueW16(audio_frame, frame_length) <=
+          self->silence_threshold) {
+    vad = ProcessSilence(self, fs, frame_length, calc);
+  } else {
+    self->rest_frame_length = 0;
+    vad = CalcVadWithWorkspace(self, fs, calc, audio_frame);
+  }
+  VAD_PROFILE_END(&self->profile, kVadStageProcess, process_start);
+
+  return Decision(self, vad);
+}
+
 int WebRtcVad_Process(VadInst* handle, int fs, const int16_t* audio_frame,
                       size_t frame_length) {
-  int vad = -1;
   VadInstT* self = (VadInstT*) handle;
+  VadCalcFn calc = NULL;
 
   if (handle == NULL) {
     return -1;
@@ -69,47 +467,194 @@ int WebRtcVad_Process(VadInst* handle, int fs, const int16_t* audio_frame,
   if (audio_frame == NULL) {
     return -1;
   }
-  if (WebRtcVad_ValidRateAndFrameLength(fs, frame_length) != 0) {
+  calc = WebRtcVad_SelectCalcVad(fs, frame_length);
+  if (calc == NULL) {
     return -1;
   }
 
-  if (fs == 48000) {
-      vad = WebRtcVad_CalcVad48khz(self, audio_frame, frame_length);
-  } else if (fs == 32000) {
-    vad = WebRtcVad_CalcVad32khz(self, audio_frame, frame_length);
-  } else if (fs == 16000) {
-    vad = WebRtcVad_CalcVad16khz(self, audio_frame, frame_length);
-  } else if (fs == 8000) {
-    vad = WebRtcVad_CalcVad8khz(self, audio_frame, frame_length);
+  return ProcessFrame(self, fs, audio_frame, frame_length, calc);
+}
+
+// Processes a frame in the format of WebRtcVad_Configure(), which has checked
+// it and the instance once for all frames.
+static int ProcessConfigured(VadInst* handle, const int16_t* audio_frame) {
+  VadInstT* self = (VadInstT*) handle;
+
+  RTC_DCHECK(audio_frame);
+  // Cleared by WebRtcVad_Init() and the pool, for a stale function.
+  if (self->configured_calc == NULL) {
+    return -1;
   }
+  return ProcessFrame(self, self->configured_fs, audio_frame,
+                      self->configured_frame_length, self->configured_calc);
+}
+
+WebRtcVadProcessFn WebRtcVad_Configure(VadInst* handle, int fs,
+                                       size_t frame_length) {
+  VadInstT* self = (VadInstT*) handle;
+  VadCalcFn calc = NULL;
 
-  if (vad > 0) {
-    vad = 1;
+  if (handle == NULL) {
+    return NULL;
   }
-  return vad;
+  if (self->init_flag != kInitCheck) {
+    return NULL;
+  }
+  calc = WebRtcVad_SelectCalcVad(fs, frame_length);
+  if (calc == NULL) {
+    return NULL;
+  }
+
+  self->configured_fs = fs;
+  self->configured_frame_length = frame_length;
+  self->configured_calc = calc;
+  return ProcessConfigured;
 }
 
-int WebRtcVad_ValidRateAndFrameLength(int rate, size_t frame_length) {
-  int return_value = -1;
-  size_t i;
-  int valid_length_ms;
-  size_t valid_length;
-
-  // We only allow 10, 20 or 30 ms frames. Loop through valid frame rates and
-  // see if we have a matching pair.
-  for (i = 0; i < kRatesSize; i++) {
-    if (kValidRates[i] == rate) {
-      for (valid_length_ms = 10; valid_length_ms <= kMaxFrameLengthMs;
-          valid_length_ms += 10) {
-        valid_length = (size_t)(kValidRates[i] / 1000 * valid_length_ms);
-        if (frame_length == valid_length) {
-          return_value = 0;
-          break;
-        }
-      }
-      break;
+// Scratch memory of WebRtcVad_ProcessLanes48khz(): the work area of the lanes
+// resampler, which the 8 kHz VAD core of each lane reuses afterwards, and the
+// resampled frames of all lanes, 30 ms at 8 kHz each.
+enum {
+  kLanesResampleBytes = kResample48khzTo8khzLanesMem * sizeof(int32_t),
+  kLanesFrameLength = 240,
+  kLanesSpeechBytes = kLanesFrameLength * sizeof(int16_t) * kResampleLanes
+};
+
+size_t WebRtcVad_LanesWorkspaceSize(void) {
+  return kLanesResampleBytes + kLanesSpeechBytes;
+}
+
+// Copies the |length| words of one stream's filter state between |words| and
+// lane |lane| of the lane interleaved |lanes|, into the lanes if |to_lanes|.
+static void CopyLane(int32_t* words, int32_t* lanes, size_t length,
+                     size_t lane, int to_lanes) {
+  size_t k;
+
+  for (k = 0; k < length; k++) {
+    if (to_lanes) {
+      lanes[k * kResampleLanes + lane] = words[k];
+    } else {
+      words[k] = lanes[k * kResampleLanes + lane];
+    }
+  }
+}
+
+// Copies the 48 to 8 kHz resampler state of |self| into lane |lane| of
+// |state|, or back from it.
+static void CopyResamplerLane(VadInstT* self,
+                              WebRtcSpl_State48khzTo8khzLanes* state,
+                              size_t lane, int to_lanes) {
+  WebRtcSpl_State48khzTo8khz* own = &self->state_48_to_8;
+
+  CopyLane(own->S_48_24, state->S_48_24, 8, lane, to_lanes);
+  CopyLane(own->S_24_24, state->S_24_24, 16, lane, to_lanes);
+  CopyLane(own->S_24_16, state->S_24_16, 8, lane, to_lanes);
+  CopyLane(own->S_16_8, state->S_16_8, 8, lane, to_lanes);
+}
+
+// Runs one frame of each of |count| instances, at most kResampleLanes, through
+// the lanes resampler and then each through its 8 kHz VAD core, which is what
+// WebRtcVad_CalcVad48khz() does for one instance. The decision of lane |lane|
+// goes to |decisions[indices[lane]]|.
+static void ProcessLanes(VadInstT* const* lanes,
+                         const int16_t* const* frames, const size_t* indices,
+                         size_t count, size_t frame_length, int32_t* memory,
+                         int* decisions) {
+  static const int16_t kZeroBlock[480] = {0};
+  int16_t unused[80];
+  int16_t* speech_nb = (int16_t*)((char*)memory + kLanesResampleBytes);
+  const int16_t* in[kResampleLanes];
+  int16_t* out[kResampleLanes];
+  WebRtcSpl_State48khzTo8khzLanes state;
+  VadWorkspaceT work;
+  size_t blocks = frame_length / 480;
+  size_t block = 0;
+  size_t lane = 0;
+
+  RTC_DCHECK_LE(count, kResampleLanes);
+  // Unused lanes resample zeros from a zero state into |unused|.
+  WebRtcSpl_ResetResample48khzTo8khzLanes(&state);
+  for (lane = 0; lane < count; lane++) {
+    CopyResamplerLane(lanes[lane], &state, lane, 1);
+  }
+  for (block = 0; block < blocks; block++) {
+    for (lane = 0; lane < kResampleLanes; lane++) {
+      in[lane] = lane < count ? frames[lane] + block * 480 : kZeroBlock;
+      out[lane] = lane < count
+                      ? speech_nb + lane * kLanesFrameLength + block * 80
+                      : unused;
+    }
+    WebRtcSpl_Resample48khzTo8khzLanes(in, out, &state, memory);
+  }
+
+  for (lane = 0; lane < count; lane++) {
+    VadInstT* self = lanes[lane];
+
+    CopyResamplerLane(self, &state, lane, 0);
+    self->rest_frame_length = 0;
+    RTC_DCHECK_LE(WebRtcVad_WorkspaceBytes(8000, self->engine,
+                                           self->spectral_features, 1),
+                  kLanesResampleBytes);
+    WebRtcVad_InitWorkspace(memory, kLanesResampleBytes, 8000, &work);
+    decisions[indices[lane]] = Decision(
+        self, WebRtcVad_CalcVad8khz(self, speech_nb + lane * kLanesFrameLength,
+                                    frame_length / 6, &work));
+  }
+}
+
+int WebRtcVad_ProcessLanes48khz(VadInst* const* handles, size_t count,
+                                const int16_t* const* audio_frames,
+                                size_t frame_length, void* workspace,
+                                size_t size, int* decisions) {
+  VadInstT* lanes[kResampleLanes];
+  const int16_t* frames[kResampleLanes];
+  size_t indices[kResampleLanes];
+  VadCalcFn calc = WebRtcVad_SelectCalcVad(48000, frame_length);
+  size_t used = 0;
+  size_t i = 0;
+
+  if (handles == NULL || audio_frames == NULL || decisions == NULL ||
+      calc == NULL) {
+    return -1;
+  }
+  if (workspace == NULL || size < WebRtcVad_LanesWorkspaceSize() ||
+      (uintptr_t)workspace % sizeof(int32_t) != 0) {
+    return -1;
+  }
+  for (i = 0; i < count; i++) {
+    if (handles[i] == NULL ||
+        ((VadInstT*)handles[i])->init_flag != kInitCheck ||
+        audio_frames[i] == NULL) {
+      return -1;
     }
   }
 
-  return return_value;
+  for (i = 0; i < count; i++) {
+    VadInstT* self = (VadInstT*)handles[i];
+
+    if (self->silence_threshold >= 0 &&
+        WebRtcSpl_MaxAbsValueW16(audio_frames[i], frame_length) <=
+            self->silence_threshold) {
+      decisions[i] =
+          Decision(self, ProcessSilence(self, 48000, frame_length, calc));
+      continue;
+    }
+    lanes[used] = self;
+    frames[used] = audio_frames[i];
+    indices[used] = i;
+    if (++used == kResampleLanes) {
+      ProcessLanes(lanes, frames, indices, used, frame_length,
+                   (int32_t*)workspace, decisions);
+      used = 0;
+    }
+  }
+  if (used > 0) {
+    ProcessLanes(lanes, frames, indices, used, frame_length,
+                 (int32_t*)workspace, decisions);
+  }
+  return 0;
+}
+
+int WebRtcVad_ValidRateAndFrameLength(int rate, size_t frame_length) {
+  return WebRtcVad_SelectCalcVad(rate, frame_length) != NULL ? 0 : -1;
 }